@@ -43,136 +43,128 @@
 
 #undef max
 
-CAkima::CAkima(scgms::WSignal signal) : mSignal(signal) {
+thread_local std::vector<size_t> CAkima::mKnot_Indices;
+thread_local TVector1D CAkima::mOffsets, CAkima::mLane_Coefficients[CAkima::Coefficient_Count];
+
+CAkima::CAkima(scgms::ISignal* signal) : mKnots(signal) {
 	Update();
 }
 
+HRESULT IfaceCalling CAkima::QueryInterface(const GUID*  riid, void ** ppvObj) {
+	if (Internal_Query_Interface<scgms::IApproximation_Locality>(scgms::IID_Approximation_Locality, *riid, ppvObj)) {
+		return S_OK;
+	}
+
+	return E_NOINTERFACE;
+}
+
+HRESULT IfaceCalling CAkima::Get_Preceding_Affected_Levels(size_t* count) const {
+	//the derivatives of two knots on each side change, and so does the interval ending with the first of them - i.e., 3 levels,
+	//unless there were too few knots to approximate before, because then the whole approximation changes
+	*count = std::max(static_cast<size_t>(3), MINIMUM_NUMBER_POINTS);
+	return S_OK;
+}
+
 bool CAkima::Update() {
 	std::lock_guard<std::mutex> local_guard{ mUpdate_Guard };
 
-	size_t update_count;
-	if (mSignal.Get_Discrete_Bounds(nullptr, nullptr, &update_count) != S_OK) {
+	const size_t known_count = mCoefficients.size() / Coefficient_Count;
+
+	size_t first_changed;
+	if (!mKnots.Update(first_changed)) {
+		mCoefficients.clear();
 		return false;
 	}
 
-	if (update_count < MINIMUM_NUMBER_POINTS) {
+	if (mKnots.Size() < MINIMUM_NUMBER_POINTS) {
 		return false;
 	}
 
-	if (mInputTimes.size() != update_count) {
-		mInputTimes.resize(update_count);
-		mInputLevels.resize(update_count);
-		mCoefficients.resize(update_count);
-	}
-	else { // valCount == oldCount, no need to update
+	if ((known_count == mKnots.Size()) && (first_changed == known_count)) { // valCount == oldCount, no need to update
 		return true;
 	}
 
-	size_t filled;
-	if (mSignal.Get_Discrete_Levels(mInputTimes.data(), mInputLevels.data(), update_count, &filled) != S_OK) {
-		//error, we need to recalculate everything
-		mInputTimes.clear();
-		return false;
-	}
-
-	Compute_Coefficients();
+	//coefficients computed from too few knots have to be recomputed entirely
+	Compute_Coefficients(known_count < MINIMUM_NUMBER_POINTS ? 0 : std::min(first_changed, known_count));
 
 	return true;
 }
 
-void CAkima::Compute_Coefficients() {
-	const size_t count = mInputLevels.size();
-
-	std::vector<double> coefsOfPolynFunc(4 * count);
-	auto firstDerivatives = &coefsOfPolynFunc[count];
-
-	coefsOfPolynFunc[0] = mInputLevels[0];
-	coefsOfPolynFunc[1] = mInputLevels[1];
-
-	double d1 = (mInputLevels[1] - mInputLevels[0]) / (mInputTimes[1] - mInputTimes[0]);
-	double d2 = (mInputLevels[2] - mInputLevels[1]) / (mInputTimes[2] - mInputTimes[1]);
+void CAkima::Compute_Coefficients(const size_t first_changed) {
+	const auto& times = mKnots.Times();
+	const auto& levels = mKnots.Levels();
+	const size_t count = levels.size();
 
-	double d3 = (mInputLevels[3] - mInputLevels[2]) / (mInputTimes[3] - mInputTimes[2]);
-	double d4 = (mInputLevels[4] - mInputLevels[3]) / (mInputTimes[4] - mInputTimes[3]);
-
-	double w1 = fabs(d1 - d2);
-	double w2 = fabs(d2 - d3);
-	double w3 = fabs(d3 - d4);
-
-	double fd, fdPrev = 0.0;
-
-	auto computeFd = [&](size_t i) {
-		if (FP_ZERO == std::fpclassify(w3) && FP_ZERO == std::fpclassify(w1)) {
-			double xv = mInputTimes[i]; // no need to optimize this,
-			double xvP = mInputTimes[i + 1]; // expecting to be very rare case
-			double xvM = mInputTimes[i - 1];
-			return (((xvP - xv) * d2) + ((xv - xvM) * d3)) / (xvP - xvM);
-		}
-		else {
-			return ((w3 * d2) + (w1 * d3)) / (w3 + w1);
-		}
+	mCoefficients.resize(count * Coefficient_Count);
+	auto coefficient = [this](const size_t knot, const size_t power) -> double& {
+		return mCoefficients[knot * Coefficient_Count + power];
 	};
 
-	auto compute3th4thCoefs = [&](size_t i) {
-		//copute 3. and 4. coeficients
-		double w = mInputTimes[i]- mInputTimes[i - 1];
-		double w_2 = w * w;
-
-		double yv = mInputLevels[i - 1];
-		double yvP = mInputLevels[i];
+	for (size_t i = first_changed; i < count; i++) {
+		coefficient(i, 0) = levels[i];
+	}
 
-		//saving one division
-		double divTmp = (yv - yvP) / w;
-		coefsOfPolynFunc[2 * count + i - 1] = (-3 * divTmp - 2 * fdPrev - fd) / w;
-		coefsOfPolynFunc[3 * count + i - 1] = (2 * divTmp + fdPrev + fd) / w_2;
-	};
+	//a knot's derivative depends on two neighbouring knots on each side
+	const size_t first_derivative = first_changed > 2 ? first_changed - 2 : 0;
+	if (first_derivative < 2) {
+		coefficient(0, 1) = Differentiate_Three_Point_Scalar(0, 0, 1, 2);
+		coefficient(1, 1) = Differentiate_Three_Point_Scalar(1, 0, 1, 2);
+	}
 
+	for (size_t i = std::max(first_derivative, static_cast<size_t>(2)); i + 2 < count; i++) {
+		coefficient(i, 1) = Differentiate_Akima_Scalar(i);
+	}
 
-	for (size_t i = 2; i < count - 2 - 1; i++) {
-		coefsOfPolynFunc[i] = mInputLevels[i];
+	coefficient(count - 2, 1) = Differentiate_Three_Point_Scalar(count - 2, count - 3, count - 2, count - 1);
+	coefficient(count - 1, 1) = Differentiate_Three_Point_Scalar(count - 1, count - 3, count - 2, count - 1);
 
-		fd = computeFd(i);
+	//interpolate on basis of Hermite's algorithm, using the derivatives at both ends of the interval
+	for (size_t i = first_derivative > 0 ? first_derivative - 1 : 0; i + 1 < count; i++) {
+		double w = times[i + 1] - times[i];
+		double w2 = w * w;
 
-		if (i != 2) { //is not first loop
-			compute3th4thCoefs(i);
-		}
+		double yv = levels[i];
+		double yvP = levels[i + 1];
 
-		fdPrev = fd;
-		firstDerivatives[i] = fd;
+		double fd = coefficient(i, 1);
+		double fdP = coefficient(i + 1, 1);
 
-		//d1 = d2; - actually, it's never used then
-		d2 = d3;
-		d3 = d4;
-		d4 = (mInputLevels[3 + i] - mInputLevels[2 + i]) / (mInputTimes[3 + i] - mInputTimes[2 + i]);
+		double divTmp = (yv - yvP) / w;
 
-		w1 = w2;
-		w2 = w3;
-		w3 = fabs(d3 - d4);
+		coefficient(i, 2) = (-3 * divTmp - 2 * fd - fdP) / w;
+		coefficient(i, 3) = (2 * divTmp + fd + fdP) / w2;
 	}
 
-	size_t i = count - 3;
-	//last iteration
-	coefsOfPolynFunc[i] = mInputLevels[i];
-	fd = computeFd(i);
-
-	compute3th4thCoefs(i);
+	//the last knot has no interval to interpolate
+	coefficient(count - 1, 2) = 0.0;
+	coefficient(count - 1, 3) = 0.0;
+}
 
-	fdPrev = fd;
-	firstDerivatives[i] = fd;
+double CAkima::Differentiate_Akima_Scalar(size_t index) {
+	const auto& times = mKnots.Times();
+	const auto& levels = mKnots.Levels();
 
-	//compute last elements of 3. and 4. coefs
-	i++;
-	compute3th4thCoefs(i);
+	auto slope = [&times, &levels](const size_t i) {
+		return (levels[i + 1] - levels[i]) / (times[i + 1] - times[i]);
+	};
 
-	coefsOfPolynFunc[count - 2] = mInputLevels[count - 2];
-	coefsOfPolynFunc[count - 1] = mInputLevels[count - 1];
+	const double d1 = slope(index - 2);
+	const double d2 = slope(index - 1);
+	const double d3 = slope(index);
+	const double d4 = slope(index + 1);
 
-	firstDerivatives[0] = Differentiate_Three_Point_Scalar(0, 0, 1, 2);
-	firstDerivatives[1] = Differentiate_Three_Point_Scalar(1, 0, 1, 2);
-	firstDerivatives[count - 2] = Differentiate_Three_Point_Scalar(count - 2, count - 3, count - 2, count - 1);
-	firstDerivatives[count - 1] = Differentiate_Three_Point_Scalar(count - 1, count - 3, count - 2, count - 1);
+	const double w1 = fabs(d1 - d2);
+	const double w3 = fabs(d3 - d4);
 
-	mCoefficients = Interpolate_Hermite_Scalar(coefsOfPolynFunc);
+	if (FP_ZERO == std::fpclassify(w3) && FP_ZERO == std::fpclassify(w1)) {
+		double xv = times[index]; // no need to optimize this,
+		double xvP = times[index + 1]; // expecting to be very rare case
+		double xvM = times[index - 1];
+		return (((xvP - xv) * d2) + ((xv - xvM) * d3)) / (xvP - xvM);
+	}
+	else {
+		return ((w3 * d2) + (w1 * d3)) / (w3 + w1);
+	}
 }
 
 double CAkima::Differentiate_Three_Point_Scalar(size_t indexOfDifferentiation, //0, 1, -2, -1
@@ -180,13 +172,16 @@ double CAkima::Differentiate_Three_Point_Scalar(size_t indexOfDifferentiation, /
 												size_t indexOfSecondsample, //1, 1, -2, -2
 												size_t indexOfThirdSample) { //2, 2, -1, -1
 
-	double x0 = mInputLevels[indexOfFirstSample];
-	double x1 = mInputLevels[indexOfSecondsample];
-	double x2 = mInputLevels[indexOfThirdSample];
+	const auto& times = mKnots.Times();
+	const auto& levels = mKnots.Levels();
 
-	double t = mInputTimes[indexOfDifferentiation] - mInputTimes[indexOfFirstSample];
-	double t1 = mInputTimes[indexOfSecondsample] - mInputTimes[indexOfFirstSample];
-	double t2 = mInputTimes[indexOfThirdSample] - mInputTimes[indexOfFirstSample];
+	double x0 = levels[indexOfFirstSample];
+	double x1 = levels[indexOfSecondsample];
+	double x2 = levels[indexOfThirdSample];
+
+	double t = times[indexOfDifferentiation] - times[indexOfFirstSample];
+	double t1 = times[indexOfSecondsample] - times[indexOfFirstSample];
+	double t2 = times[indexOfThirdSample] - times[indexOfFirstSample];
 
 	double a = (x2 - x0 - (t2 / t1 * (x1 - x0))) / (t2 * t2 - t1 * t2);
 	double b = (x1 - x0 - a * t1 * t1) / t1;
@@ -194,34 +189,6 @@ double CAkima::Differentiate_Three_Point_Scalar(size_t indexOfDifferentiation, /
 	return (2 * a * t) + b;
 }
 
-std::vector<double> CAkima::Interpolate_Hermite_Scalar(std::vector<double> coefsOfPolynFunc) {
-	
-	const size_t count = mInputLevels.size();
-	auto firstDerivatives = &coefsOfPolynFunc[count];
-	size_t numberOfDiffAndWeightElements = count - 1;
-
-	//we should not get here with count less than 5
-
-	size_t dimSize = count;
-	for (size_t i = 0; i < numberOfDiffAndWeightElements; i++) {
-		double w = mInputTimes[i + 1] - mInputTimes[i];
-		double w2 = w * w;
-
-		double yv = mInputLevels[i];
-		double yvP = mInputLevels[i + 1];
-
-		double fd = firstDerivatives[i];
-		double fdP = firstDerivatives[i + 1];
-
-		double divTmp = (yv - yvP) / w;
-
-		coefsOfPolynFunc[2 * dimSize + i] = (-3 * divTmp - 2 * fd - fdP) / w;
-		coefsOfPolynFunc[3 * dimSize + i] = (2 * divTmp + fd + fdP) / w2;
-	}
-
-	return coefsOfPolynFunc;
-}
-
 HRESULT IfaceCalling CAkima::GetLevels(const double* times, double* const levels, const size_t count, const size_t derivation_order) {
 
 	assert((times != nullptr) && (levels != nullptr) && (count > 0));
@@ -238,53 +205,40 @@ HRESULT IfaceCalling CAkima::GetLevels(const double* times, double* const levels
 		return E_INVALIDARG;
 	}
 
-	const size_t measured_size_mul3 = mInputLevels.size() * 3;
-	const size_t measured_size_mul2 = mInputLevels.size() * 2;
-	const size_t measured_size = mInputLevels.size();
-	//const double max_time = mInputTimes[mInputTimes.size() - 1];
-
-	for (size_t i = 0; i< count; i++) {
-		size_t knot_index = std::numeric_limits<size_t>::max();
-		if (times[i] == mInputTimes[0]) {
-			knot_index = 0;
-		}
-		else if (times[i] == mInputTimes[mInputTimes.size() - 1]) {
-			knot_index = mInputTimes.size() - 1;
-		}
-		else if (!std::isnan(times[i])) {
-			std::vector<double>::iterator knot_iter = std::upper_bound(mInputTimes.begin(), mInputTimes.end(), times[i]);
-			if (knot_iter != mInputTimes.end()) {
-				knot_index = std::distance(mInputTimes.begin(), knot_iter) - 1;
-			}
-		}
-
-		if (knot_index != std::numeric_limits<size_t>::max()) {
-			const double desired_time_knot_offset = times[i] - mInputTimes[knot_index];
-
-			double res = 0.0;
-			switch (derivation_order) {
-				//Horner's evaluation method
-				case scgms::apxNo_Derivation:
-					res = mCoefficients[measured_size_mul3 + knot_index];
-					res = desired_time_knot_offset * res + mCoefficients[measured_size_mul2 + knot_index];
-					res = desired_time_knot_offset * res + mCoefficients[measured_size + knot_index];
-					levels[i] = desired_time_knot_offset * res + mCoefficients[/*measured_size * 0*/ +knot_index];
-					break;
-
-				case scgms::apxFirst_Order_Derivation:
-					res = 3.0 * mCoefficients[measured_size_mul3 + knot_index];
-					res = desired_time_knot_offset * res + 2.0 * mCoefficients[measured_size_mul2 + knot_index];
-					levels[i] = desired_time_knot_offset * res + mCoefficients[measured_size + knot_index];
-					break;
-
-				default: levels[i] = 0.0;
-					break;
-			}
+	if (mKnot_Indices.size() < count) {
+		mKnot_Indices.resize(count);
+	}
+	auto offsets = Reserve_Eigen_Buffer(mOffsets, count);
+	mKnots.Locate(times, count, mKnot_Indices.data(), offsets.data());
+
+	//gather the coefficients of the located knots into lanes; a time outside the knots gets NaN
+	auto a = Reserve_Eigen_Buffer(mLane_Coefficients[0], count);
+	auto b = Reserve_Eigen_Buffer(mLane_Coefficients[1], count);
+	auto c = Reserve_Eigen_Buffer(mLane_Coefficients[2], count);
+	auto d = Reserve_Eigen_Buffer(mLane_Coefficients[3], count);
+	for (size_t i = 0; i < count; i++) {
+		const size_t knot_index = mKnot_Indices[i];
+		if (knot_index != CSignal_Knots::Invalid_Knot) {
+			const double* coefficients = &mCoefficients[knot_index * Coefficient_Count];
+			a[i] = coefficients[0];
+			b[i] = coefficients[1];
+			c[i] = coefficients[2];
+			d[i] = coefficients[3];
 		}
 		else {
-			levels[i] = std::numeric_limits<double>::quiet_NaN();
+			a[i] = b[i] = std::numeric_limits<double>::quiet_NaN();
+			c[i] = d[i] = 0.0;
 		}
 	}
 
+	//Horner's evaluation method, in all the lanes at once
+	Eigen::Map<TVector1D> converted_levels{ Map_Double_To_Eigen<TVector1D>(levels, count) };
+	if (derivation_order == scgms::apxNo_Derivation) {
+		converted_levels = ((d * offsets + c) * offsets + b) * offsets + a;
+	}
+	else {
+		converted_levels = (3.0 * d * offsets + 2.0 * c) * offsets + b;
+	}
+
 	return count > 0 ? S_OK : S_FALSE;
-}
\ No newline at end of file
+}
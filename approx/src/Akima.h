@@ -37,30 +37,43 @@
 #pragma once
 
 #include <scgms/iface/ApproxIface.h>
+#include <scgms/iface/ApproxExtIface.h>
 #include <scgms/iface/UIIface.h>
 #include <scgms/rtl/referencedImpl.h>
 #include <scgms/rtl/DeviceLib.h>
+#include <scgms/rtl/Eigen_Buffer.h>
+
+#include "signal_knots.h"
 
 #include <mutex>
 
 #pragma warning( push )
 #pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
 
-class CAkima : public scgms::IApproximator, public virtual refcnt::CReferenced {
+class CAkima : public scgms::IApproximator, public virtual scgms::IApproximation_Locality, public virtual refcnt::CReferenced {
 	protected:
-		scgms::WSignal mSignal;
+		CSignal_Knots mKnots;
 		const size_t MINIMUM_NUMBER_POINTS = 5;
-		std::vector<double> mInputTimes, mInputLevels, mCoefficients;
+		static constexpr size_t Coefficient_Count = 4;
+		std::vector<double> mCoefficients;	//interleaved, i.e.; all the coefficients of a knot, from the lowest power, then the next knot
+
+		//GetLevels locates the knots first, then gathers their coefficients into lanes to evaluate the polynomials with SIMD
+		static thread_local std::vector<size_t> mKnot_Indices;
+		static thread_local TVector1D mOffsets, mLane_Coefficients[Coefficient_Count];
 
 		std::mutex mUpdate_Guard;
 		bool Update();
 	protected:
 		/**
-		* Computes coefficients of Akima Interpolation.
-		* Coefficients are stored in one array containing coefficients stored in
-		* column fashion. Eg. first coefficients are stored between 0 and count position (inclusive).
+		* Computes coefficients of Akima Interpolation, starting with those affected by the first changed knot.
+		* As Akima uses two neighbouring knots on each side, the appended knots change just a few former coefficients.
+		*/
+		void Compute_Coefficients(const size_t first_changed);	//modifies mCoefficients
+
+		/**
+		* Akima's derivative at an inner knot, i.e.; with two neighbours on each side
 		*/
-		void Compute_Coefficients();	//modifies mCoefficients
+		double Differentiate_Akima_Scalar(size_t index);
 
 		/**
 		* From mMeasured, it computes differences within three points as needed by Akima interpolation
@@ -71,18 +84,13 @@ class CAkima : public scgms::IApproximator, public virtual refcnt::CReferenced {
 												size_t indexOfSecondsample,
 												size_t indexOfThirdSample);
 
-		/**
-		* Interpolate on basis of Hermite's algorithm
-		*
-		* @param firstDerivatives pointer to output structure with first derivates
-		*/
-		std::vector<double> Interpolate_Hermite_Scalar(std::vector<double> coefsOfPolynFunc);
-
 	public:
-		CAkima(scgms::WSignal signal);
+		CAkima(scgms::ISignal* signal);
 		virtual ~CAkima() {};
 
+		virtual HRESULT IfaceCalling QueryInterface(const GUID*  riid, void ** ppvObj) override;
 		virtual HRESULT IfaceCalling GetLevels(const double* times, double* const levels, const size_t count, const size_t derivation_order) override;
+		virtual HRESULT IfaceCalling Get_Preceding_Affected_Levels(size_t* count) const override;
 };
 
-#pragma warning( pop )
\ No newline at end of file
+#pragma warning( pop )
@@ -81,14 +81,14 @@ DLL_EXPORT HRESULT IfaceCalling do_get_approximator_descriptors(scgms::TApprox_D
 DLL_EXPORT HRESULT IfaceCalling do_create_approximator(const GUID *approx_id, scgms::ISignal *signal, scgms::IApproximator **approx) {
 
 	if (approx_id == nullptr) { //if no id is given, let's use the default approximator
-		return Manufacture_Object<CAkima>(approx, scgms::WSignal{ signal });
+		return Manufacture_Object<CAkima>(approx, signal);
 	}
 
 	if (*approx_id == line::LineApprox_Descriptor.id) {
-		return Manufacture_Object<CLine_Approximator>(approx, scgms::WSignal{ signal });
+		return Manufacture_Object<CLine_Approximator>(approx, signal);
 	}
 	else if (*approx_id == akima::Akima_Descriptor.id) {
-		return Manufacture_Object<CAkima>(approx, scgms::WSignal{ signal });
+		return Manufacture_Object<CAkima>(approx, signal);
 	}
 	else if (*approx_id == avgexp::AvgExp_Descriptor.id) {
 		return Manufacture_Object<CAvgExpApprox>(approx, scgms::WSignal{ signal }, AvgExpElementary);
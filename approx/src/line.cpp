@@ -40,37 +40,48 @@
 #include <cmath>
 #include <algorithm>
 
-CLine_Approximator::CLine_Approximator(scgms::WSignal signal): mSignal(signal) {
+thread_local std::vector<size_t> CLine_Approximator::mKnot_Indices;
+thread_local TVector1D CLine_Approximator::mOffsets, CLine_Approximator::mLane_Slopes, CLine_Approximator::mLane_Levels;
+
+CLine_Approximator::CLine_Approximator(scgms::ISignal* signal): mKnots(signal) {
 	Update();
 }
 
+HRESULT IfaceCalling CLine_Approximator::QueryInterface(const GUID*  riid, void ** ppvObj) {
+	if (Internal_Query_Interface<scgms::IApproximation_Locality>(scgms::IID_Approximation_Locality, *riid, ppvObj)) {
+		return S_OK;
+	}
+
+	return E_NOINTERFACE;
+}
+
+HRESULT IfaceCalling CLine_Approximator::Get_Preceding_Affected_Levels(size_t* count) const {
+	*count = 1;	//just the slope of the interval ending with the changed knot
+	return S_OK;
+}
+
 bool CLine_Approximator::Update() {
 	std::lock_guard<std::mutex> local_guard{ mUpdate_Guard };
 
-	size_t update_count;
-	if (mSignal.Get_Discrete_Bounds(nullptr, nullptr, &update_count) != S_OK) {
+	size_t first_changed;
+	if (!mKnots.Update(first_changed)) {
+		mSlopes.clear();
 		return false;
 	}
 
-	if (mInputTimes.size() != update_count) {
-		mInputTimes.resize(update_count);
-		mInputLevels.resize(update_count);
-		mSlopes.resize(update_count);
-	}
-	else {// valCount == oldCount, no need to update
+	const size_t update_count = mKnots.Size();
+	if ((mSlopes.size() == update_count) && (first_changed == update_count)) {// valCount == oldCount, no need to update
 		return true;
 	}
 
-	size_t filled;
-	if (mSignal.Get_Discrete_Levels(mInputTimes.data(), mInputLevels.data(), update_count, &filled) != S_OK) {
-		// error, we need to recalculate everything
-		mInputTimes.clear();
-		return false;
-	}
+	// calculate slopes, but just those affected by the changed knots
+	const size_t first_slope = std::min(first_changed, mSlopes.size());
+	mSlopes.resize(update_count);
 
-	// calculate slopes
-	for (size_t i = 0; i < update_count - 1; i++) {
-		mSlopes[i] = (mInputLevels[i + 1] - mInputLevels[i]) / (mInputTimes[i + 1] - mInputTimes[i]);
+	const auto& input_times = mKnots.Times();
+	const auto& input_levels = mKnots.Levels();
+	for (size_t i = first_slope > 0 ? first_slope - 1 : 0; i + 1 < update_count; i++) {
+		mSlopes[i] = (input_levels[i + 1] - input_levels[i]) / (input_times[i + 1] - input_times[i]);
 	}
 
 	if (update_count > 1) {
@@ -92,41 +103,40 @@ HRESULT IfaceCalling CLine_Approximator::GetLevels(const double* times, double*
 		return E_FAIL;
 	}
 
-	// size of mSlopes is lower by 1 than mInputTimes/Levels, and we know how to approximate just in this range
-	for (size_t i = 0; i< count; i++) {
-		size_t knot_index = std::numeric_limits<size_t>::max();
-		if (times[i] == mInputTimes[0]) {
-			knot_index = 0;
-		}
-		else if (times[i] == mInputTimes[mInputTimes.size() - 1]) {
-			knot_index = mInputTimes.size() - 1;
+	if (mKnot_Indices.size() < count) {
+		mKnot_Indices.resize(count);
+	}
+	auto offsets = Reserve_Eigen_Buffer(mOffsets, count);
+	mKnots.Locate(times, count, mKnot_Indices.data(), offsets.data());
+
+	//gather the slopes and levels of the located knots into lanes; a time outside the knots gets NaN
+	const auto& input_levels = mKnots.Levels();
+	auto slopes = Reserve_Eigen_Buffer(mLane_Slopes, count);
+	auto knot_levels = Reserve_Eigen_Buffer(mLane_Levels, count);
+	for (size_t i = 0; i < count; i++) {
+		const size_t knot_index = mKnot_Indices[i];
+		if (knot_index != CSignal_Knots::Invalid_Knot) {
+			slopes[i] = mSlopes[knot_index];
+			knot_levels[i] = input_levels[knot_index];
 		}
-		else if (!std::isnan(times[i])) {
-			std::vector<double>::iterator knot_iter = std::upper_bound(mInputTimes.begin(), mInputTimes.end(), times[i]);
-			if (knot_iter != mInputTimes.end()) {
-				knot_index = std::distance(mInputTimes.begin(), knot_iter) - 1;
-			}
+		else {
+			slopes[i] = knot_levels[i] = std::numeric_limits<double>::quiet_NaN();
 		}
+	}
 
-		if (knot_index != std::numeric_limits<size_t>::max()) {
-
-			switch (derivation_order) {
-				case scgms::apxNo_Derivation:
-					levels[i] = mSlopes[knot_index] * (times[i] - mInputTimes[knot_index]) + mInputLevels[knot_index];
-					break;
+	Eigen::Map<TVector1D> converted_levels{ Map_Double_To_Eigen<TVector1D>(levels, count) };
+	switch (derivation_order) {
+		case scgms::apxNo_Derivation:
+			converted_levels = slopes * offsets + knot_levels;
+			break;
 
-				case scgms::apxFirst_Order_Derivation:
-					levels[i] = mSlopes[knot_index];
-					break;
+		case scgms::apxFirst_Order_Derivation:
+			converted_levels = slopes;
+			break;
 
-				default:
-					levels[i] = 0.0;
-					break;
-				}
-		}
-		else {
-			levels[i] = std::numeric_limits<double>::quiet_NaN();
-		}
+		default:
+			converted_levels = slopes * 0.0;	//zero, but NaN outside the knots
+			break;
 	}
 
 	return count > 0 ? S_OK : S_FALSE;
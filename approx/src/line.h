@@ -37,9 +37,13 @@
 #pragma once
 
 #include <scgms/iface/ApproxIface.h>
+#include <scgms/iface/ApproxExtIface.h>
 #include <scgms/iface/UIIface.h>
 #include <scgms/rtl/referencedImpl.h>
 #include <scgms/rtl/DeviceLib.h>
+#include <scgms/rtl/Eigen_Buffer.h>
+
+#include "signal_knots.h"
 
 #include <mutex>
 
@@ -49,19 +53,25 @@
 /*
  * Line approximator class
  */
-class CLine_Approximator : public scgms::IApproximator, public virtual refcnt::CReferenced {
+class CLine_Approximator : public scgms::IApproximator, public virtual scgms::IApproximation_Locality, public virtual refcnt::CReferenced {
 	protected:
-		scgms::WSignal mSignal;
-		std::vector<double> mInputTimes, mInputLevels, mSlopes;
+		CSignal_Knots mKnots;
+		std::vector<double> mSlopes;
+
+		//GetLevels locates the knots first, then gathers their slopes and levels into lanes to evaluate them with SIMD
+		static thread_local std::vector<size_t> mKnot_Indices;
+		static thread_local TVector1D mOffsets, mLane_Slopes, mLane_Levels;
 		std::mutex mUpdate_Guard;
 
 		bool Update();
 
 	public:
-		CLine_Approximator(scgms::WSignal signal);
+		CLine_Approximator(scgms::ISignal* signal);
 		virtual ~CLine_Approximator() {};
 
+		virtual HRESULT IfaceCalling QueryInterface(const GUID*  riid, void ** ppvObj) override;
 		virtual HRESULT IfaceCalling GetLevels(const double* times, double* const levels, const size_t count, const size_t derivation_order) override;
+		virtual HRESULT IfaceCalling Get_Preceding_Affected_Levels(size_t* count) const override;
 };
 
 #pragma warning( pop )
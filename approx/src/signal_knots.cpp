@@ -0,0 +1,192 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "signal_knots.h"
+
+#include <scgms/rtl/referencedImpl.h>
+
+#include <algorithm>
+#include <cstring>
+
+CSignal_Knots::CSignal_Knots(scgms::ISignal* signal) : mSignal(signal) {
+	//
+}
+
+bool CSignal_Knots::Update(size_t& first_changed) {
+	first_changed = mTimes.size();
+
+	size_t count = 0;
+	if (!mSignal || (mSignal->Get_Discrete_Bounds(nullptr, nullptr, &count) != S_OK)) {
+		return false;
+	}
+
+	if ((count == 0) && mTimes.empty()) {
+		return true;	//nothing to update yet
+	}
+
+	if (!mSpans_Queried) {
+		//the signal is fully constructed by now, as it already has some levels
+		refcnt::SReferenced<scgms::ISignal_Discrete_Spans> spans;
+		refcnt::Query_Interface<scgms::ISignal, scgms::ISignal_Discrete_Spans>(mSignal, scgms::IID_Signal_Discrete_Spans, spans);
+		mSpans = spans.get();
+		mSpans_Queried = true;
+	}
+
+	bool updated = false;
+	if (mSpans) {
+		uint64_t revision = 0;
+		if (mSpans->Get_Discrete_Revision(&revision) == S_OK) {
+			if ((count == mTimes.size()) && (revision == mRevision)) {
+				return true;	//no need to update
+			}
+
+			updated = Update_From_Spans(count, revision == mRevision, first_changed);
+			mRevision = revision;
+		}
+	}
+	else {
+		if (count == mTimes.size()) {
+			return true;	//such a signal does not tell us about a changed level, so that we update with a new one only
+		}
+
+		updated = Update_From_Copy(count, first_changed);
+	}
+
+	if (!updated) {
+		//error, we need to recalculate everything
+		mTimes.clear();
+		mLevels.clear();
+		first_changed = 0;
+	}
+
+	return updated;
+}
+
+void CSignal_Knots::Locate(const double* times, const size_t count, size_t* const knot_indices, double* const offsets) const {
+	//the callers pass the sorted times nearly always, so we keep a cursor at the last located knot and walk from it
+	//a few steps at most, before giving up on the walk and searching the rest of the knots
+	constexpr size_t Max_Walk_Steps = 8;
+
+	const size_t last_knot = mTimes.size() - 1;
+	size_t cursor = Invalid_Knot;
+
+	for (size_t i = 0; i < count; i++) {
+		const double time = times[i];
+		size_t knot_index = Invalid_Knot;
+
+		if (time == mTimes[0]) {
+			knot_index = 0;
+		}
+		else if (time == mTimes[last_knot]) {
+			knot_index = last_knot;
+		}
+		else if ((time > mTimes[0]) && (time < mTimes[last_knot])) {	//false for NaN as well
+			if ((cursor != Invalid_Knot) && (mTimes[cursor] <= time)) {
+				//the times are sorted so far, walk the knots forward
+				size_t steps = 0;
+				while ((steps < Max_Walk_Steps) && (mTimes[cursor + 1] <= time)) {
+					cursor++;
+					steps++;
+				}
+
+				if (steps == Max_Walk_Steps) {
+					cursor = std::distance(mTimes.begin(), std::upper_bound(mTimes.begin() + cursor, mTimes.end(), time)) - 1;
+				}
+			}
+			else {
+				cursor = std::distance(mTimes.begin(), std::upper_bound(mTimes.begin(), mTimes.end(), time)) - 1;
+			}
+
+			knot_index = cursor;
+		}
+
+		knot_indices[i] = knot_index;
+		offsets[i] = knot_index != Invalid_Knot ? time - mTimes[knot_index] : 0.0;
+	}
+}
+
+bool CSignal_Knots::Update_From_Spans(const size_t count, const bool appended_only, size_t& first_changed) {
+	const scgms::TLevels_Span *begin = nullptr, *end = nullptr;
+	if (mSpans->Get_Discrete_Spans(&begin, &end) != S_OK) {
+		return false;
+	}
+
+	//with the same revision, the known knots are still the leading levels of the signal
+	const size_t known = mTimes.size();
+	first_changed = appended_only && (count > known) ? known : 0;
+	mTimes.resize(count);
+	mLevels.resize(count);
+
+	//copy just the changed knots
+	size_t offset = 0;
+	for (auto span = begin; (span != end) && (offset < count); span++) {
+		if (offset + span->count > first_changed) {
+			const size_t skip = first_changed > offset ? first_changed - offset : 0;
+			const size_t to_copy = std::min(span->count, count - offset) - skip;
+			std::memcpy(mTimes.data() + offset + skip, span->times + skip, to_copy * sizeof(double));
+			std::memcpy(mLevels.data() + offset + skip, span->levels + skip, to_copy * sizeof(double));
+		}
+		offset += span->count;
+	}
+
+	return offset >= count;
+}
+
+bool CSignal_Knots::Update_From_Copy(const size_t count, size_t& first_changed) {
+	std::vector<double> times(count), levels(count);
+
+	size_t filled = 0;
+	if (mSignal->Get_Discrete_Levels(times.data(), levels.data(), count, &filled) != S_OK) {
+		return false;
+	}
+	times.resize(filled);
+	levels.resize(filled);
+
+	//compare with the known knots, as any of them might have changed, not just the first and the last one
+	const size_t known = mTimes.size();
+	first_changed = 0;
+	if (filled >= known) {
+		while ((first_changed < known) && (times[first_changed] == mTimes[first_changed]) && (levels[first_changed] == mLevels[first_changed])) {
+			first_changed++;
+		}
+	}
+
+	mTimes.swap(times);
+	mLevels.swap(levels);
+
+	return true;
+}
@@ -0,0 +1,77 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#pragma once
+
+#include <scgms/iface/ApproxIface.h>
+#include <scgms/iface/ApproxExtIface.h>
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+ * Copy of the approximated signal's discrete levels, which the approximators update incrementally
+ */
+class CSignal_Knots {
+	protected:
+		scgms::ISignal* mSignal;								//non-owning, the signal owns the approximator
+		scgms::ISignal_Discrete_Spans* mSpans = nullptr;		//non-owning as well, queried on the first update
+		bool mSpans_Queried = false;
+		uint64_t mRevision = 0;									//of the spans, which the knots were read from
+		std::vector<double> mTimes, mLevels;
+
+		bool Update_From_Spans(const size_t count, const bool appended_only, size_t& first_changed);
+		bool Update_From_Copy(const size_t count, size_t& first_changed);
+
+	public:
+		CSignal_Knots(scgms::ISignal* signal);
+
+		//synchronizes the knots with the signal; first_changed is the index of the first knot, which has changed
+		//with the spans, the appended levels are read alone, while any other change of the signal's revision makes all the knots change
+		//without them, the levels are copied and compared, once their count changes
+		bool Update(size_t& first_changed);
+
+		//for each time, finds the index of the knot starting its interval and the offset from the knot; the index is Invalid_Knot
+		//for a time outside the knots; the sorted times are located with a cursor walking the knots, the others with a binary search
+		static constexpr size_t Invalid_Knot = std::numeric_limits<size_t>::max();
+		void Locate(const double* times, const size_t count, size_t* const knot_indices, double* const offsets) const;
+
+		size_t Size() const { return mTimes.size(); }
+		const std::vector<double>& Times() const { return mTimes; }
+		const std::vector<double>& Levels() const { return mLevels; }
+};
@@ -0,0 +1,341 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#include "measurement.h"
+#include "scenarios.h"
+
+#include <scgms/iface/SimpleExtIface.h>
+#include <scgms/rtl/Dynamic_Library.h>
+#include <scgms/rtl/FilesystemLib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+#if defined(_WIN32)
+	const wchar_t* rsScgms_Library = L"scgms.dll";
+#elif defined(__APPLE__)
+	const wchar_t* rsScgms_Library = L"libscgms.dylib";
+#else
+	const wchar_t* rsScgms_Library = L"libscgms.so";
+#endif
+
+	//Shutdown_SCGMS, as exported by simple_bindings.cpp
+	using TShutdown = BOOL(SimpleCalling *)(const scgms_execution_t execution, BOOL wait_for_shutdown);
+
+	struct TScgms_Library {
+		CDynamic_Library library;
+		TExecute_SCGMS_Configuration_Batched execute = nullptr;
+		TInject_SCGMS_Events inject = nullptr;
+		TShutdown shutdown = nullptr;
+
+		bool Load(const filesystem::path &path) {
+			if (!library.Load(path)) {
+				return false;
+			}
+
+			execute = reinterpret_cast<TExecute_SCGMS_Configuration_Batched>(library.Resolve("Execute_SCGMS_Configuration_Batched"));
+			inject = reinterpret_cast<TInject_SCGMS_Events>(library.Resolve("Inject_SCGMS_Events"));
+			shutdown = reinterpret_cast<TShutdown>(library.Resolve("Shutdown_SCGMS"));
+			return execute && inject && shutdown;
+		}
+	};
+
+	struct TRun_Result {
+		bool succeeded = false;
+		size_t injected_events = 0;
+		size_t emitted_events = 0;
+		double seconds = 0.0;
+		double p50_us = 0.0, p99_us = 0.0;
+		double allocations_per_event = 0.0;
+		size_t peak_rss = 0;
+	};
+
+	std::atomic<size_t> emitted_events{ 0 };
+
+	HRESULT SimpleCalling On_Output(const TSCGMS_Event_Data *events, const size_t count) {
+		emitted_events.fetch_add(count, std::memory_order_relaxed);
+
+		for (size_t i = 0; i < count; i++) {
+			if ((events[i].event_code == static_cast<decltype(events[i].event_code)>(scgms::NDevice_Event_Code::Error)) && events[i].str) {
+				std::wcerr << L"error: " << events[i].str << std::endl;
+			}
+		}
+
+		return S_OK;
+	}
+
+	TRun_Result Run(TScgms_Library &scgms_library, const std::string &configuration, const bool injected, const TBench_Options &options) {
+		TRun_Result result;
+		std::vector<TSCGMS_Event_Data> events;
+		CLatency_Samples latencies;
+		if (injected) {
+			events = Synthetic_Events(options);
+			latencies.Reserve(events.size());
+		}
+
+		emitted_events = 0;
+		const size_t allocations_before = Allocation_Count();
+		const auto started = std::chrono::steady_clock::now();
+
+		scgms_execution_t execution = scgms_library.execute(configuration.c_str(), &On_Output, nullptr, 0, 0);
+		if (!execution) {
+			return result;
+		}
+
+		const size_t batch_size = std::max<size_t>(1, options.batch_size);
+		result.succeeded = true;
+		for (size_t i = 0; i < events.size(); i += batch_size) {
+			const size_t count = std::min(batch_size, events.size() - i);
+			if (options.rate > 0.0) {
+				std::this_thread::sleep_until(started + std::chrono::duration<double>(static_cast<double>(i) / options.rate));
+			}
+
+			const auto injection_started = std::chrono::steady_clock::now();
+			if (!scgms_library.inject(execution, events.data() + i, count)) {
+				result.succeeded = false;
+				break;
+			}
+
+			latencies.Add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - injection_started).count()), count);
+			result.injected_events += count;
+		}
+
+		//the injected stream ends with the shut down event, while the generating chains emit their own
+		scgms_library.shutdown(execution, result.succeeded ? TRUE : FALSE);
+
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+		result.emitted_events = emitted_events;
+		const size_t processed_events = std::max<size_t>(1, injected ? result.injected_events : result.emitted_events);
+		result.allocations_per_event = static_cast<double>(Allocation_Count() - allocations_before) / static_cast<double>(processed_events);
+		result.p50_us = latencies.Percentile(50.0);
+		result.p99_us = latencies.Percentile(99.0);
+		result.peak_rss = Peak_Resident_Set_Size();
+
+		return result;
+	}
+
+	void Report(const std::string &name, const TRun_Result &result, const bool injected) {
+		const size_t processed_events = injected ? result.injected_events : result.emitted_events;
+		const double events_per_second = result.seconds > 0.0 ? static_cast<double>(processed_events) / result.seconds : 0.0;
+
+		std::cout << std::left << std::setw(12) << name << std::right
+			<< std::setw(6) << (result.succeeded ? "ok" : "FAIL")
+			<< std::setw(12) << processed_events
+			<< std::setw(12) << result.emitted_events
+			<< std::setw(14) << std::fixed << std::setprecision(0) << events_per_second
+			<< std::setw(10) << std::setprecision(2) << result.p50_us
+			<< std::setw(10) << result.p99_us
+			<< std::setw(10) << result.allocations_per_event
+			<< std::setw(10) << (result.peak_rss / (1024 * 1024))
+			<< std::endl;
+	}
+
+	//the whole text has to be an unsigned number within [min_value, max_value]
+	bool Parse_Count(const char *text, const size_t min_value, const size_t max_value, size_t &value) {
+		const std::string str{ text };
+		if (str.empty() || !std::isdigit(static_cast<unsigned char>(str[0]))) {
+			return false;	//stoull would accept a leading whitespace or minus sign
+		}
+
+		try {
+			size_t parsed_len = 0;
+			const unsigned long long parsed = std::stoull(str, &parsed_len);
+			if ((parsed_len != str.size()) || (parsed < min_value) || (parsed > max_value)) {
+				return false;
+			}
+			value = static_cast<size_t>(parsed);
+			return true;
+		}
+		catch (const std::exception&) {
+			return false;
+		}
+	}
+
+	bool Parse_Rate(const char *text, double &value) {
+		const std::string str{ text };
+		try {
+			size_t parsed_len = 0;
+			const double parsed = std::stod(str, &parsed_len);
+			if ((parsed_len != str.size()) || !std::isfinite(parsed) || (parsed < 0.0)) {
+				return false;
+			}
+			value = parsed;
+			return true;
+		}
+		catch (const std::exception&) {
+			return false;
+		}
+	}
+
+	void Print_Usage() {
+		std::cout << "Usage: scgms-bench [options] [scenario...]" << std::endl
+			<< "  --events N     number of the injected level events (default 100000)" << std::endl
+			<< "  --rate R       injected events per second, 0 for as fast as possible (default 0)" << std::endl
+			<< "  --signals K    number of the signals mixed in the injected stream, 1-4 (default 2)" << std::endl
+			<< "  --segments S   number of the segments of the injected stream (default 1)" << std::endl
+			<< "  --batch B      number of the events injected with a single call (default 1)" << std::endl
+			<< "  --days D       simulated days of the generating scenarios (default 7)" << std::endl
+			<< "  --repeat N     number of the runs of each scenario (default 1)" << std::endl
+			<< "  --config FILE  feeds the synthetic stream to the chain stored in FILE instead" << std::endl
+			<< "  --library FILE scgms library to benchmark (default the one next to this executable)" << std::endl
+			<< "Scenarios:" << std::endl;
+
+		for (const auto &scenario : Bench_Scenarios()) {
+			std::cout << "  " << std::left << std::setw(12) << scenario.name << scenario.description << std::endl;
+		}
+	}
+}
+
+int main(int argc, char** argv) {
+	TBench_Options options;
+	filesystem::path library_path = Get_Dll_Dir() / rsScgms_Library;
+	std::vector<std::string> selected;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		const bool has_value = i + 1 < argc;
+		bool valid = true;
+
+		if ((arg == "--help") || (arg == "-h")) {
+			Print_Usage();
+			return 0;
+		}
+		else if ((arg == "--events") && has_value) {
+			valid = Parse_Count(argv[++i], 1, std::numeric_limits<size_t>::max(), options.event_count);
+		}
+		else if ((arg == "--rate") && has_value) {
+			valid = Parse_Rate(argv[++i], options.rate);
+		}
+		else if ((arg == "--signals") && has_value) {
+			valid = Parse_Count(argv[++i], 1, 4, options.signal_count);
+		}
+		else if ((arg == "--segments") && has_value) {
+			valid = Parse_Count(argv[++i], 1, std::numeric_limits<size_t>::max(), options.segment_count);
+		}
+		else if ((arg == "--batch") && has_value) {
+			valid = Parse_Count(argv[++i], 1, std::numeric_limits<size_t>::max(), options.batch_size);
+		}
+		else if ((arg == "--days") && has_value) {
+			valid = Parse_Count(argv[++i], 1, std::numeric_limits<size_t>::max(), options.days);
+		}
+		else if ((arg == "--repeat") && has_value) {
+			valid = Parse_Count(argv[++i], 1, std::numeric_limits<size_t>::max(), options.repeats);
+		}
+		else if ((arg == "--config") && has_value) {
+			options.config_path = argv[++i];
+		}
+		else if ((arg == "--library") && has_value) {
+			library_path = argv[++i];
+		}
+		else if (!arg.empty() && (arg[0] != '-')) {
+			selected.push_back(arg);
+		}
+		else {
+			std::cerr << "Unknown option: " << arg << std::endl;
+			Print_Usage();
+			return 2;
+		}
+
+		if (!valid) {
+			std::cerr << "Invalid value of " << arg << ": " << argv[i] << std::endl;
+			Print_Usage();
+			return 2;
+		}
+	}
+
+	for (const auto &name : selected) {
+		const auto &scenarios = Bench_Scenarios();
+		if (std::find_if(scenarios.begin(), scenarios.end(), [&name](const TBench_Scenario &scenario) { return name == scenario.name; }) == scenarios.end()) {
+			std::cerr << "Unknown scenario: " << name << std::endl;
+			Print_Usage();
+			return 2;
+		}
+	}
+
+	TScgms_Library scgms_library;
+	if (!scgms_library.Load(library_path)) {
+		std::cerr << "Cannot load the scgms library or its simple interface: " << library_path.string() << std::endl;
+		return 1;
+	}
+
+	std::cout << std::left << std::setw(12) << "scenario" << std::right
+		<< std::setw(6) << "rc" << std::setw(12) << "events" << std::setw(12) << "emitted" << std::setw(14) << "events/s"
+		<< std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "allocs/ev" << std::setw(10) << "RSS MiB" << std::endl;
+
+	bool all_succeeded = true;
+	auto run_repeatedly = [&](const std::string &name, const std::string &configuration, const bool injected) {
+		for (size_t run = 0; run < std::max<size_t>(1, options.repeats); run++) {
+			const TRun_Result result = Run(scgms_library, configuration, injected, options);
+			Report(name, result, injected);
+			all_succeeded &= result.succeeded;
+		}
+	};
+
+	if (!options.config_path.empty()) {
+		std::ifstream config_file{ options.config_path, std::ios::binary };
+		if (!config_file) {
+			std::cerr << "Cannot read the configuration: " << options.config_path << std::endl;
+			return 1;
+		}
+
+		std::ostringstream configuration;
+		configuration << config_file.rdbuf();
+		run_repeatedly(filesystem::path{ options.config_path }.filename().string(), configuration.str(), true);
+	}
+	else {
+		for (const auto &scenario : Bench_Scenarios()) {
+			if (selected.empty() || (std::find(selected.begin(), selected.end(), scenario.name) != selected.end())) {
+				run_repeatedly(scenario.name, scenario.configuration(options), scenario.injected);
+			}
+		}
+	}
+
+	return all_succeeded ? 0 : 1;
+}
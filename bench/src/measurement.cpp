@@ -0,0 +1,135 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#include "measurement.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#ifdef _WIN32
+	#include <Windows.h>
+	#include <Psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+namespace {
+	std::atomic<size_t> allocation_count{ 0 };
+}
+
+//the replacements count the allocations of the entire process, including the dynamically loaded filters on POSIX systems
+void* operator new(size_t size) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size > 0 ? size : 1)) {
+		return ptr;
+	}
+
+	throw std::bad_alloc{};
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+	return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+size_t Allocation_Count() noexcept {
+	return allocation_count.load(std::memory_order_relaxed);
+}
+
+size_t Peak_Resident_Set_Size() noexcept {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return static_cast<size_t>(counters.PeakWorkingSetSize);
+	}
+
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+
+	#ifdef __APPLE__
+		return static_cast<size_t>(usage.ru_maxrss);			//bytes
+	#else
+		return static_cast<size_t>(usage.ru_maxrss) * 1024;	//kilobytes
+	#endif
+#endif
+}
+
+void CLatency_Samples::Add(const uint64_t nanoseconds, const size_t event_count) {
+	if (event_count > 0) {
+		mSamples.push_back(nanoseconds / event_count);
+	}
+}
+
+double CLatency_Samples::Percentile(const double percentile) {
+	if (mSamples.empty()) {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	const size_t index = (std::min)(mSamples.size() - 1, static_cast<size_t>(percentile * 0.01 * static_cast<double>(mSamples.size())));
+	std::nth_element(mSamples.begin(), mSamples.begin() + index, mSamples.end());
+	return static_cast<double>(mSamples[index]) * 0.001;
+}
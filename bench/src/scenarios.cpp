@@ -0,0 +1,171 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#include "scenarios.h"
+
+#include <scgms/rtl/rattime.h>
+#include <scgms/utils/string_utils.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <ctime>
+#include <limits>
+#include <sstream>
+
+namespace {
+	//the filters and models of the core modules, as listed by their descriptors
+	const char* rsMapping_Filter = "{8FAB525C-5E86-AB81-12CB-D95B1588530A}";
+	const char* rsCalculated_Signal_Filter = "{14A25F4C-E1B1-85C4-1274-9A0D11E09813}";
+	const char* rsSignal_Error_Filter = "{690FBC95-84CA-4627-B47C-9955EA817A4F}";
+	const char* rsSignal_Generator_Filter = "{9EEB3451-2A9D-49C1-BA37-2EC0B00E5E6D}";
+
+	const char* rsDiffusion_v2_Model = "{6645466A-28D6-4536-9A38-0FD6EA6FDB2D}";
+	const char* rsDiffusion_v2_Blood_Signal = "{D96A559B-E247-41E0-BD8E-788D20DB9A70}";
+	const char* rsUVA_Padova_S2013_Model = "{B387A874-8D1E-460B-A5EC-BA36AB7516DE}";
+	const char* rsAvg_Abs_Metric = "{D272A84D-50FF-46CE-977E-C8E368C3706A}";
+
+	constexpr GUID Bench_Device_Id = { 0x5c1e7a3b, 0x2d4f, 0x4e86, { 0x9a, 0x0b, 0x7e, 0x31, 0xc4, 0x58, 0x62, 0x9d } };	// {5C1E7A3B-2D4F-4E86-9A0B-7E31C458629D}
+
+	const std::array<GUID, 4> Signal_Mix = { scgms::signal_IG, scgms::signal_BG, scgms::signal_Requested_Insulin_Bolus, scgms::signal_Carb_Intake };
+
+	std::string Id(const GUID &id) {
+		return Narrow_WString(GUID_To_WString(id));
+	}
+
+	std::string Section(const size_t position, const char* filter_id) {
+		std::ostringstream section;
+		section << "[Filter_" << (position < 100 ? "0" : "") << (position < 10 ? "0" : "") << position << '_' << filter_id << "]\n";
+		return section.str();
+	}
+
+	std::string Replay_Configuration(const TBench_Options &options) {
+		return Section(1, rsMapping_Filter)
+			+ "Signal_Src_Id = " + Id(scgms::signal_BG) + "\n"
+			+ "Signal_Dst_Id = " + Id(scgms::signal_BG_Calibration) + "\n";
+	}
+
+	std::string Calculated_Signal_Configuration(const TBench_Options &options) {
+		return Section(1, rsCalculated_Signal_Filter)
+			+ "Model = " + rsDiffusion_v2_Model + "\n"
+			+ "Signal = " + rsDiffusion_v2_Blood_Signal + "\n"
+			+ "Prediction_Window = 00:00:00\n"
+			+ "Solve_Parameters = false\n";
+	}
+
+	std::string Metric_Configuration(const TBench_Options &options) {
+		return Section(1, rsSignal_Error_Filter)
+			+ "Description = bench\n"
+			+ "Reference_Signal = " + Id(scgms::signal_BG) + "\n"
+			+ "Error_Signal = " + Id(scgms::signal_IG) + "\n"
+			+ "Metric = " + rsAvg_Abs_Metric + "\n"
+			+ "Levels_Required = 1\n"
+			+ "Relative_Error = true\n"
+			+ "Squared_Diff = false\n"
+			+ "Prefer_More_Levels = false\n"
+			+ "Metric_Threshold = 0\n"
+			+ "Emit_Metric_As_Signal = true\n"
+			+ "Emit_Last_Value_Only = false\n";
+	}
+
+	std::string Generator_Configuration(const TBench_Options &options) {
+		return Section(1, rsSignal_Generator_Filter)
+			+ "Model = " + rsUVA_Padova_S2013_Model + "\n"
+			+ "Feedback_Name = bench\n"
+			+ "Synchronize_To_Signal = false\n"
+			+ "Time_Segment_Id = 1\n"
+			+ "Stepping = 00:05:00\n"
+			+ "Maximum_Time = " + std::to_string(options.days) + " 00:00:00\n"
+			+ "Shutdown_After_Last = true\n"
+			+ "Echo_Default_Parameters_As_Event = false\n";
+	}
+
+	TSCGMS_Event_Data Event(const scgms::NDevice_Event_Code code, const GUID &signal_id, const double device_time, const uint64_t segment_id, const double level) {
+		TSCGMS_Event_Data event{};
+		event.event_code = static_cast<decltype(event.event_code)>(code);
+		event.device_id = Bench_Device_Id;
+		event.signal_id = signal_id;
+		event.device_time = device_time;
+		event.segment_id = segment_id;
+		event.level = level;
+		return event;
+	}
+}
+
+const std::vector<TBench_Scenario>& Bench_Scenarios() {
+	static const std::vector<TBench_Scenario> scenarios = {
+		{ "replay", "synthetic stream through a signal mapping; the executor overhead", true, &Replay_Configuration },
+		{ "calculated", "diffusion v2 blood glucose calculated from the synthetic stream", true, &Calculated_Signal_Configuration },
+		{ "metric", "signal error between the synthetic BG and IG", true, &Metric_Configuration },
+		{ "generator", "UVA/Padova S2013 simulated by the signal generator", false, &Generator_Configuration },
+	};
+
+	return scenarios;
+}
+
+std::vector<TSCGMS_Event_Data> Synthetic_Events(const TBench_Options &options) {
+	std::vector<TSCGMS_Event_Data> events;
+	events.reserve(options.event_count + 2 * options.segment_count + 1);
+
+	const size_t signal_count = std::max<size_t>(1, std::min(options.signal_count, Signal_Mix.size()));
+	const size_t segment_count = std::max<size_t>(1, options.segment_count);
+	const size_t events_per_segment = (options.event_count + segment_count - 1) / segment_count;
+	const double start_time = Unix_Time_To_Rat_Time(std::time(nullptr));
+
+	size_t emitted = 0;
+	for (size_t segment = 0; segment < segment_count; segment++) {
+		const uint64_t segment_id = segment + 1;
+		events.push_back(Event(scgms::NDevice_Event_Code::Time_Segment_Start, scgms::signal_Null, start_time, segment_id, std::numeric_limits<double>::quiet_NaN()));
+
+		double device_time = start_time;
+		for (size_t i = 0; (i < events_per_segment) && (emitted < options.event_count); i++, emitted++) {
+			const size_t signal = i % signal_count;
+			if (signal == 0) {
+				device_time += 5.0 * scgms::One_Minute;
+			}
+
+			//a daily glucose wave for the glucose signals, small doses for the rest
+			const double phase = 2.0 * 3.14159265358979 * std::fmod(device_time, 1.0);
+			const double level = signal < 2 ? 7.0 + 2.5 * std::sin(phase + 0.3 * static_cast<double>(signal)) : 1.0 + 0.5 * std::cos(phase);
+			events.push_back(Event(scgms::NDevice_Event_Code::Level, Signal_Mix[signal], device_time, segment_id, level));
+		}
+
+		events.push_back(Event(scgms::NDevice_Event_Code::Time_Segment_Stop, scgms::signal_Null, device_time, segment_id, std::numeric_limits<double>::quiet_NaN()));
+	}
+
+	events.push_back(Event(scgms::NDevice_Event_Code::Shut_Down, scgms::signal_Null, start_time, scgms::Invalid_Segment_Id, std::numeric_limits<double>::quiet_NaN()));
+	return events;
+}
@@ -0,0 +1,65 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#pragma once
+
+#include <scgms/iface/SimpleIface.h>
+
+#include <string>
+#include <vector>
+
+struct TBench_Options {
+	size_t event_count = 100'000;	//number of the level events to inject
+	double rate = 0.0;				//injected events per second; zero injects them as fast as possible
+	size_t signal_count = 2;		//number of the distinct signals mixed in the injected stream
+	size_t segment_count = 1;		//the injected events are spread evenly over this number of segments
+	size_t batch_size = 1;			//number of the events injected with a single call
+	size_t days = 7;				//simulated by the generating scenarios
+	size_t repeats = 1;				//each scenario is run this many times and each run is reported
+	std::string config_path;		//chain to feed with the synthetic stream instead of the scenarios' ones
+};
+
+struct TBench_Scenario {
+	const char* name;
+	const char* description;
+	bool injected;					//false, if the chain generates the events itself
+	std::string(*configuration)(const TBench_Options &options);	//the chain as it would be stored in the .ini file
+};
+
+const std::vector<TBench_Scenario>& Bench_Scenarios();
+
+//segment start, levels of the mixed signals with a five minute period, and segment stop for each segment, followed by the shut down
+std::vector<TSCGMS_Event_Data> Synthetic_Events(const TBench_Options &options);
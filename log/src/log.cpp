@@ -52,6 +52,12 @@
 #include <string>
 #include <map>
 
+namespace {
+	//the lowest bits of the logical time hold the domain of the clock, which has stamped the event
+	//we write the counter only, so that the column keeps its meaning of a monotonically increasing event number
+	constexpr int Logical_Clock_Domain_Bits = 16;
+}
+
 CLog_Filter::CLog_Filter(scgms::IFilter *output) : CBase_Filter(output) {
 	mNew_Log_Records = refcnt::Create_Container_shared<refcnt::wstr_container*>(nullptr, nullptr);
 }
@@ -219,7 +225,7 @@ void CLog_Filter::Log_Event(std::wofstream& log, const scgms::UDevice_Event& evt
 	std::wostringstream log_line;
 
 	if (!mReduce_Log) {
-		log_line << evt.logical_time();
+		log_line << (evt.logical_time() >> Logical_Clock_Domain_Bits);
 	}
 	log_line << delim;
 
@@ -43,11 +43,13 @@
 #include "diabetes_grid/diabetes_grid.h"
 
 #include <scgms/lang/dstrings.h>
+#include <scgms/lang/dstrings_ext.h>
 #include <scgms/utils/descriptor_utils.h>
 
-const std::array < scgms::TMetric_Descriptor, 14 > metric_descriptor = { {
+const std::array < scgms::TMetric_Descriptor, 15 > metric_descriptor = { {
 	 scgms::TMetric_Descriptor{ mtrAvg_Abs, dsAvg_Abs },
 	 scgms::TMetric_Descriptor{ mtrMax_Abs, dsMax_Abs },
+	 scgms::TMetric_Descriptor{ mtrSum_Abs, dsSum_Abs },
 	 scgms::TMetric_Descriptor{ mtrPerc_Abs, dsPerc_Abs },
 	 scgms::TMetric_Descriptor{ mtrThresh_Abs, dsThresh_Abs },
 	 scgms::TMetric_Descriptor{ mtrLeal_2010, dsLeal_2010 },
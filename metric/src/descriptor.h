@@ -90,3 +90,6 @@ static constexpr GUID mtrExpWtDiff =	// weigthed average preferring values highe
 
 static const GUID mtrAvg_Pow_StdDev_Metric =    //average to the power of std dev estimation
 { 0xf9b5fcae, 0x9f05, 0x4f75, { 0xb0, 0x17, 0xda, 0x25, 0xe2, 0xec, 0xee, 0x2c } }; // {F9B5FCAE-9F05-4F75-B017-DA25E2ECEE2C}
+
+static constexpr GUID mtrSum_Abs =		//sum of absolute errors - unlike the average, it never decreases with more levels
+{ 0xd3824699, 0xacba, 0x4323,{ 0x99, 0xb6, 0xf6, 0x78, 0xa8, 0xe6, 0x4d, 0xd0 } };	// {D3824699-ACBA-4323-99B6-F678A8E64DD0}
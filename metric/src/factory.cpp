@@ -63,6 +63,7 @@ class CId_Dispatcher {
 		CId_Dispatcher() {
 			Bind_Metric_Factory<CAbsDiffAvgMetric>(mtrAvg_Abs);
 			Bind_Metric_Factory<CAbsDiffMaxMetric>(mtrMax_Abs);
+			Bind_Metric_Factory<CAbsDiffSumMetric>(mtrSum_Abs);
 			Bind_Metric_Factory<CAbsDiffPercentilMetric>(mtrPerc_Abs);
 			Bind_Metric_Factory<CAbsDiffThresholdMetric>(mtrThresh_Abs);
 			Bind_Metric_Factory<CLeal2010Metric>(mtrLeal_2010);
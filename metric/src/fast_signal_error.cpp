@@ -41,6 +41,7 @@
 #include <scgms/utils/math_utils.h>
 #include <scgms/utils/string_utils.h>
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <numeric>
@@ -88,6 +89,15 @@ namespace fast_signal_metrics {
 		return mMetric_ID;
 	}
 
+	void CAvg_SD::Save_Counters(scgms::CCheckpoint_Writer& writer) const {
+		writer.Write(mAccumulator);
+		writer.Write(mVariance);
+	}
+
+	bool CAvg_SD::Restore_Counters(scgms::CCheckpoint_Reader& reader) {
+		return reader.Read(mAccumulator) && reader.Read(mVariance);
+	}
+
 	CAvg::CAvg(double& levels_counter) : mLevels_Counter(levels_counter) {
 		//
 	}
@@ -110,6 +120,74 @@ namespace fast_signal_metrics {
 		return mMetric_ID;
 	}
 
+	void CAvg::Save_Counters(scgms::CCheckpoint_Writer& writer) const {
+		writer.Write(mAccumulator);
+	}
+
+	bool CAvg::Restore_Counters(scgms::CCheckpoint_Reader& reader) {
+		return reader.Read(mAccumulator);
+	}
+
+	CMax::CMax(double& levels_counter) : mLevels_Counter(levels_counter) {
+		//
+	}
+
+	void CMax::Update_Counters(const double difference) {
+		mMaximum = std::max(mMaximum, difference);
+		mLevels_Counter += 1.0;
+	}
+
+	double CMax::Calculate_Metric() {
+		return mMaximum;
+	}
+
+	void CMax::Clear_Counters() {
+		mMaximum = 0.0;
+		mLevels_Counter = 0.0;
+	}
+
+	const GUID& CMax::Metric_ID() const {
+		return mMetric_ID;
+	}
+
+	void CMax::Save_Counters(scgms::CCheckpoint_Writer& writer) const {
+		writer.Write(mMaximum);
+	}
+
+	bool CMax::Restore_Counters(scgms::CCheckpoint_Reader& reader) {
+		return reader.Read(mMaximum);
+	}
+
+	CSum::CSum(double& levels_counter) : mLevels_Counter(levels_counter) {
+		//
+	}
+
+	void CSum::Update_Counters(const double difference) {
+		mAccumulator += difference;
+		mLevels_Counter += 1.0;
+	}
+
+	double CSum::Calculate_Metric() {
+		return mAccumulator;
+	}
+
+	void CSum::Clear_Counters() {
+		mAccumulator = 0.0;
+		mLevels_Counter = 0.0;
+	}
+
+	const GUID& CSum::Metric_ID() const {
+		return mMetric_ID;
+	}
+
+	void CSum::Save_Counters(scgms::CCheckpoint_Writer& writer) const {
+		writer.Write(mAccumulator);
+	}
+
+	bool CSum::Restore_Counters(scgms::CCheckpoint_Reader& reader) {
+		return reader.Read(mAccumulator);
+	}
+
 }
 
 
@@ -119,16 +197,20 @@ CFast_Signal_Error::CFast_Signal_Error(scgms::IFilter *output) : CBase_Filter(ou
 
 CFast_Signal_Error::~CFast_Signal_Error() {
 	if (mPromised_Metric) {
-		if (mLevels_Counter >= static_cast<double>(mLevels_Required)) {
-			double metric = mCalculate_Metric();
-			if (mPrefer_More_Levels) {
-				metric /= mLevels_Counter;
-			}
-			*mPromised_Metric = metric;
-		}
-		else {
-			*mPromised_Metric = std::numeric_limits<double>::quiet_NaN();
+		*mPromised_Metric = Calculate_Metric();
+	}
+}
+
+double CFast_Signal_Error::Calculate_Metric() {
+	if (mLevels_Counter >= static_cast<double>(mLevels_Required)) {
+		double metric = mCalculate_Metric();
+		if (mPrefer_More_Levels) {
+			metric /= mLevels_Counter;
 		}
+		return metric;
+	}
+	else {
+		return std::numeric_limits<double>::quiet_NaN();
 	}
 }
 
@@ -169,7 +251,7 @@ HRESULT CFast_Signal_Error::Do_Configure(scgms::SFilter_Configuration configurat
 
 	const GUID metric_id = configuration.Read_GUID(rsSelected_Metric);
 
-	if (!Bind_Metric(metric_id, mAvg_SD, mAvg)) {
+	if (!Bind_Metric(metric_id, mAvg_SD, mAvg, mMax, mSum)) {
 		error_description.push(dsUnsupported_Metric_Configuration);
 		return E_INVALIDARG;
 	}
@@ -196,18 +278,93 @@ HRESULT IfaceCalling CFast_Signal_Error::QueryInterface(const GUID* riid, void**
 	if (Internal_Query_Interface<scgms::ISignal_Error_Inspection>(scgms::IID_Signal_Error_Inspection, *riid, ppvObj)) {
 		return S_OK;
 	}
+	if (Internal_Query_Interface<scgms::IFilter_Checkpointable>(scgms::IID_Filter_Checkpointable, *riid, ppvObj)) {
+		return S_OK;
+	}
+	if (Internal_Query_Interface<scgms::IFilter_Reusable>(scgms::IID_Filter_Reusable, *riid, ppvObj)) {
+		return S_OK;
+	}
+	if (Internal_Query_Interface<scgms::ISignal_Error_Bound>(scgms::IID_Signal_Error_Bound, *riid, ppvObj)) {
+		return S_OK;
+	}
 
 	return E_NOINTERFACE;
 }
 
+HRESULT IfaceCalling CFast_Signal_Error::Save_Checkpoint(refcnt::str_container* checkpoint) {
+	//the state consists of the received levels only
+	if (!checkpoint) {
+		return S_OK;
+	}
+
+	scgms::CCheckpoint_Writer writer;
+	writer.Write(mLevels_Counter);
+	writer.Write(mSignals);
+	mAvg_SD.Save_Counters(writer);
+	mAvg.Save_Counters(writer);
+	mMax.Save_Counters(writer);
+	mSum.Save_Counters(writer);
+
+	return writer.Store(checkpoint);
+}
+
+HRESULT IfaceCalling CFast_Signal_Error::Get_Metric_Lower_Bound(double* const bound) {
+	if (!mMonotone_Metric || mPrefer_More_Levels) {
+		return E_NOTIMPL;	//more levels could lower the metric
+	}
+
+	if (mLevels_Counter < 1.0) {
+		return S_FALSE;
+	}
+
+	*bound = mCalculate_Metric();	//if there won't be enough levels, the final metric will be NaN, which is even worse
+	return S_OK;
+}
+
+HRESULT IfaceCalling CFast_Signal_Error::Reset(const wchar_t* parameters_name, scgms::IModel_Parameter_Vector* parameters) {
+	if (parameters_name) {
+		return E_INVALIDARG;	//we have no parameters
+	}
+
+	mClear_Counters();
+	Clear_Signal_Info();
+	mNew_Data_Logical_Clock++;
+
+	return S_OK;
+}
+
+HRESULT IfaceCalling CFast_Signal_Error::Restore_Checkpoint(refcnt::str_container* checkpoint) {
+	scgms::CCheckpoint_Reader reader{ checkpoint };
+	reader.Read(mLevels_Counter);
+	reader.Read(mSignals);
+	mAvg_SD.Restore_Counters(reader);
+	mAvg.Restore_Counters(reader);
+	mMax.Restore_Counters(reader);
+	mSum.Restore_Counters(reader);
+
+	if (!reader.Finished()) {
+		mClear_Counters();
+		Clear_Signal_Info();
+		return E_INVALIDARG;
+	}
+
+	mNew_Data_Logical_Clock++;
+	return S_OK;
+}
+
 HRESULT IfaceCalling CFast_Signal_Error::Promise_Metric(const uint64_t segment_id, double* const metric_value, BOOL defer_to_dtor) {
 
-	if ((segment_id == scgms::All_Segments_Id) && (defer_to_dtor == TRUE)) {
-		mPromised_Metric = metric_value;
-		return S_OK;
+	if (segment_id != scgms::All_Segments_Id) {
+		return E_INVALIDARG;
+	}
+
+	if (defer_to_dtor == FALSE) {
+		*metric_value = Calculate_Metric();
+		return std::isnan(*metric_value) ? S_FALSE : S_OK;
 	}
 	else {
-		return E_INVALIDARG;
+		mPromised_Metric = metric_value;
+		return S_OK;
 	}
 }
 
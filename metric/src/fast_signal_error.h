@@ -42,6 +42,7 @@
 #include <scgms/rtl/FilterLib.h>
 #include <scgms/rtl/SolverLib.h>
 #include <scgms/rtl/referencedImpl.h>
+#include <scgms/rtl/FilterExtLib.h>
 
 #include <map>
 #include <mutex>
@@ -64,12 +65,17 @@ namespace fast_signal_metrics {
 			double Avg_Divisor();
 
 		public:
+			static constexpr bool Monotone = false;
+
 			CAvg_SD(double& levels_counter);
 		
 			void Update_Counters(const double difference);
 			double Calculate_Metric();
 			void Clear_Counters();
 			const GUID& Metric_ID() const;
+
+			void Save_Counters(scgms::CCheckpoint_Writer& writer) const;
+			bool Restore_Counters(scgms::CCheckpoint_Reader& reader);
 	};
 
 	class CAvg {
@@ -80,6 +86,8 @@ namespace fast_signal_metrics {
 			const GUID mMetric_ID = mtrAvg_Abs;
 
 		public:
+			static constexpr bool Monotone = false;
+
 			CAvg(double& levels_counter);
 
 			void Update_Counters(const double difference);
@@ -87,6 +95,53 @@ namespace fast_signal_metrics {
 			void Clear_Counters();
 
 			const GUID& Metric_ID() const;
+
+			void Save_Counters(scgms::CCheckpoint_Writer& writer) const;
+			bool Restore_Counters(scgms::CCheckpoint_Reader& reader);
+	};
+
+	class CMax {
+		protected:
+			double mMaximum = 0.0;
+			double& mLevels_Counter;
+
+			const GUID mMetric_ID = mtrMax_Abs;
+
+		public:
+			static constexpr bool Monotone = true;	//i.e.; the metric never decreases with more levels
+
+			CMax(double& levels_counter);
+
+			void Update_Counters(const double difference);
+			double Calculate_Metric();
+			void Clear_Counters();
+
+			const GUID& Metric_ID() const;
+
+			void Save_Counters(scgms::CCheckpoint_Writer& writer) const;
+			bool Restore_Counters(scgms::CCheckpoint_Reader& reader);
+	};
+
+	class CSum {
+		protected:
+			double mAccumulator = 0.0;
+			double& mLevels_Counter;
+
+			const GUID mMetric_ID = mtrSum_Abs;
+
+		public:
+			static constexpr bool Monotone = true;	//the differences are non-negative, so the sum never decreases
+
+			CSum(double& levels_counter);
+
+			void Update_Counters(const double difference);
+			double Calculate_Metric();
+			void Clear_Counters();
+
+			const GUID& Metric_ID() const;
+
+			void Save_Counters(scgms::CCheckpoint_Writer& writer) const;
+			bool Restore_Counters(scgms::CCheckpoint_Reader& reader);
 	};
 
 }
@@ -94,7 +149,7 @@ namespace fast_signal_metrics {
 /*
  * So far, it calcules avg+sd only. In the future, it could be extended.
  */
-class CFast_Signal_Error : public virtual scgms::CBase_Filter, public virtual scgms::ILogical_Clock, public virtual scgms::ISignal_Error_Inspection {
+class CFast_Signal_Error : public virtual scgms::CBase_Filter, public virtual scgms::ILogical_Clock, public virtual scgms::ISignal_Error_Inspection, public virtual scgms::IFilter_Checkpointable, public virtual scgms::IFilter_Reusable, public virtual scgms::ISignal_Error_Bound {
 	protected:
 		struct TSignal_Info {
 			double level;
@@ -115,9 +170,12 @@ class CFast_Signal_Error : public virtual scgms::CBase_Filter, public virtual sc
 		std::function<void(const double)> mUpdate_Counters;
 		std::function<double()> mCalculate_Metric;
 		std::function<void()> mClear_Counters;
+		bool mMonotone_Metric = false;
 
 		fast_signal_metrics::CAvg_SD mAvg_SD{ mLevels_Counter };
 		fast_signal_metrics::CAvg mAvg{ mLevels_Counter };
+		fast_signal_metrics::CMax mMax{ mLevels_Counter };
+		fast_signal_metrics::CSum mSum{ mLevels_Counter };
 
 		std::array<TSignal_Info, static_cast<size_t>(NSignal_Id::count)> mSignals{};
 
@@ -142,6 +200,7 @@ class CFast_Signal_Error : public virtual scgms::CBase_Filter, public virtual sc
 				mCalculate_Metric = std::bind(std::mem_fn(&M::Calculate_Metric), &metric);
 				mUpdate_Counters = std::bind(std::mem_fn(&M::Update_Counters), &metric, std::placeholders::_1);
 				mClear_Counters = std::bind(std::mem_fn(&M::Clear_Counters), &metric);
+				mMonotone_Metric = M::Monotone;
 
 				return true;
 			}
@@ -161,6 +220,7 @@ class CFast_Signal_Error : public virtual scgms::CBase_Filter, public virtual sc
 
 		void Update_Signal_Info(const double level, const double device_time, const bool reference_signal);
 		void Clear_Signal_Info();
+		double Calculate_Metric();	//NaN, if there are not enough levels
 
 		virtual HRESULT Do_Execute(scgms::UDevice_Event event) override;
 		virtual HRESULT Do_Configure(scgms::SFilter_Configuration configuration, refcnt::Swstr_list& error_description) override;
@@ -174,6 +234,13 @@ class CFast_Signal_Error : public virtual scgms::CBase_Filter, public virtual sc
 		virtual HRESULT IfaceCalling Calculate_Signal_Error(const uint64_t segment_id, scgms::TSignal_Stats* absolute_error, scgms::TSignal_Stats* relative_error) override final;
 		virtual HRESULT IfaceCalling Get_Description(wchar_t** const desc) override;
 		virtual HRESULT IfaceCalling Logical_Clock(ULONG* clock) override final;
+
+		virtual HRESULT IfaceCalling Save_Checkpoint(refcnt::str_container* checkpoint) override final;
+		virtual HRESULT IfaceCalling Restore_Checkpoint(refcnt::str_container* checkpoint) override final;
+
+		virtual HRESULT IfaceCalling Reset(const wchar_t* parameters_name, scgms::IModel_Parameter_Vector* parameters) override final;
+
+		virtual HRESULT IfaceCalling Get_Metric_Lower_Bound(double* const bound) override final;
 };
 
 
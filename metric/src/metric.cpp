@@ -95,6 +95,15 @@ double CAbsDiffMaxMetric::Do_Calculate_Metric() {
 	return maximum;
 }
 
+double CAbsDiffSumMetric::Do_Calculate_Metric() {
+	double sum = 0.0;
+	for (const auto &diff : mDifferences) {
+		sum += diff.difference;
+	}
+
+	return sum;
+}
+
 CAbsDiffPercentilMetric::CAbsDiffPercentilMetric(scgms::TMetric_Parameters& params) : CCommon_Metric(params) {
 	mInvThreshold = 0.01 * params.threshold;
 }
@@ -65,6 +65,14 @@ class CAbsDiffMaxMetric : public CCommon_Metric {
 		CAbsDiffMaxMetric(const scgms::TMetric_Parameters& params) : CCommon_Metric(params) {};
 };
 
+class CAbsDiffSumMetric : public CCommon_Metric {
+	protected:
+		virtual double Do_Calculate_Metric() override final;
+
+	public:
+		CAbsDiffSumMetric(const scgms::TMetric_Parameters& params) : CCommon_Metric(params) {};
+};
+
 //Returns the metric at percentil given by mParameters
 class CAbsDiffPercentilMetric : public CCommon_Metric {
 	private:
@@ -65,11 +65,30 @@ HRESULT IfaceCalling CSignal_Error::QueryInterface(const GUID*  riid, void ** pp
 	if (Internal_Query_Interface<scgms::ISignal_Error_Inspection>(scgms::IID_Signal_Error_Inspection, *riid, ppvObj)) {
 		return S_OK;
 	}
+	if (Internal_Query_Interface<scgms::IFilter_Checkpointable>(scgms::IID_Filter_Checkpointable, *riid, ppvObj)) {
+		return S_OK;
+	}
+	if (Internal_Query_Interface<scgms::IFilter_Reusable>(scgms::IID_Filter_Reusable, *riid, ppvObj)) {
+		return S_OK;
+	}
 
 	return E_NOINTERFACE;
 }
 
 
+bool CSignal_Error::Do_Save_Checkpoint(scgms::CCheckpoint_Writer &writer) {
+	writer.Write(mLast_Emmitted_Time);
+	return true;
+}
+
+bool CSignal_Error::Do_Restore_Checkpoint(scgms::CCheckpoint_Reader &reader) {
+	return reader.Read(mLast_Emmitted_Time);
+}
+
+void CSignal_Error::Do_Reset() {
+	mLast_Emmitted_Time = std::numeric_limits<double>::quiet_NaN();
+}
+
 HRESULT CSignal_Error::On_Level_Added(const uint64_t segment_id, const double device_time) {
 	HRESULT rc = S_OK;
 
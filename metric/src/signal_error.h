@@ -66,6 +66,9 @@ class CSignal_Error : public virtual CTwo_Signals, public virtual scgms::ISignal
 		double Calculate_Metric(const uint64_t segment_id);	//returns metric or NaN if could not calculate
 
 		virtual void Do_Flush_Stats(std::wofstream stats_file) override final;
+		virtual bool Do_Save_Checkpoint(scgms::CCheckpoint_Writer &writer) override final;
+		virtual bool Do_Restore_Checkpoint(scgms::CCheckpoint_Reader &reader) override final;
+		virtual void Do_Reset() override final;
 
 		virtual HRESULT Do_Execute(scgms::UDevice_Event event) override final;
 		virtual HRESULT Do_Configure(scgms::SFilter_Configuration configuration, refcnt::Swstr_list& error_description) override final;
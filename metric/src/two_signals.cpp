@@ -396,6 +396,70 @@ HRESULT IfaceCalling CTwo_Signals::Get_Description(wchar_t** const desc) {
 	return S_OK;
 }
 
+HRESULT IfaceCalling CTwo_Signals::Save_Checkpoint(refcnt::str_container* checkpoint) {
+	//we compare what we receive, thus we have no parameters the state could depend on
+	if (!checkpoint) {
+		return S_OK;
+	}
+
+	std::lock_guard<std::mutex> lock{ mSeries_Gaurd };
+
+	scgms::CCheckpoint_Writer writer;
+	writer.Write(mShutdown_Received);
+	writer.Write(static_cast<uint64_t>(mSignal_Series.size()));
+	for (auto& signals : mSignal_Series) {
+		writer.Write(signals.first);
+		writer.Write(signals.second.last_value_emitted);
+		if (!writer.Write(signals.second.reference_signal.get()) || !writer.Write(signals.second.error_signal.get())) {
+			return E_FAIL;
+		}
+	}
+
+	return Do_Save_Checkpoint(writer) ? writer.Store(checkpoint) : E_FAIL;
+}
+
+HRESULT IfaceCalling CTwo_Signals::Restore_Checkpoint(refcnt::str_container* checkpoint) {
+	std::lock_guard<std::mutex> lock{ mSeries_Gaurd };
+	if (!mSignal_Series.empty()) {
+		return E_ILLEGAL_STATE_CHANGE;
+	}
+
+	scgms::CCheckpoint_Reader reader{ checkpoint };
+	uint64_t segment_count = 0;
+	reader.Read(mShutdown_Received);
+	reader.Read(segment_count);
+	for (uint64_t i = 0; i < segment_count; i++) {
+		uint64_t segment_id = scgms::Invalid_Segment_Id;
+		TSegment_Signals signals;
+		if (!reader.Read(segment_id) || !reader.Read(signals.last_value_emitted) || !reader.Read(signals.reference_signal.get()) || !reader.Read(signals.error_signal.get())) {
+			return E_INVALIDARG;
+		}
+
+		mSignal_Series[segment_id] = std::move(signals);
+	}
+
+	if (!Do_Restore_Checkpoint(reader) || !reader.Finished()) {
+		return E_INVALIDARG;
+	}
+
+	mNew_Data_Logical_Clock++;
+	return S_OK;
+}
+
+HRESULT IfaceCalling CTwo_Signals::Reset(const wchar_t* parameters_name, scgms::IModel_Parameter_Vector* parameters) {
+	if (parameters_name) {
+		return E_INVALIDARG;	//we have no parameters
+	}
+
+	std::lock_guard<std::mutex> lock{ mSeries_Gaurd };
+	mSignal_Series.clear();
+	mShutdown_Received = false;
+	Do_Reset();
+	mNew_Data_Logical_Clock++;
+
+	return S_OK;
+}
+
 void CTwo_Signals::Flush_Stats() {
 	if (mCSV_Path.empty()) {
 		return;
@@ -40,6 +40,7 @@
 #include <scgms/rtl/FilterLib.h>
 #include <scgms/rtl/SolverLib.h>
 #include <scgms/rtl/referencedImpl.h>
+#include <scgms/rtl/FilterExtLib.h>
 
 #include <map>
 #include <mutex>
@@ -51,7 +52,7 @@
 /*
  * base class for comparig two signals
  */
-class CTwo_Signals : public virtual scgms::CBase_Filter, public virtual scgms::ILogical_Clock {
+class CTwo_Signals : public virtual scgms::CBase_Filter, public virtual scgms::ILogical_Clock, public virtual scgms::IFilter_Checkpointable, public virtual scgms::IFilter_Reusable {
 	protected:
 		GUID mReference_Signal_ID = Invalid_GUID;
 		GUID mError_Signal_ID = Invalid_GUID;
@@ -82,6 +83,17 @@ class CTwo_Signals : public virtual scgms::CBase_Filter, public virtual scgms::I
 
 		void Flush_Stats();
 
+		//the descendants store their own state, if any
+		virtual bool Do_Save_Checkpoint(scgms::CCheckpoint_Writer &writer) {
+			return true;
+		}
+		virtual bool Do_Restore_Checkpoint(scgms::CCheckpoint_Reader &reader) {
+			return true;
+		}
+		virtual void Do_Reset() {
+			//
+		}
+
 		virtual void Do_Flush_Stats(std::wofstream stats_file) = 0;
 
 		virtual HRESULT Do_Execute(scgms::UDevice_Event event) override;
@@ -93,6 +105,11 @@ class CTwo_Signals : public virtual scgms::CBase_Filter, public virtual scgms::I
 	
 		virtual HRESULT IfaceCalling Logical_Clock(ULONG *clock) override final;
 		virtual HRESULT IfaceCalling Get_Description(wchar_t** const desc);
+
+		//the descendants, which can be checkpointed or reused, have to answer the interfaces in their QueryInterface
+		virtual HRESULT IfaceCalling Save_Checkpoint(refcnt::str_container* checkpoint) override;
+		virtual HRESULT IfaceCalling Restore_Checkpoint(refcnt::str_container* checkpoint) override;
+		virtual HRESULT IfaceCalling Reset(const wchar_t* parameters_name, scgms::IModel_Parameter_Vector* parameters) override;
 };
 
 
@@ -0,0 +1,89 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#pragma once
+
+#include <scgms/iface/ApproxIface.h>
+
+#include <cstddef>
+#include <cstdint>
+
+//interfaces extending the signal interfaces of the SmartCGMS common headers
+//like the filter extensions, they are optional and the consumers keep a fallback for the signals not implementing them
+
+namespace scgms {
+
+	//a run of consecutive discrete levels, stored in place by the signal
+	struct TLevels_Span {
+		const double* times;
+		const double* levels;
+		size_t count;
+	};
+
+	constexpr GUID IID_Signal_Discrete_Spans = { 0x7d3e51a8, 0x96c2, 0x4f0b, { 0xa1, 0x3d, 0x28, 0xe4, 0x5b, 0x90, 0x6c, 0x17 } }; // {7D3E51A8-96C2-4F0B-A13D-28E45B906C17}
+
+	//allows to read the discrete levels without copying them, e.g.; by the approximators and metrics
+	class ISignal_Discrete_Spans : public virtual refcnt::IReferenced {
+		public:
+			//S_OK and the spans, which together hold all the discrete levels in the time order; S_FALSE if there are no levels
+			//the spans remain valid until the next Update_Levels of the signal
+			virtual HRESULT IfaceCalling Get_Discrete_Spans(const TLevels_Span** begin, const TLevels_Span** end) const = 0;
+			//the revision changes with any change of the levels, but appending a level after the latest one
+			//i.e.; with the same revision, the levels read before are still the leading ones
+			virtual HRESULT IfaceCalling Get_Discrete_Revision(uint64_t* revision) const = 0;
+	};
+
+	constexpr GUID IID_Signal_Retention = { 0x4b8f2c6e, 0x0d57, 0x4e39, { 0x9a, 0x64, 0xc1, 0x3e, 0x85, 0x7b, 0x2f, 0xd0 } }; // {4B8F2C6E-0D57-4E39-9A64-C13E857B2FD0}
+
+	//allows a long running chain to bound the memory of a signal, which would keep all its discrete levels otherwise
+	class ISignal_Retention : public virtual refcnt::IReferenced {
+		public:
+			//the signal may forget the discrete levels older than the retention behind its latest level; infinity keeps them all
+			virtual HRESULT IfaceCalling Set_Retention(const double retention) = 0;
+	};
+
+	constexpr GUID IID_Approximation_Locality = { 0x91c7e2d4, 0x5a3b, 0x4f86, { 0xb0, 0x2e, 0x6d, 0x48, 0x1f, 0xa9, 0xc3, 0x75 } }; // {91C7E2D4-5A3B-4F86-B02E-6D481FA9C375}
+
+	//answered by the approximators, whose approximation changes just around a changed discrete level, and by the signals using them
+	//allows to approximate again just the levels, which an appended level can change
+	class IApproximation_Locality : public virtual refcnt::IReferenced {
+		public:
+			//the approximation may change from this many discrete levels before the first changed one onwards
+			virtual HRESULT IfaceCalling Get_Preceding_Affected_Levels(size_t* count) const = 0;
+	};
+
+}
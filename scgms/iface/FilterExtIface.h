@@ -0,0 +1,117 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#pragma once
+
+#include <scgms/iface/FilterIface.h>
+
+#include <cstdint>
+
+//interfaces extending the filter interfaces of the SmartCGMS common headers
+//they are optional, i.e.; the core queries them, but always keeps a fallback for the filters not implementing them
+
+namespace scgms {
+
+	constexpr GUID IID_Filter_Batch = { 0x906b4703, 0x1ab9, 0x411d, { 0x8a, 0x4e, 0x56, 0x3d, 0x79, 0x12, 0x1e, 0x8 } }; // {906B4703-1AB9-411D-8A4E-563D79121E08}
+
+	class IFilter_Batch : public virtual refcnt::IReferenced {
+		public:
+			//executes the events in the given order, as if IFilter::Execute would be called for each of them
+			//the filter takes the ownership of all the events, regardless the result
+			virtual HRESULT IfaceCalling Execute_Batch(scgms::IDevice_Event** begin, scgms::IDevice_Event** end) = 0;
+	};
+
+
+	constexpr GUID IID_Filter_Checkpointable = { 0xbd179b57, 0xc5f2, 0x4b5b, { 0x94, 0x28, 0x33, 0xb1, 0xfd, 0x91, 0x86, 0xe1 } }; // {BD179B57-C5F2-4B5B-9428-33B1FD9186E1}
+
+	//allows to continue with the state of another instance of the same filter, which was configured the same way, but the parameters being optimized
+	class IFilter_Checkpointable : public virtual refcnt::IReferenced {
+		public:
+			//S_OK and the serialized state in the checkpoint, if the state does not depend on the filter's parameters yet;
+			//S_FALSE, if it does already, i.e.; the state could not be restored into a filter with other parameters
+			//the checkpoint may be nullptr to just test, whether the state can be saved
+			virtual HRESULT IfaceCalling Save_Checkpoint(refcnt::str_container* checkpoint) = 0;
+			//the filter has to be configured, but it must not have received any event yet
+			virtual HRESULT IfaceCalling Restore_Checkpoint(refcnt::str_container* checkpoint) = 0;
+	};
+
+	constexpr GUID IID_Filter_Reusable = { 0x5e0a3c14, 0x7b2d, 0x4f63, { 0x8c, 0x41, 0x9d, 0x27, 0xe6, 0x50, 0xb3, 0x8a } }; // {5E0A3C14-7B2D-4F63-8C41-9D27E650B38A}
+
+	//allows to run the filter again, without creating and configuring it again, e.g.; to evaluate another candidate solution
+	//note that Warm_Reset event does not suffice as filters may deliberately keep some state across it
+	class IFilter_Reusable : public virtual refcnt::IReferenced {
+		public:
+			//returns the filter to the state, which it had right after its configuration; the filter must not be shut down yet
+			//if the parameters_name is not nullptr, the filter uses the parameters as if it read them from its configuration under this name
+			//the parameters are then in the configuration's format, i.e.; lower bound, values and upper bound
+			//E_INVALIDARG, if the filter does not read any parameters of such a name
+			virtual HRESULT IfaceCalling Reset(const wchar_t* parameters_name, scgms::IModel_Parameter_Vector* parameters) = 0;
+	};
+
+	constexpr GUID IID_Signal_Error_Bound = { 0x2f6b9d41, 0x3c8e, 0x4a1d, { 0xb5, 0x72, 0x61, 0x0e, 0xc4, 0x9f, 0x27, 0xd3 } }; // {2F6B9D41-3C8E-4A1D-B572-610EC49F27D3}
+
+	//complements ISignal_Error_Inspection of the metrics, which cannot decrease with more levels, e.g.; the maximum
+	class ISignal_Error_Bound : public virtual refcnt::IReferenced {
+		public:
+			//S_OK and the bound, which the final metric of all the segments cannot be lower than, regardless the levels still to come
+			//S_FALSE if there is no bound yet, and E_NOTIMPL if the configured metric is not monotone
+			virtual HRESULT IfaceCalling Get_Metric_Lower_Bound(double* const bound) = 0;
+	};
+
+	constexpr GUID IID_Filter_Chain_Profile_Inspection = { 0xca0c61cb, 0xf37c, 0x4d56, { 0xaa, 0x71, 0xe3, 0x94, 0x96, 0x13, 0xb8, 0x66 } }; // {CA0C61CB-F37C-4D56-AA71-E3949613B866}
+
+	//i-th bucket counts the calls, which took [2^i, 2^(i+1)) nanoseconds; the first one includes zero and the last one includes anything longer
+	constexpr size_t Profile_Histogram_Bucket_Count = 40;
+
+	struct TFilter_Profile {
+		GUID filter_id;
+		uint64_t event_counts[static_cast<size_t>(scgms::NDevice_Event_Code::count)];	//events received, indexed by the event code
+		uint64_t call_count;						//batches count as a single call
+		uint64_t inclusive_time;					//[ns] including the downstream filters, which the filter called synchronously
+		uint64_t exclusive_time;					//[ns] the filter alone
+		uint64_t inclusive_histogram[Profile_Histogram_Bucket_Count];
+		uint64_t exclusive_histogram[Profile_Histogram_Bucket_Count];
+	};
+
+	//answered by the filter executor, if the chain executes with the profiling enabled
+	class IFilter_Chain_Profile_Inspection : public virtual refcnt::IReferenced {
+		public:
+			virtual HRESULT IfaceCalling Get_Filter_Count(size_t* count) = 0;
+			//position of the first filter is zero; the values are a snapshot, which may be taken while the chain still runs
+			virtual HRESULT IfaceCalling Get_Filter_Profile(const size_t position, TFilter_Profile* profile) = 0;
+	};
+
+}
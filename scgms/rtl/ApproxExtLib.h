@@ -0,0 +1,108 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#pragma once
+
+#include <scgms/iface/ApproxExtIface.h>
+#include <scgms/rtl/ApproxLib.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace scgms {
+
+	//calls consume(times, levels, count) for consecutive runs of the signal's discrete levels, in the time order
+	//the levels are read in place, if the signal exposes its spans, or copied once otherwise
+	//returns S_FALSE, if the signal has no levels
+	template <typename TConsume>
+	HRESULT For_Each_Discrete_Span(scgms::ISignal* signal, TConsume consume) {
+		refcnt::SReferenced<scgms::ISignal_Discrete_Spans> spans_signal;
+		refcnt::Query_Interface<scgms::ISignal, scgms::ISignal_Discrete_Spans>(signal, scgms::IID_Signal_Discrete_Spans, spans_signal);
+		if (spans_signal) {
+			const scgms::TLevels_Span *begin = nullptr, *end = nullptr;
+			const HRESULT rc = spans_signal->Get_Discrete_Spans(&begin, &end);
+			if (rc == S_OK) {
+				for (auto iter = begin; iter != end; iter++) {
+					consume(iter->times, iter->levels, iter->count);
+				}
+			}
+
+			return rc;
+		}
+
+		size_t count = 0;
+		HRESULT rc = signal->Get_Discrete_Bounds(nullptr, nullptr, &count);
+		if (rc != S_OK) {
+			return rc;
+		}
+
+		std::vector<double> times(count), levels(count);
+		size_t filled = 0;
+		rc = signal->Get_Discrete_Levels(times.data(), levels.data(), count, &filled);
+		if (rc == S_OK) {
+			if (filled == 0) {
+				return S_FALSE;
+			}
+
+			consume(times.data(), levels.data(), filled);
+		}
+
+		return rc;
+	}
+
+	//false, if the signal does not tell its revision, i.e.; any of its levels may have changed since the last time
+	inline bool Get_Discrete_Revision(scgms::ISignal* signal, uint64_t &revision) {
+		refcnt::SReferenced<scgms::ISignal_Discrete_Spans> spans_signal;
+		refcnt::Query_Interface<scgms::ISignal, scgms::ISignal_Discrete_Spans>(signal, scgms::IID_Signal_Discrete_Spans, spans_signal);
+		return spans_signal && (spans_signal->Get_Discrete_Revision(&revision) == S_OK);
+	}
+
+	//false, if a changed level may change the signal's whole approximation
+	inline bool Get_Preceding_Affected_Levels(scgms::ISignal* signal, size_t &count) {
+		refcnt::SReferenced<scgms::IApproximation_Locality> locality;
+		refcnt::Query_Interface<scgms::ISignal, scgms::IApproximation_Locality>(signal, scgms::IID_Approximation_Locality, locality);
+		return locality && (locality->Get_Preceding_Affected_Levels(&count) == S_OK);
+	}
+
+	//E_NOINTERFACE, if the signal keeps all its levels regardless the retention
+	inline HRESULT Set_Signal_Retention(scgms::ISignal* signal, const double retention) {
+		refcnt::SReferenced<scgms::ISignal_Retention> retention_signal;
+		refcnt::Query_Interface<scgms::ISignal, scgms::ISignal_Retention>(signal, scgms::IID_Signal_Retention, retention_signal);
+		return retention_signal ? retention_signal->Set_Retention(retention) : E_NOINTERFACE;
+	}
+
+}
@@ -0,0 +1,208 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#pragma once
+
+#include <scgms/iface/FilterExtIface.h>
+#include <scgms/rtl/FilterLib.h>
+#include <scgms/rtl/ApproxExtLib.h>
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace scgms {
+
+	//sends the events to the output at once, if it supports the batches, or one by one otherwise
+	//the output takes the ownership of all the events, regardless the result
+	inline HRESULT Send_Batch(scgms::IFilter* output, scgms::IDevice_Event** begin, scgms::IDevice_Event** end) {
+		if (begin == end) {
+			return S_OK;
+		}
+
+		refcnt::SReferenced<scgms::IFilter_Batch> batch_output;
+		refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Batch>(output, scgms::IID_Filter_Batch, batch_output);
+		if (batch_output) {
+			return batch_output->Execute_Batch(begin, end);
+		}
+
+		for (auto iter = begin; iter != end; iter++) {
+			const HRESULT rc = output->Execute(*iter);
+			if (!Succeeded(rc)) {
+				//we still own the rest of the events
+				for (iter++; iter != end; iter++) {
+					(*iter)->Release();
+				}
+
+				return rc;
+			}
+		}
+
+		return S_OK;
+	}
+
+	//applies the in-place transformation to each event of the batch, and sends those kept by the transformation as another batch
+	//transform is a callable taking scgms::UDevice_Event& and returning false, if the event has to be dropped
+	template <typename TTransform>
+	HRESULT Transform_And_Send_Batch(scgms::IFilter* output, scgms::IDevice_Event** begin, scgms::IDevice_Event** end, TTransform transform) {
+		scgms::IDevice_Event** kept_end = begin;
+		for (auto iter = begin; iter != end; iter++) {
+			scgms::UDevice_Event event{ *iter };
+			if (transform(event)) {
+				*kept_end = event.release();
+				kept_end++;
+			}
+			//else the event is released by its destructor
+		}
+
+		return Send_Batch(output, begin, kept_end);
+	}
+
+
+	//serializes the filter's state for IFilter_Checkpointable::Save_Checkpoint
+	class CCheckpoint_Writer {
+		protected:
+			std::vector<char> mData;
+
+		public:
+			template <typename T>
+			void Write(const T &value) {
+				static_assert(std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>, "only trivially copyable values can be written as they are");
+				const char* bytes = reinterpret_cast<const char*>(&value);
+				mData.insert(mData.end(), bytes, bytes + sizeof(T));
+			}
+
+			template <typename T>
+			void Write(const std::vector<T> &values) {
+				static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be written as they are");
+				Write(static_cast<uint64_t>(values.size()));
+				const char* bytes = reinterpret_cast<const char*>(values.data());
+				mData.insert(mData.end(), bytes, bytes + values.size() * sizeof(T));
+			}
+
+			//writes the discrete levels of the signal, in the same format as two vectors of times and levels
+			bool Write(scgms::ISignal *signal) {
+				size_t count = 0;
+				if (!signal || !Succeeded(signal->Get_Discrete_Bounds(nullptr, nullptr, &count))) {
+					return false;
+				}
+
+				//reserve both counts and fill the times and the levels span by span
+				const size_t times_offset = mData.size();
+				Write(static_cast<uint64_t>(0));
+				std::vector<char> levels_data;
+				uint64_t written = 0;
+				const HRESULT rc = scgms::For_Each_Discrete_Span(signal, [this, &levels_data, &written](const double* times, const double* levels, const size_t span_count) {
+					const char* time_bytes = reinterpret_cast<const char*>(times);
+					const char* level_bytes = reinterpret_cast<const char*>(levels);
+					mData.insert(mData.end(), time_bytes, time_bytes + span_count * sizeof(double));
+					levels_data.insert(levels_data.end(), level_bytes, level_bytes + span_count * sizeof(double));
+					written += span_count;
+				});
+				if (!Succeeded(rc)) {
+					return false;
+				}
+
+				std::memcpy(mData.data() + times_offset, &written, sizeof(written));
+				Write(written);
+				mData.insert(mData.end(), levels_data.begin(), levels_data.end());
+				return true;
+			}
+
+			HRESULT Store(refcnt::str_container* checkpoint) {
+				return checkpoint->set(mData.data(), mData.data() + mData.size());
+			}
+	};
+
+	//deserializes what CCheckpoint_Writer wrote; once a read fails, all the following ones fail too
+	class CCheckpoint_Reader {
+		protected:
+			char* mCurrent = nullptr;
+			char* mEnd = nullptr;
+			bool mValid = false;
+
+		public:
+			CCheckpoint_Reader(refcnt::str_container* checkpoint) {
+				const HRESULT rc = checkpoint ? checkpoint->get(&mCurrent, &mEnd) : E_INVALIDARG;
+				mValid = (rc == S_OK) || (rc == S_FALSE);	//S_FALSE stands for an empty state
+				if (rc != S_OK) {
+					mCurrent = mEnd = nullptr;
+				}
+			}
+
+			template <typename T>
+			bool Read(T &value) {
+				static_assert(std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>, "only trivially copyable values can be read as they are");
+				mValid &= static_cast<size_t>(mEnd - mCurrent) >= sizeof(T);
+				if (mValid) {
+					std::memcpy(&value, mCurrent, sizeof(T));
+					mCurrent += sizeof(T);
+				}
+				return mValid;
+			}
+
+			template <typename T>
+			bool Read(std::vector<T> &values) {
+				static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable values can be read as they are");
+				uint64_t count = 0;
+				if (Read(count)) {
+					mValid &= count <= static_cast<uint64_t>(mEnd - mCurrent) / sizeof(T);
+					if (mValid) {
+						values.resize(static_cast<size_t>(count));
+						std::memcpy(values.data(), mCurrent, values.size() * sizeof(T));
+						mCurrent += values.size() * sizeof(T);
+					}
+				}
+				return mValid;
+			}
+
+			//appends the discrete levels to the signal
+			bool Read(scgms::ISignal *signal) {
+				std::vector<double> times, levels;
+				mValid &= signal != nullptr;
+				if (Read(times) && Read(levels)) {
+					mValid &= (times.size() == levels.size()) && (times.empty() || (signal->Update_Levels(times.data(), levels.data(), times.size()) == S_OK));
+				}
+				return mValid;
+			}
+
+			//true, if everything has been read successfully
+			bool Finished() const {
+				return mValid && (mCurrent == mEnd);
+			}
+	};
+
+}
@@ -42,14 +42,96 @@
 #include <scgms/utils/string_utils.h>
 #include <scgms/rtl/UILib.h>
 #include <scgms/rtl/hresult.h>
+#include <scgms/rtl/referencedImpl.h>
+#include <scgms/iface/FilterExtIface.h>
 
+#include <algorithm>
 #include <map>
+#include <set>
+#include <cstdlib>
 #include <stdexcept>
 
-CComposite_Filter::CComposite_Filter(std::recursive_mutex &communication_guard) noexcept : mCommunication_Guard(communication_guard) {
+namespace {
+	const char* rsPipeline_Stage_Size_Variable = "SCGMS_PIPELINE_STAGE_SIZE";
+	const char* rsPipeline_Queue_Capacity_Variable = "SCGMS_PIPELINE_QUEUE_CAPACITY";
+
+	const char* rsProfile_Variable = "SCGMS_PROFILE";
+	const char* rsProfile_Output_Variable = "SCGMS_PROFILE_OUTPUT";
+	const char* rsShard_Count_Variable = "SCGMS_SHARD_COUNT";
+
+	const wchar_t* rsFeedback_crosses_shards = L"The chain cannot be sharded, because the first filter is a part of a feedback loop.";
+	const wchar_t* rsSide_Effects_In_Shards = L"The chain cannot be sharded, because the replicas of a filter would write the same output; filter zero-indexed position: ";
+
+	bool Read_String_Variable(const char* name, std::string &value) {
+		size_t assumed_len = 0;
+		auto var_os_err = getenv_s(&assumed_len, nullptr, 0, name);
+		if ((var_os_err == 0) && (assumed_len > 0)) {
+			std::vector<char> var_buf(assumed_len);
+			var_os_err = getenv_s(&assumed_len, var_buf.data(), assumed_len, name);
+			if (var_os_err == 0) {
+				var_buf.push_back(0);	//make sure its ASCIIZ
+				value = var_buf.data();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//presentation filters and filters writing their own files cannot have more replicas, as they would write the same files concurrently
+	bool Has_External_Side_Effects(scgms::IFilter_Configuration_Link *configuration_link) {
+		scgms::SFilter_Configuration_Link link = refcnt::make_shared_reference_ext<scgms::SFilter_Configuration_Link, scgms::IFilter_Configuration_Link>(configuration_link, true);
+		if ((link.descriptor().flags & scgms::NFilter_Flags::Presentation_Only) != scgms::NFilter_Flags::None) {
+			return true;
+		}
+
+		for (const wchar_t* output_parameter : { rsOutput_CSV_File, rsLog_Output_File }) {
+			auto parameter = link.Resolve_Parameter(output_parameter);
+			if (parameter) {
+				HRESULT rc = E_UNEXPECTED;
+				const std::wstring output = parameter.as_wstring(rc, true);
+				if (Succeeded(rc) && !output.empty()) {
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	size_t Read_Size_Variable(const char* name, const size_t default_value) {
+		std::string str;
+		if (Read_String_Variable(name, str)) {
+			char* end_ptr = nullptr;
+			const unsigned long long value = std::strtoull(str.c_str(), &end_ptr, 10);
+			if ((end_ptr != str.c_str()) && (*end_ptr == 0)) {
+				return static_cast<size_t>(value);
+			}
+		}
+
+		return default_value;
+	}
+}
+
+TChain_Execution_Options Chain_Execution_Options_From_Environment() {
+	TChain_Execution_Options options;
+	options.pipeline_stage_size = Read_Size_Variable(rsPipeline_Stage_Size_Variable, options.pipeline_stage_size);
+	options.pipeline_queue_capacity = Read_Size_Variable(rsPipeline_Queue_Capacity_Variable, options.pipeline_queue_capacity);
+	options.shard_count = Read_Size_Variable(rsShard_Count_Variable, options.shard_count);
+	Read_String_Variable(rsProfile_Output_Variable, options.profile_output);
+	options.profile = (Read_Size_Variable(rsProfile_Variable, 0) != 0) || !options.profile_output.empty();
+	return options;
+}
+
+CComposite_Filter::CComposite_Filter(std::recursive_mutex &communication_guard, const TChain_Execution_Options &options) noexcept : mCommunication_Guard(communication_guard), mOptions(options) {
 	//
 }
 
+CComposite_Filter::~CComposite_Filter() {
+	//the workers must not outlive the filters they execute
+	Stop_Pipeline();
+}
+
 HRESULT CComposite_Filter::Build_Filter_Chain(scgms::IFilter_Chain_Configuration *configuration, scgms::IFilter *next_filter, scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data, refcnt::Swstr_list& error_description) noexcept {
 	mRefuse_Execute = true;
 	if (!mExecutors.empty()) {
@@ -61,7 +143,12 @@ HRESULT CComposite_Filter::Build_Filter_Chain(scgms::IFilter_Chain_Configuration
 	}
 
 	std::lock_guard<std::recursive_mutex> guard{ mCommunication_Guard };
+	std::vector<std::unique_lock<std::recursive_mutex>> stage_guards_locks;	//pipeline stages get their own guards, which we have to hold as well
 	scgms::IFilter *last_filter = next_filter;
+	if (mOptions.profile) {
+		mProfiler = std::make_unique<CChain_Profiler>(mOptions.profile_output, next_filter);
+		last_filter = mProfiler.get();
+	}
 		
 	scgms::IFilter_Configuration_Link **link_begin, **link_end;
 	HRESULT rc = configuration->get(&link_begin, &link_end);
@@ -83,123 +170,268 @@ HRESULT CComposite_Filter::Build_Filter_Chain(scgms::IFilter_Chain_Configuration
 			}
 		};
 
-		size_t link_position = std::distance(link_begin, link_end);
+		scgms::IFilter_Configuration_Link **links_begin = link_begin, **links_end = link_end;
+		const size_t filter_count = std::distance(link_begin, link_end);
+		//in the sharded mode, the first filter feeds the shards, each with its own replica of the remaining filters
+		const bool sharded = (mOptions.shard_count > 1) && (filter_count > 1);
+		const bool pipelined = !sharded && (mOptions.pipeline_stage_size > 0) && (filter_count > mOptions.pipeline_stage_size);
+		size_t link_position = filter_count;
+
+		if (sharded) {
+			for (size_t position = 1; position < filter_count; position++) {
+				if (Has_External_Side_Effects(link_begin[position])) {
+					error_description.push(rsSide_Effects_In_Shards + std::to_wstring(position));
+					return E_FAIL;
+				}
+			}
+
+			mShard_Merge = std::make_unique<CShard_Merge>(last_filter);
+			last_filter = mShard_Merge.get();
+			mStage_Guards.push_back(std::make_unique<std::recursive_mutex>());
+			stage_guards_locks.emplace_back(*mStage_Guards.back());	//nobody can enter the shard until the chain is completely built
+		}
 
 		//1st round - create the filters
 		do {
 			link_position--;
 
-			//scgms::IFilter_Configuration_Link* &link = *(link_end-1);	-- let's increase its ref count safely, because we are working with it
-			scgms::SFilter_Configuration_Link link = refcnt::make_shared_reference_ext< scgms::SFilter_Configuration_Link, scgms::IFilter_Configuration_Link>(*(link_end - 1), true);
-
-			GUID filter_id;
-			rc = link->Get_Filter_Id(&filter_id);
-			if (rc != S_OK) {
-				error_description.push(dsCannot_read_filter_id);
-				send_shut_down();
-				mExecutors.clear();
-				return rc;
+			//in the pipelined mode, the filter closing a stage sends its events to the next stage's queue
+			if (pipelined && (link_position + 1 < filter_count) && ((link_position + 1) % mOptions.pipeline_stage_size == 0)) {
+				std::unique_ptr<CPipeline_Stage> stage = std::make_unique<CPipeline_Stage>(last_filter, mOptions.pipeline_queue_capacity);
+				last_filter = stage.get();
+				mPipeline_Stages[link_position + 1] = std::move(stage);
 			}
 
-			std::unique_ptr<CFilter_Executor> new_executor = std::make_unique<CFilter_Executor>(filter_id, mCommunication_Guard, last_filter, on_filter_created, on_filter_created_data);
-			//try to configure the filter 
-			if (!new_executor) {
-				send_shut_down();
-				mExecutors.clear();
-				return E_OUTOFMEMORY;
+			//the first filter sends to the router, which queues the events for the shards' workers
+			if (sharded && (link_position == 0)) {
+				mShard_Entries.push_back(std::make_unique<CShard_Entry>(last_filter, *mShard_Merge));
+				mShard_Stages.push_back(std::make_unique<CPipeline_Stage>(mShard_Entries.back().get(), mOptions.pipeline_queue_capacity));
+				mShard_Merge->Add_Shard();
+				mShard_Router = std::make_unique<CShard_Router>(mCommunication_Guard, *mShard_Merge);
+				mShard_Router->Add_Shard(mShard_Stages.back().get());
+				last_filter = mShard_Router.get();
 			}
 
-
-			rc = new_executor->Configure(link.get(), error_description.get());
+			std::recursive_mutex &communication_guard = (sharded && (link_position > 0)) ? *mStage_Guards[0] : mCommunication_Guard;
+			std::unique_ptr<CFilter_Executor> new_executor;
+			rc = Create_Executor(*(link_end - 1), link_position, communication_guard, last_filter, on_filter_created, on_filter_created_data, error_description, new_executor);
 			if (!Succeeded(rc)) {
-				//if failed, we need to delete this, newly constructed filter first,
-				//i.e., before clearing mExecutors because it is tied to resources,
-				//which must be released AFTER destroying this filter
-				new_executor.reset(nullptr);
-
-				//describe such an event anyway just in the case the filter would not do so - hence we would at least know the configuration-failing filter
-				std::wstring err_str{dsFailed_to_configure_filter};
-				err_str += GUID_To_WString(filter_id);
-				err_str += L"; filter zero-indexed position: ";
-				err_str += std::to_wstring(link_position);
-				
-				bool failed_to_resolve_descriptor = false;
-				//try to obtain filter's name
-				{
-					scgms::TFilter_Descriptor desc = scgms::Null_Filter_Descriptor;
-					if (scgms::get_filter_descriptor_by_id(filter_id, desc) ) {
-						err_str += L" \"";
-						err_str += desc.description;
-						err_str += L'"';
-					}
-					else {
-						failed_to_resolve_descriptor = true;
-					}
-				}
-				error_description.push(err_str.c_str());
-
-				if (failed_to_resolve_descriptor) {
-					describe_loaded_filters(error_description);
-				}
-
-				err_str = dsLast_RC + std::wstring{ Describe_Error(rc) };
-				error_description.push(err_str.c_str());
-
 				send_shut_down();
-				
-				mExecutors.clear();
-
+				stage_guards_locks.clear();	//the guards are released with the executors
+				Clear_Executors();
 				return rc;
 			}
 
 			//filter is configured, insert it into the chain
+			if (mProfiler) {
+				new_executor->Set_Profile(mProfiler->Prepend_Filter(new_executor->Filter_Id()));
+			}
 			last_filter = new_executor.get();
 			mExecutors.insert(mExecutors.begin(), std::move(new_executor));
 			
 			link_end--;
 		} while (link_end != link_begin);
 
-		//2nd round - gather information about the feedback receivers
-		std::map<std::wstring, scgms::SFilter_Feedback_Receiver> feedback_map;
-		for (auto &possible_receiver : mExecutors) {
-			scgms::SFilter_Feedback_Receiver feedback_receiver;
-			refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Feedback_Receiver>(possible_receiver.get(), scgms::IID_Filter_Feedback_Receiver, feedback_receiver);
-			if (feedback_receiver) {
-				wchar_t *name;
-				if (feedback_receiver->Name(&name) == S_OK) {
-					feedback_map[name] = feedback_receiver;
+		//2nd and 3rd round - connect the feedback senders to the receivers
+		std::vector<std::pair<size_t, size_t>> feedback_spans;	//receiver and sender positions
+		rc = Connect_Feedbacks(mExecutors, feedback_spans, error_description);
+		if (!Succeeded(rc)) {
+			send_shut_down();
+			stage_guards_locks.clear();	//the guards are released with the executors
+			Clear_Executors();
+			return rc;	//this is very likely severe error in the configuration, hence we stop it
+		}
+
+		//4th round - a filter in a feedback loop must process each event entirely, before it gets another one,
+		//as a fed-back event would overtake the rest of the batch otherwise
+		Unroll_Feedback_Batches(mExecutors, feedback_spans);
+
+		//5th round - eventually, let the pipeline stages run
+		if (!mPipeline_Stages.empty()) {
+			Start_Pipeline(feedback_spans, stage_guards_locks);
+		}
+
+		//or, build the remaining shards and let them run
+		if (sharded) {
+			for (const auto &[receiver_position, sender_position] : feedback_spans) {
+				if (std::min(receiver_position, sender_position) == 0) {
+					error_description.push(rsFeedback_crosses_shards);
+					send_shut_down();
+					stage_guards_locks.clear();	//the guards are released with the executors
+					Clear_Executors();
+					return E_FAIL;
 				}
 			}
+
+			rc = Build_Shards(links_begin, links_end, on_filter_created, on_filter_created_data, stage_guards_locks, error_description);
+			if (!Succeeded(rc)) {
+				send_shut_down();
+				stage_guards_locks.clear();	//the guards are released with the executors
+				Clear_Executors();
+				return rc;
+			}
+
+			for (auto &stage : mShard_Stages) {
+				stage->Start();
+			}
 		}
+	}
+
+	mRefuse_Execute = false;
+	return S_OK;
+}
+
+HRESULT CComposite_Filter::Create_Executor(scgms::IFilter_Configuration_Link *configuration_link, const size_t link_position, std::recursive_mutex &communication_guard, scgms::IFilter *next_filter,
+											 scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data, refcnt::Swstr_list &error_description, std::unique_ptr<CFilter_Executor> &executor) {
+
+	//let's increase its ref count safely, because we are working with it
+	scgms::SFilter_Configuration_Link link = refcnt::make_shared_reference_ext< scgms::SFilter_Configuration_Link, scgms::IFilter_Configuration_Link>(configuration_link, true);
 
-		//3nd round - set the receivers to the senders
-		//multiple senders can connect to a single receiver (so that we can have a single feedback filter)
-		if (!feedback_map.empty())
-			for (auto &possible_sender : mExecutors) {
-				refcnt::SReferenced<scgms::IFilter_Feedback_Sender> feedback_sender;
-				refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Feedback_Sender>(possible_sender.get(), scgms::IID_Filter_Feedback_Sender, feedback_sender);
-				if (feedback_sender) {
-					wchar_t *name;
-					if (feedback_sender->Name(&name) == S_OK) {
-
-						auto feedback_receiver = feedback_map.find(name);
-						if (feedback_receiver != feedback_map.end()) {
-							feedback_sender->Sink(feedback_receiver->second.get());
-						}
-						else {
-							std::wstring err_str{ dsFeedback_sender_not_connected };
-							err_str += name;
-							error_description.push(err_str.c_str());
-							send_shut_down();
-							mExecutors.clear();
-							return E_FAIL;	//this is very likely severe error in the configuration, hence we stop it
-						}
+	GUID filter_id;
+	HRESULT rc = link->Get_Filter_Id(&filter_id);
+	if (rc != S_OK) {
+		error_description.push(dsCannot_read_filter_id);
+		return rc;
+	}
+
+	std::unique_ptr<CFilter_Executor> new_executor = std::make_unique<CFilter_Executor>(filter_id, communication_guard, next_filter, on_filter_created, on_filter_created_data);
+	//try to configure the filter 
+	if (!new_executor) {
+		return E_OUTOFMEMORY;
+	}
+
+	new_executor->Set_Logical_Clock(&mLogical_Clock);
+
+
+	rc = new_executor->Configure(link.get(), error_description.get());
+	if (!Succeeded(rc)) {
+		//if failed, we need to delete this, newly constructed filter first,
+		//i.e., before clearing mExecutors because it is tied to resources,
+		//which must be released AFTER destroying this filter
+		new_executor.reset(nullptr);
+
+		//describe such an event anyway just in the case the filter would not do so - hence we would at least know the configuration-failing filter
+		std::wstring err_str{dsFailed_to_configure_filter};
+		err_str += GUID_To_WString(filter_id);
+		err_str += L"; filter zero-indexed position: ";
+		err_str += std::to_wstring(link_position);
+		
+		bool failed_to_resolve_descriptor = false;
+		//try to obtain filter's name
+		{
+			scgms::TFilter_Descriptor desc = scgms::Null_Filter_Descriptor;
+			if (scgms::get_filter_descriptor_by_id(filter_id, desc) ) {
+				err_str += L" \"";
+				err_str += desc.description;
+				err_str += L'"';
+			}
+			else {
+				failed_to_resolve_descriptor = true;
+			}
+		}
+		error_description.push(err_str.c_str());
+
+		if (failed_to_resolve_descriptor) {
+			describe_loaded_filters(error_description);
+		}
+
+		err_str = dsLast_RC + std::wstring{ Describe_Error(rc) };
+		error_description.push(err_str.c_str());
+
+		return rc;
+	}
+
+	executor = std::move(new_executor);
+	return S_OK;
+}
+
+HRESULT CComposite_Filter::Connect_Feedbacks(std::vector<std::unique_ptr<CFilter_Executor>> &executors, std::vector<std::pair<size_t, size_t>> &feedback_spans, refcnt::Swstr_list &error_description) {
+	//gather information about the feedback receivers
+	std::map<std::wstring, std::pair<size_t, scgms::SFilter_Feedback_Receiver>> feedback_map;
+	for (size_t receiver_position = 0; receiver_position < executors.size(); receiver_position++) {
+		scgms::SFilter_Feedback_Receiver feedback_receiver;
+		refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Feedback_Receiver>(executors[receiver_position].get(), scgms::IID_Filter_Feedback_Receiver, feedback_receiver);
+		if (feedback_receiver) {
+			wchar_t *name;
+			if (feedback_receiver->Name(&name) == S_OK) {
+				feedback_map[name] = { receiver_position, feedback_receiver };
+			}
+		}
+	}
+
+	//set the receivers to the senders
+	//multiple senders can connect to a single receiver (so that we can have a single feedback filter)
+	if (!feedback_map.empty())
+		for (size_t sender_position = 0; sender_position < executors.size(); sender_position++) {
+			refcnt::SReferenced<scgms::IFilter_Feedback_Sender> feedback_sender;
+			refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Feedback_Sender>(executors[sender_position].get(), scgms::IID_Filter_Feedback_Sender, feedback_sender);
+			if (feedback_sender) {
+				wchar_t *name;
+				if (feedback_sender->Name(&name) == S_OK) {
+
+					auto feedback_receiver = feedback_map.find(name);
+					if (feedback_receiver != feedback_map.end()) {
+						feedback_sender->Sink(feedback_receiver->second.second.get());
+						feedback_spans.push_back({ feedback_receiver->second.first, sender_position });
+					}
+					else {
+						std::wstring err_str{ dsFeedback_sender_not_connected };
+						err_str += name;
+						error_description.push(err_str.c_str());
+						return E_FAIL;
 					}
 				}
 			}
+		}
+
+	return S_OK;
+}
+
+void CComposite_Filter::Unroll_Feedback_Batches(std::vector<std::unique_ptr<CFilter_Executor>> &executors, const std::vector<std::pair<size_t, size_t>> &feedback_spans) {
+	for (const auto &[receiver_position, sender_position] : feedback_spans) {
+		for (size_t i = std::min(receiver_position, sender_position); i <= std::max(receiver_position, sender_position); i++) {
+			executors[i]->Unroll_Batches();
+		}
+	}
+}
+
+HRESULT CComposite_Filter::Build_Shards(scgms::IFilter_Configuration_Link **link_begin, scgms::IFilter_Configuration_Link **link_end, scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data,
+										std::vector<std::unique_lock<std::recursive_mutex>> &build_locks, refcnt::Swstr_list &error_description) {
+	//the first shard is the chain itself, the others replicate all its filters but the first one
+	const size_t filter_count = std::distance(link_begin, link_end);
+
+	for (size_t shard = 1; shard < mOptions.shard_count; shard++) {
+		mStage_Guards.push_back(std::make_unique<std::recursive_mutex>());
+		std::recursive_mutex &shard_guard = *mStage_Guards.back();
+		build_locks.emplace_back(shard_guard);
+
+		auto &replica = mShard_Replicas.emplace_back();
+		scgms::IFilter *last_filter = mShard_Merge.get();
+		for (size_t link_position = filter_count - 1; link_position > 0; link_position--) {
+			std::unique_ptr<CFilter_Executor> new_executor;
+			const HRESULT rc = Create_Executor(link_begin[link_position], link_position, shard_guard, last_filter, on_filter_created, on_filter_created_data, error_description, new_executor);
+			if (!Succeeded(rc)) {
+				return rc;
+			}
+
+			new_executor->Set_Profile(mExecutors[link_position]->Profile());	//the replicas of a filter share its profile
+			last_filter = new_executor.get();
+			replica.insert(replica.begin(), std::move(new_executor));
+		}
+
+		std::vector<std::pair<size_t, size_t>> feedback_spans;
+		const HRESULT rc = Connect_Feedbacks(replica, feedback_spans, error_description);
+		if (!Succeeded(rc)) {
+			return rc;
+		}
+		Unroll_Feedback_Batches(replica, feedback_spans);
+
+		mShard_Entries.push_back(std::make_unique<CShard_Entry>(last_filter, *mShard_Merge));
+		mShard_Stages.push_back(std::make_unique<CPipeline_Stage>(mShard_Entries.back().get(), mOptions.pipeline_queue_capacity));
+		mShard_Merge->Add_Shard();
+		mShard_Router->Add_Shard(mShard_Stages.back().get());
 	}
 
-	mRefuse_Execute = false;
 	return S_OK;
 }
 
@@ -221,6 +453,133 @@ HRESULT CComposite_Filter::Execute(scgms::IDevice_Event *event) noexcept {
 	return mExecutors[0]->Execute(event);	//and by this, we delegate event's release to the filters
 }
 
+HRESULT CComposite_Filter::Execute_Batch(scgms::IDevice_Event **begin, scgms::IDevice_Event **end) noexcept {
+	auto release_batch = [begin, end]() {
+		for (auto iter = begin; iter != end; iter++) {
+			(*iter)->Release();
+		}
+	};
+
+	if (begin == end) {
+		return S_OK;
+	}
+	if (mExecutors.empty()) {
+		release_batch();
+		return S_FALSE;
+	}
+
+	std::lock_guard<std::recursive_mutex> lock_guard{ mCommunication_Guard };
+	if (mRefuse_Execute) {
+		release_batch();
+		return E_ILLEGAL_METHOD_CALL;
+	}
+
+	return mExecutors[0]->Execute_Batch(begin, end);	//the executor unrolls the batch, if the first filter cannot process it at once
+}
+
+HRESULT CComposite_Filter::Save_Checkpoint(std::vector<std::vector<char>> *checkpoint) noexcept {
+	std::lock_guard<std::recursive_mutex> lock_guard{ mCommunication_Guard };
+	if (mExecutors.empty() || !mShard_Replicas.empty() || !mPipeline_Stages.empty()) {
+		return S_FALSE;	//the stages would hold events, which have not reached their filters yet
+	}
+
+	if (checkpoint) {
+		checkpoint->clear();
+	}
+
+	for (auto &executor : mExecutors) {
+		refcnt::SReferenced<scgms::IFilter_Checkpointable> checkpointable;
+		refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Checkpointable>(executor.get(), scgms::IID_Filter_Checkpointable, checkpointable);
+		if (!checkpointable) {
+			return S_FALSE;
+		}
+
+		if (!checkpoint) {
+			const HRESULT rc = checkpointable->Save_Checkpoint(nullptr);
+			if (rc != S_OK) {
+				return Succeeded(rc) ? S_FALSE : rc;
+			}
+			continue;
+		}
+
+		auto filter_checkpoint = refcnt::Create_Container_shared<char>(nullptr, nullptr);
+		const HRESULT rc = checkpointable->Save_Checkpoint(filter_checkpoint.get());
+		if (rc != S_OK) {
+			return Succeeded(rc) ? S_FALSE : rc;
+		}
+
+		char *begin, *end;
+		if (filter_checkpoint->get(&begin, &end) == S_OK) {
+			checkpoint->emplace_back(begin, end);
+		} else {
+			checkpoint->emplace_back();	//empty state
+		}
+	}
+
+	return S_OK;
+}
+
+HRESULT CComposite_Filter::Restore_Checkpoint(const std::vector<std::vector<char>> &checkpoint) noexcept {
+	std::lock_guard<std::recursive_mutex> lock_guard{ mCommunication_Guard };
+	if (checkpoint.size() != mExecutors.size()) {
+		return E_INVALIDARG;
+	}
+
+	for (size_t i = 0; i < mExecutors.size(); i++) {
+		refcnt::SReferenced<scgms::IFilter_Checkpointable> checkpointable;
+		refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Checkpointable>(mExecutors[i].get(), scgms::IID_Filter_Checkpointable, checkpointable);
+		if (!checkpointable) {
+			return E_NOINTERFACE;
+		}
+
+		char* data = const_cast<char*>(checkpoint[i].data());
+		auto filter_checkpoint = refcnt::Create_Container_shared<char>(data, data + checkpoint[i].size());
+		const HRESULT rc = checkpointable->Restore_Checkpoint(filter_checkpoint.get());
+		if (rc != S_OK) {
+			return Succeeded(rc) ? E_FAIL : rc;
+		}
+	}
+
+	return S_OK;
+}
+
+bool CComposite_Filter::Reusable() noexcept {
+	std::lock_guard<std::recursive_mutex> lock_guard{ mCommunication_Guard };
+	if (mExecutors.empty() || !mShard_Replicas.empty() || !mPipeline_Stages.empty()) {
+		return false;
+	}
+
+	for (auto &executor : mExecutors) {
+		refcnt::SReferenced<scgms::IFilter_Reusable> reusable;
+		refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Reusable>(executor.get(), scgms::IID_Filter_Reusable, reusable);
+		if (!reusable) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+HRESULT CComposite_Filter::Reset(const std::vector<TFilter_Reset_Parameters> &parameters) noexcept {
+	std::lock_guard<std::recursive_mutex> lock_guard{ mCommunication_Guard };
+
+	for (size_t i = 0; i < mExecutors.size(); i++) {
+		refcnt::SReferenced<scgms::IFilter_Reusable> reusable;
+		refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Reusable>(mExecutors[i].get(), scgms::IID_Filter_Reusable, reusable);
+		if (!reusable) {
+			return E_NOINTERFACE;
+		}
+
+		const auto filter_parameters = std::find_if(parameters.begin(), parameters.end(), [i](const TFilter_Reset_Parameters &p) { return p.position == i; });
+		const HRESULT rc = filter_parameters != parameters.end() ? reusable->Reset(filter_parameters->parameters_name, filter_parameters->parameters) : reusable->Reset(nullptr, nullptr);
+		if (!Succeeded(rc)) {
+			return rc;
+		}
+	}
+
+	return S_OK;
+}
+
 HRESULT CComposite_Filter::Clear() noexcept {
 	//obtain the communication guard/lock to ensure that no new communication will be accepted
 	//via the execute method
@@ -230,16 +589,84 @@ HRESULT CComposite_Filter::Clear() noexcept {
 		mRefuse_Execute = true;
 	}
 
+	//the stage workers have to deliver what they have queued so far and then, to stop 
+	Stop_Pipeline();
+
 	//once we refuse any communication from the Execute method, we can safely release the filters
 	//assuming that they terminate any threads they have spawned
 	for (size_t i = 0; i < mExecutors.size(); i++) {
 		mExecutors[i]->Release_Filter();
 	}
-	mExecutors.clear();	//calls reset on all contained unique ptr's	
+	for (auto &replica : mShard_Replicas) {
+		for (auto &executor : replica) {
+			executor->Release_Filter();
+		}
+	}
+	Clear_Executors();
+
+	//in the case that the shut down event did not make it through the entire chain
+	if (mProfiler) {
+		mProfiler->Dump();
+	}
 
 	return S_OK;
 }
 
+void CComposite_Filter::Start_Pipeline(const std::vector<std::pair<size_t, size_t>> &feedback_spans, std::vector<std::unique_lock<std::recursive_mutex>> &build_locks) {
+	//a feedback must not cross a stage boundary, because the sender could wait for the stage it feeds back to
+	//=> stages spanned by a feedback are merged, i.e.; their boundaries remain in the pass-through mode
+	std::set<size_t> merged_stages;
+	for (const auto &[receiver_position, sender_position] : feedback_spans) {
+		const size_t span_begin = std::min(receiver_position, sender_position);
+		const size_t span_end = std::max(receiver_position, sender_position);
+		for (auto stage = mPipeline_Stages.upper_bound(span_begin); (stage != mPipeline_Stages.end()) && (stage->first <= span_end); stage++) {
+			merged_stages.insert(stage->first);
+		}
+	}
+
+	//each stage gets its own guard so that the stages do not block each other
+	std::vector<CPipeline_Stage*> stages_to_start;
+	std::recursive_mutex *stage_guard = &mCommunication_Guard;
+	for (size_t i = 0; i < mExecutors.size(); i++) {
+		auto stage = mPipeline_Stages.find(i);
+		if ((stage != mPipeline_Stages.end()) && (merged_stages.find(i) == merged_stages.end())) {
+			mStage_Guards.push_back(std::make_unique<std::recursive_mutex>());
+			stage_guard = mStage_Guards.back().get();
+			build_locks.emplace_back(*stage_guard);	//nobody can enter the stage until the chain is completely built
+			stages_to_start.push_back(stage->second.get());
+		}
+
+		mExecutors[i]->Set_Communication_Guard(*stage_guard);
+	}
+
+	for (auto stage : stages_to_start) {
+		stage->Start();
+	}
+}
+
+void CComposite_Filter::Stop_Pipeline() {
+	//in the upstream-to-downstream order, so that the events flushed from a stage still pass through the following ones
+	for (auto &stage : mPipeline_Stages) {
+		stage.second->Stop();
+	}
+
+	for (auto &stage : mShard_Stages) {
+		stage->Stop();
+	}
+}
+
+void CComposite_Filter::Clear_Executors() {
+	mExecutors.clear();	//calls reset on all contained unique ptr's	
+	//the filters are gone, so nobody can send to the stages any longer
+	mShard_Replicas.clear();
+	mPipeline_Stages.clear();
+	mShard_Stages.clear();
+	mShard_Entries.clear();
+	mShard_Router.reset();
+	mShard_Merge.reset();
+	mStage_Guards.clear();
+}
+
 bool CComposite_Filter::Empty() const noexcept {
 	return mExecutors.empty();
 }
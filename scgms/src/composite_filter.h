@@ -40,6 +40,32 @@
 #include <scgms/rtl/FilterLib.h>
 
 #include "executor.h"
+#include "pipeline.h"
+#include "profiler.h"
+#include "sharding.h"
+
+#include <map>
+#include <string>
+
+//options affecting how the chain executes, but not what it computes
+struct TChain_Execution_Options {
+	size_t pipeline_stage_size = 0;			//number of consecutive filters forming a single pipeline stage with its own worker; zero disables the pipelining
+	size_t pipeline_queue_capacity = 1024;	//maximum number of events queued for a single stage
+	size_t shard_count = 1;					//number of the chain body replicas, among which the first filter distributes the segments; one disables the sharding
+											//the body must not contain filters writing their own output, like the log or the drawing
+	bool profile = false;					//collect the execution statistics of each filter
+	std::string profile_output;				//path, without the extension, to dump the statistics to as .csv and .json on the shut down; implies profile
+};
+
+//reads the options from the SCGMS_PIPELINE_STAGE_SIZE, SCGMS_PIPELINE_QUEUE_CAPACITY, SCGMS_SHARD_COUNT, SCGMS_PROFILE and SCGMS_PROFILE_OUTPUT environment variables
+TChain_Execution_Options Chain_Execution_Options_From_Environment();
+
+//new parameters of a filter, when the chain is reset
+struct TFilter_Reset_Parameters {
+	size_t position;		//of the filter in the configuration
+	const wchar_t* parameters_name;
+	scgms::IModel_Parameter_Vector* parameters;
+};
 
 #pragma warning( push )
 #pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance 
@@ -47,16 +73,51 @@
 class CComposite_Filter  {
 	protected:
 		bool mRefuse_Execute = false;
-		std::recursive_mutex &mCommunication_Guard;		
+		std::recursive_mutex &mCommunication_Guard;
+		const TChain_Execution_Options mOptions;
+		CLogical_Clock mLogical_Clock;	//own domain, so that the concurrent chains do not contend on a single clock; outlives the executors
+		std::vector<std::unique_ptr<std::recursive_mutex>> mStage_Guards;			//guards of the pipeline stages, but the first one, which uses mCommunication_Guard
+		std::map<size_t, std::unique_ptr<CPipeline_Stage>> mPipeline_Stages;	//keyed by the index of the stage's first filter
 		std::vector<std::unique_ptr<CFilter_Executor>> mExecutors;
+		std::vector<std::vector<std::unique_ptr<CFilter_Executor>>> mShard_Replicas;	//all the shards, but the first one, which consists of mExecutors[1..]
+		std::vector<std::unique_ptr<CShard_Entry>> mShard_Entries;				//first filters of the shards, in the order of the shards
+		std::vector<std::unique_ptr<CPipeline_Stage>> mShard_Stages;				//workers of the shards, in the order of the shards
+		std::unique_ptr<CShard_Router> mShard_Router;
+		std::unique_ptr<CShard_Merge> mShard_Merge;
+		std::unique_ptr<CChain_Profiler> mProfiler;	//outlives the executors, so that the statistics remain available once the chain terminates
+
+		HRESULT Create_Executor(scgms::IFilter_Configuration_Link *configuration_link, const size_t link_position, std::recursive_mutex &communication_guard, scgms::IFilter *next_filter,
+								scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data, refcnt::Swstr_list &error_description, std::unique_ptr<CFilter_Executor> &executor);
+		HRESULT Connect_Feedbacks(std::vector<std::unique_ptr<CFilter_Executor>> &executors, std::vector<std::pair<size_t, size_t>> &feedback_spans, refcnt::Swstr_list &error_description);
+		void Unroll_Feedback_Batches(std::vector<std::unique_ptr<CFilter_Executor>> &executors, const std::vector<std::pair<size_t, size_t>> &feedback_spans);
+		HRESULT Build_Shards(scgms::IFilter_Configuration_Link **link_begin, scgms::IFilter_Configuration_Link **link_end, scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data,
+							 std::vector<std::unique_lock<std::recursive_mutex>> &build_locks, refcnt::Swstr_list &error_description);
+		void Start_Pipeline(const std::vector<std::pair<size_t, size_t>> &feedback_spans, std::vector<std::unique_lock<std::recursive_mutex>> &build_locks);
+		void Stop_Pipeline();
+		void Clear_Executors();
 
 	public:
-		CComposite_Filter(std::recursive_mutex &communication_guard) noexcept;
+		CComposite_Filter(std::recursive_mutex &communication_guard, const TChain_Execution_Options &options = TChain_Execution_Options{}) noexcept;
+		~CComposite_Filter();
 
 		HRESULT Build_Filter_Chain(scgms::IFilter_Chain_Configuration *configuration, scgms::IFilter *next_filter, scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data, refcnt::Swstr_list &error_description) noexcept;
 		HRESULT Execute(scgms::IDevice_Event *event) noexcept;
+		HRESULT Execute_Batch(scgms::IDevice_Event **begin, scgms::IDevice_Event **end) noexcept;
 		HRESULT Clear() noexcept;
 		bool Empty() const noexcept;
+
+		//S_OK, if all the filters saved their states, which do not depend on their parameters yet; S_FALSE, if any of them cannot do so
+		//the checkpoint may be nullptr to just test, whether it can be saved
+		HRESULT Save_Checkpoint(std::vector<std::vector<char>> *checkpoint) noexcept;
+		//the chain has to be built, but it must not have received any event yet
+		HRESULT Restore_Checkpoint(const std::vector<std::vector<char>> &checkpoint) noexcept;
+
+		//true, if all the filters can be reset instead of shutting the chain down and building it again
+		bool Reusable() noexcept;
+		//resets all the filters, which must not be shut down yet; the listed ones get new parameters
+		HRESULT Reset(const std::vector<TFilter_Reset_Parameters> &parameters) noexcept;
+
+		const CChain_Profiler* Profiler() const noexcept { return mProfiler.get(); };	//nullptr, if not profiling
 };
 
 #pragma warning( pop )
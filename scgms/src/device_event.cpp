@@ -43,77 +43,338 @@
 #include <scgms/utils/DebugHelper.h>
 
 #include <atomic>
+#include <mutex>
 #include <stdexcept>
 
 
 #include <array>
 #include <atomic>
 #include <tuple>
+#include <vector>
+#include <limits>
+#include <algorithm>
 
 
 constexpr size_t Event_Pool_Size = 100*1024;
+constexpr size_t Event_Magazine_Size = 64;		//number of free slots a thread can keep for itself
+constexpr size_t Event_Magazine_Refill = Event_Magazine_Size / 2;	//number of slots moved between a magazine and the shared free list at once
+constexpr size_t Cache_Line_Size = 64;
+constexpr size_t Pooled_Parameters_Capacity = 64;	//number of doubles a slot keeps for its parameters events; larger vectors get their own containers
 
+class CEvent_Pool;
+
+#pragma warning( push )
+#pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
+
+//Parameters of the pooled events, which their slot keeps for the next parameters event, so that it does not allocate them again.
+//The slot holds one reference. Once the event is released, and nobody else holds the parameters, the slot recycles them.
+//Otherwise, the slot drops its reference, so that the last holder deletes them.
+class CPooled_Parameters : public virtual refcnt::internal::CVector_Container<double> {
+	protected:
+		std::atomic<ULONG> mReferences{ 1 };
+
+	public:
+		CPooled_Parameters() {
+			mData.reserve(Pooled_Parameters_Capacity);
+		}
+
+		virtual ~CPooled_Parameters() = default;
+
+		virtual ULONG IfaceCalling AddRef() override final {
+			return mReferences.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+
+		virtual ULONG IfaceCalling Release() override final {
+			const ULONG references = mReferences.fetch_sub(1, std::memory_order_acq_rel) - 1;
+			if (references == 0) {
+				delete this;
+			}
+
+			return references;
+		}
+
+		bool Shared() const noexcept {
+			return mReferences.load(std::memory_order_acquire) > 1;
+		}
+
+		void Assign(const double *begin, const double *end) {
+			mData.assign(begin, end);
+		}
+
+		void Recycle() noexcept {
+			mData.clear();
+		}
+};
+
+#pragma warning( pop )
+
+//constant-initialized, so that the pool may stamp its events during its construction
+CLogical_Clock global_logical_clock{ CLogical_Clock::Global_Domain };
+thread_local CLogical_Clock* current_logical_clock = nullptr;
+
+std::mutex logical_domains_guard;
+std::vector<int64_t> free_logical_domains;
+std::vector<CLogical_Clock*> active_logical_clocks;	//those with an own domain
+int64_t next_logical_domain = CLogical_Clock::Global_Domain + 1;
+
+int64_t Tick_Logical_Clock() noexcept {
+	if (current_logical_clock) {
+		return current_logical_clock->Tick();
+	}
+
+	//the global clock catches up with the chains lazily, as only the threads outside any chain pay for it
+	{
+		std::lock_guard<std::mutex> lock{ logical_domains_guard };
+		for (const CLogical_Clock *clock : active_logical_clocks) {
+			global_logical_clock.Observe(*clock);
+		}
+	}
+
+	return global_logical_clock.Tick();
+}
+
+//per-thread cache of free slots, so that most allocations and releases do not touch the shared free list at all
+struct TEvent_Magazine {
+	std::array<uint32_t, Event_Magazine_Size> slots;
+	size_t count = 0;
+
+	~TEvent_Magazine();
+};
+
+//Free slots are kept in a lock-free stack (Treiber's), whose links are the slot indices.
+//The head is tagged with a counter, which is incremented with each change to prevent the ABA problem.
 class CEvent_Pool {
 	protected:
+		static constexpr uint32_t Nil_Slot = std::numeric_limits<uint32_t>::max();
+
 		std::array<CDevice_Event, Event_Pool_Size> mEvents;
-		std::array<std::atomic<bool>, Event_Pool_Size > mAllocated_Flags{ false };
-		std::atomic<size_t> mRecent_Allocated_Event_Idx{ Event_Pool_Size - 1 };
+		std::array<std::atomic<uint32_t>, Event_Pool_Size> mNext_Free;
+
+		alignas(Cache_Line_Size) std::atomic<uint64_t> mFree_Head{ Tagged_Head(0, Nil_Slot) };		//tag in the upper half, slot index in the lower half
+
+		alignas(Cache_Line_Size) std::atomic<size_t> mOutstanding_Count{ 0 };		//slots taken from the shared free list, including those cached in the magazines
+		std::atomic<size_t> mHigh_Water_Mark{ 0 };
+		std::atomic<size_t> mHeap_Fallback_Count{ 0 };
+
+		static uint64_t Tagged_Head(const uint64_t tag, const uint32_t slot) noexcept {
+			return (tag << 32) | slot;
+		}
+
+		static uint32_t Head_Slot(const uint64_t head) noexcept {
+			return static_cast<uint32_t>(head & 0xFFFFFFFFull);
+		}
+
+		static uint64_t Head_Tag(const uint64_t head) noexcept {
+			return head >> 32;
+		}
+
+		//links slots[0]..slots[count-1] into a chain and pushes it with a single CAS
+		void Push_Free_Slots(const uint32_t* slots, const size_t count) noexcept {
+			if (count == 0) {
+				return;
+			}
+
+			for (size_t i = 0; i + 1 < count; i++) {
+				mNext_Free[slots[i]].store(slots[i + 1], std::memory_order_relaxed);
+			}
+
+			uint64_t old_head = mFree_Head.load(std::memory_order_relaxed);
+			uint64_t new_head;
+			do {
+				mNext_Free[slots[count - 1]].store(Head_Slot(old_head), std::memory_order_relaxed);
+				new_head = Tagged_Head(Head_Tag(old_head) + 1, slots[0]);
+			} while (!mFree_Head.compare_exchange_weak(old_head, new_head, std::memory_order_release, std::memory_order_relaxed));
+
+			mOutstanding_Count.fetch_sub(count, std::memory_order_relaxed);
+		}
+
+		uint32_t Pop_Free_Slot() noexcept {
+			uint64_t old_head = mFree_Head.load(std::memory_order_acquire);
+			uint64_t new_head;
+			do {
+				const uint32_t slot = Head_Slot(old_head);
+				if (slot == Nil_Slot) {
+					return Nil_Slot;
+				}
+
+				//the slot may be popped and relinked meanwhile, but then the tag will differ and the CAS fails
+				new_head = Tagged_Head(Head_Tag(old_head) + 1, mNext_Free[slot].load(std::memory_order_relaxed));
+			} while (!mFree_Head.compare_exchange_weak(old_head, new_head, std::memory_order_acquire, std::memory_order_acquire));
+
+			return Head_Slot(old_head);
+		}
+
+		bool Refill_Magazine(TEvent_Magazine& magazine) noexcept {
+			while (magazine.count < Event_Magazine_Refill) {
+				const uint32_t slot = Pop_Free_Slot();
+				if (slot == Nil_Slot) {
+					break;
+				}
+
+				magazine.slots[magazine.count++] = slot;
+			}
+
+			if (magazine.count > 0) {
+				const size_t outstanding = mOutstanding_Count.fetch_add(magazine.count, std::memory_order_relaxed) + magazine.count;
+				size_t high_water_mark = mHigh_Water_Mark.load(std::memory_order_relaxed);
+				while ((outstanding > high_water_mark) && !mHigh_Water_Mark.compare_exchange_weak(high_water_mark, outstanding, std::memory_order_relaxed)) {
+					//high_water_mark has been reloaded by the failed CAS
+				}
+			}
+
+			return magazine.count > 0;
+		}
+
+		static TEvent_Magazine& Magazine() noexcept {
+			thread_local TEvent_Magazine magazine;
+			return magazine;
+		}
 
 	public:
 		CEvent_Pool() {
 			for (size_t i = 0; i < Event_Pool_Size; i++) {
 				mEvents[i].Initialize(scgms::NDevice_Event_Code::Nothing);
 				mEvents[i].Set_Slot(i);
-				mAllocated_Flags[i] = false;
+				mNext_Free[i].store(i + 1 < Event_Pool_Size ? static_cast<uint32_t>(i + 1) : Nil_Slot, std::memory_order_relaxed);
 			}
+
+			mFree_Head.store(Tagged_Head(0, 0));
 		}
 	
 		~CEvent_Pool() {
+			//whatever is not on the free list has leaked - note that magazines of the terminated threads have already been returned
+			std::vector<bool> free_slots(Event_Pool_Size, false);
+			for (uint32_t slot = Head_Slot(mFree_Head.load()); slot != Nil_Slot; slot = mNext_Free[slot].load()) {
+				free_slots[slot] = true;
+			}
+
 			for (size_t i = 0; i < Event_Pool_Size; i++) {
-				if (mAllocated_Flags[i]) {
+				if (!free_slots[i]) {
 					dprintf("Leaked device event; logical time: %d\n", mEvents[i].logical_clock());
 				}
 			}
 		}
 
 		CDevice_Event* Alloc_Event() {
-			//obtain working index, but we need to do it as modulo spinlock
-
-			size_t working_idx = mRecent_Allocated_Event_Idx;
-			bool locked = false;
-			size_t retries_count = Event_Pool_Size * 2;
-
-			while ((!locked) && (retries_count-- > 0)) {
-				working_idx = (working_idx + 1) % Event_Pool_Size;
-				if (!mAllocated_Flags[working_idx]) {
-					locked = !mAllocated_Flags[working_idx].exchange(true);
-				}
-			}
-
-			if (locked) {
-				mRecent_Allocated_Event_Idx.store(working_idx);
-				return &mEvents[working_idx];
+			TEvent_Magazine& magazine = Magazine();
+			if ((magazine.count > 0) || Refill_Magazine(magazine)) {
+				return &mEvents[magazine.slots[--magazine.count]];
 			}
 			else {
+				mHeap_Fallback_Count.fetch_add(1, std::memory_order_relaxed);
 				return new CDevice_Event{};	//should be controlled with a flag for embedded devices
 			}
 		}
 
 		void Free_Event(const size_t slot) {
-			if (slot < Event_Pool_Size)
-				mAllocated_Flags[slot] = false;
+			if (slot < Event_Pool_Size) {
+				TEvent_Magazine& magazine = Magazine();
+				if (magazine.count == Event_Magazine_Size) {
+					//return the older half to the other threads
+					Push_Free_Slots(magazine.slots.data(), Event_Magazine_Refill);
+					std::copy(magazine.slots.begin() + Event_Magazine_Refill, magazine.slots.end(), magazine.slots.begin());
+					magazine.count -= Event_Magazine_Refill;
+				}
+
+				magazine.slots[magazine.count++] = static_cast<uint32_t>(slot);
+			}
+		}
+
+		void Return_Magazine(TEvent_Magazine& magazine) noexcept {
+			Push_Free_Slots(magazine.slots.data(), magazine.count);
+			magazine.count = 0;
+		}
+
+		void Get_Statistics(TEvent_Pool_Statistics& statistics) const noexcept {
+			statistics.pool_size = Event_Pool_Size;
+			statistics.high_water_mark = mHigh_Water_Mark.load(std::memory_order_relaxed);
+			statistics.heap_fallback_count = mHeap_Fallback_Count.load(std::memory_order_relaxed);
 		}
 };
 
 
 CEvent_Pool event_pool;
 
-std::atomic<int64_t> global_logical_time{ 0 };
+TEvent_Magazine::~TEvent_Magazine() {
+	event_pool.Return_Magazine(*this);
+}
+
+CLogical_Clock::CLogical_Clock() noexcept : mDomain(Global_Domain), mShared(true) {
+	std::lock_guard<std::mutex> lock{ logical_domains_guard };
+	if (!free_logical_domains.empty()) {
+		mDomain = free_logical_domains.back();
+		free_logical_domains.pop_back();
+		mShared = false;
+	}
+	else if (next_logical_domain <= Domain_Mask) {
+		mDomain = next_logical_domain++;
+		mShared = false;
+	}
+
+	if (!mShared) {
+		try {
+			active_logical_clocks.push_back(this);
+		}
+		catch (...) {
+			//without the registration, the global clock would not follow this one
+			free_logical_domains.push_back(mDomain);
+			mDomain = Global_Domain;
+			mShared = true;
+		}
+	}
+}
+
+CLogical_Clock::~CLogical_Clock() noexcept {
+	if (!mShared && (mDomain != Global_Domain)) {
+		std::lock_guard<std::mutex> lock{ logical_domains_guard };
+		global_logical_clock.Observe(*this);	//the events of this chain may still live on
+		active_logical_clocks.erase(std::remove(active_logical_clocks.begin(), active_logical_clocks.end(), this), active_logical_clocks.end());
+		free_logical_domains.push_back(mDomain);
+	}
+}
+
+int64_t CLogical_Clock::Tick() noexcept {
+	if (mShared) {
+		return global_logical_clock.Tick();
+	}
+
+	return (mCounter.fetch_add(1, std::memory_order_relaxed) << Domain_Bits) | mDomain;
+}
+
+void CLogical_Clock::Observe(const int64_t logical_time) noexcept {
+	if (mShared) {
+		global_logical_clock.Observe(logical_time);
+		return;
+	}
+
+	const int64_t next = (logical_time >> Domain_Bits) + 1;
+	int64_t current = mCounter.load(std::memory_order_relaxed);
+	while ((current < next) && !mCounter.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+		//current has been reloaded by the failed CAS
+	}
+}
+
+void CLogical_Clock::Observe(const CLogical_Clock &clock) noexcept {
+	const int64_t ticks = clock.mCounter.load(std::memory_order_relaxed);
+	if (ticks > 0) {
+		Observe((ticks - 1) << Domain_Bits);	//the last tick of the clock
+	}
+}
+
+CLogical_Clock_Scope::CLogical_Clock_Scope(CLogical_Clock *clock) noexcept : mPrevious(current_logical_clock) {
+	if (clock) {
+		current_logical_clock = clock;
+	}
+}
+
+CLogical_Clock_Scope::~CLogical_Clock_Scope() noexcept {
+	current_logical_clock = mPrevious;
+}
 
 void Clone_Raw(const scgms::TDevice_Event& src_raw, scgms::TDevice_Event& dst_raw) noexcept {
 
 	memcpy(&dst_raw, &src_raw, sizeof(dst_raw));
-	dst_raw.logical_time = global_logical_time.fetch_add(1);
+	dst_raw.logical_time = Tick_Logical_Clock();
 
 	switch (scgms::UDevice_Event_internal::major_type(dst_raw.event_code)) {
 		case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::info:
@@ -139,11 +400,57 @@ void Clone_Raw(const scgms::TDevice_Event& src_raw, scgms::TDevice_Event& dst_ra
 CDevice_Event::CDevice_Event(CDevice_Event&& other) noexcept {
 	memcpy(&mRaw, &other.mRaw, sizeof(mRaw));
 	memset(&other.mRaw, 0, sizeof(other.mRaw));
+	mPooled_Parameters = other.mPooled_Parameters;
+	other.mPooled_Parameters = nullptr;
+}
+
+scgms::IModel_Parameter_Vector* CDevice_Event::Acquire_Parameters(const double *begin, const double *end) noexcept {
+	const bool pooled = (mSlot != std::numeric_limits<size_t>::max()) && (static_cast<size_t>(std::distance(begin, end)) <= Pooled_Parameters_Capacity);
+	if (pooled && !mPooled_Parameters) {
+		mPooled_Parameters = new (std::nothrow) CPooled_Parameters{};	//once per slot, unless the parameters outlive their events
+	}
+
+	if (!pooled || !mPooled_Parameters || mPooled_Parameters->Shared()) {
+		return refcnt::Create_Container<double>(const_cast<double*>(begin), const_cast<double*>(end));
+	}
+
+	mPooled_Parameters->Assign(begin, end);
+	mPooled_Parameters->AddRef();
+	return static_cast<scgms::IModel_Parameter_Vector*>(mPooled_Parameters);
+}
+
+void CDevice_Event::Own_Parameters() noexcept {
+	if ((scgms::UDevice_Event_internal::major_type(mRaw.event_code) != scgms::UDevice_Event_internal::NDevice_Event_Major_Type::parameters)
+		|| !mRaw.parameters || (mRaw.parameters == static_cast<scgms::IModel_Parameter_Vector*>(mPooled_Parameters))) {
+		return;
+	}
+
+	double *begin = nullptr, *end = nullptr;
+	const HRESULT rc = mRaw.parameters->get(&begin, &end);
+	if (!Succeeded(rc) || (static_cast<size_t>(std::distance(begin, end)) > Pooled_Parameters_Capacity)) {
+		return;	//the large ones are shared as before
+	}
+
+	if (rc == S_FALSE) {
+		begin = end = nullptr;	//empty container
+	}
+
+	scgms::IModel_Parameter_Vector *own = Acquire_Parameters(begin, end);
+	if (own) {
+		mRaw.parameters->Release();
+		mRaw.parameters = own;
+	}
+}
+
+void CDevice_Event::Assign_Parameters(const double *begin, const double *end) noexcept {
+	if (scgms::UDevice_Event_internal::major_type(mRaw.event_code) == scgms::UDevice_Event_internal::NDevice_Event_Major_Type::parameters) {
+		mRaw.parameters = Acquire_Parameters(begin, end);
+	}
 }
 
 void CDevice_Event::Initialize(const scgms::NDevice_Event_Code code) noexcept {
 	memset(&mRaw, 0, sizeof(mRaw));
-	mRaw.logical_time = global_logical_time.fetch_add(1);
+	mRaw.logical_time = Tick_Logical_Clock();
 	mRaw.event_code = code;
 	mRaw.device_time = Unix_Time_To_Rat_Time(time(nullptr));
 	mRaw.segment_id = scgms::Invalid_Segment_Id;
@@ -155,7 +462,7 @@ void CDevice_Event::Initialize(const scgms::NDevice_Event_Code code) noexcept {
 			break;
 
 		case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::parameters:
-			mRaw.parameters = refcnt::Create_Container<double>(nullptr, nullptr);
+			mRaw.parameters = Acquire_Parameters(nullptr, nullptr);
 			break;
 
 		default:
@@ -168,10 +475,19 @@ void CDevice_Event::Initialize(const scgms::NDevice_Event_Code code) noexcept {
 void CDevice_Event::Initialize(const scgms::TDevice_Event *event) noexcept {
 	Clean_Up();
 	Clone_Raw(*event, mRaw);
+	Own_Parameters();
+}
+
+void CDevice_Event::Adopt(const scgms::TDevice_Event& raw) noexcept {
+	//no clean up, because the pooled events are cleaned once released and the heap ones are not initialized at all
+	memcpy(&mRaw, &raw, sizeof(mRaw));
 }
 
 CDevice_Event::~CDevice_Event() noexcept {
 	Clean_Up();
+	if (mPooled_Parameters) {
+		mPooled_Parameters->Release();
+	}
 }
 
 void CDevice_Event::Clean_Up() noexcept {
@@ -195,6 +511,17 @@ void CDevice_Event::Clean_Up() noexcept {
 	}
 
 	mRaw.info = nullptr;	//also resets parameters to nullptr
+
+	if (mPooled_Parameters) {
+		if (mPooled_Parameters->Shared()) {
+			//someone keeps the parameters beyond the event
+			mPooled_Parameters->Release();
+			mPooled_Parameters = nullptr;
+		}
+		else {
+			mPooled_Parameters->Recycle();
+		}
+	}
 }
 
 ULONG IfaceCalling CDevice_Event::Release() noexcept {
@@ -218,6 +545,7 @@ HRESULT IfaceCalling CDevice_Event::Clone(IDevice_Event** event) const noexcept
 	auto clone = event_pool.Alloc_Event();
 	if (clone) {
 		Clone_Raw(mRaw, clone->mRaw);
+		clone->Own_Parameters();	//small parameters are cheaper to copy than to share, as the slot can reuse its own
 		*event = static_cast<scgms::IDevice_Event*>(clone);
 		return S_OK;
 	}
@@ -236,8 +564,36 @@ scgms::IDevice_Event* allocate_device_event(scgms::NDevice_Event_Code code) noex
 	return static_cast<scgms::IDevice_Event*>(result);
 }
 
+scgms::IDevice_Event* allocate_device_event(const scgms::TDevice_Event& raw) noexcept {
+	auto result = event_pool.Alloc_Event();
+	if (result) {
+		result->Adopt(raw);
+	}
+
+	return static_cast<scgms::IDevice_Event*>(result);
+}
+
+scgms::IDevice_Event* allocate_device_event(const scgms::TDevice_Event& raw, const double *parameters_begin, const double *parameters_end) noexcept {
+	auto result = event_pool.Alloc_Event();
+	if (result) {
+		result->Adopt(raw);
+		result->Assign_Parameters(parameters_begin, parameters_end);
+	}
+
+	return static_cast<scgms::IDevice_Event*>(result);
+}
+
 //SCGMS exported function
 DLL_EXPORT HRESULT IfaceCalling create_device_event(scgms::NDevice_Event_Code code, scgms::IDevice_Event * *event) noexcept {
 	*event = allocate_device_event(code);
 	return *event ? S_OK : E_OUTOFMEMORY;
+}
+
+DLL_EXPORT HRESULT IfaceCalling get_event_pool_statistics(TEvent_Pool_Statistics* statistics) noexcept {
+	if (!statistics) {
+		return E_INVALIDARG;
+	}
+
+	event_pool.Get_Statistics(*statistics);
+	return S_OK;
 }
\ No newline at end of file
@@ -38,12 +38,21 @@
 
 #include <scgms/iface/DeviceIface.h>
 
+#include <atomic>
+
+class CPooled_Parameters;
+
 class CDevice_Event : public virtual scgms::IDevice_Event {
 	protected:
 		scgms::TDevice_Event mRaw;
 		size_t mSlot = std::numeric_limits<size_t>::max();
+		CPooled_Parameters *mPooled_Parameters = nullptr;	//storage of the slot, which its parameters events reuse, unless someone still holds it
 		void Clean_Up() noexcept;
 
+		//the slot's own storage with a copy of the values, or a new container, if the event is not pooled or the values do not fit
+		scgms::IModel_Parameter_Vector* Acquire_Parameters(const double *begin, const double *end) noexcept;
+		void Own_Parameters() noexcept;	//replaces the shared parameters with a copy, if they fit the slot's storage
+
 	public:
 		CDevice_Event() noexcept {};
 		CDevice_Event(CDevice_Event &&other) noexcept;
@@ -55,6 +64,8 @@ class CDevice_Event : public virtual scgms::IDevice_Event {
 
 		void Initialize(const scgms::NDevice_Event_Code code) noexcept;
 		void Initialize(const scgms::TDevice_Event* event) noexcept;
+		void Adopt(const scgms::TDevice_Event& raw) noexcept;	//takes over the references of raw as they are, including its logical time
+		void Assign_Parameters(const double *begin, const double *end) noexcept;	//of an adopted parameters event, which has none yet
 
 		scgms::TDevice_Event& Raw() {
 			return mRaw;
@@ -71,4 +82,68 @@ class CDevice_Event : public virtual scgms::IDevice_Event {
 		virtual HRESULT IfaceCalling Clone(IDevice_Event** event) const noexcept override;
 };
 
+//Logical clock of a single chain, so that the concurrently executing chains do not contend on a single counter.
+//The lowest bits of the logical time hold the clock's domain, hence the times remain unique across the domains.
+//The chain stamps its events after every event it has received (Lamport's rule), so that ordering by the logical time respects the causality.
+//The global clock stamps the events created outside any chain, e.g.; on a filter's own thread. Just before it does so, it observes
+//the ticks of all the chains, so that such an event follows the events the chains have stamped already, while the chains never touch it.
+//The logical time, which leaves the library, is just the counter, so that it keeps its meaning of a monotonically increasing event number.
+class CLogical_Clock {
+	public:
+		static constexpr int Domain_Bits = 16;
+		static constexpr int64_t Domain_Mask = (int64_t{ 1 } << Domain_Bits) - 1;
+		static constexpr int64_t Global_Domain = 0;
+
+	protected:
+		alignas(64) std::atomic<int64_t> mCounter{ 0 };
+		int64_t mDomain;
+		bool mShared;	//no free domain was left, so that the clock delegates to the global one
+
+	public:
+		constexpr explicit CLogical_Clock(const int64_t domain) noexcept : mDomain(domain), mShared(false) {};
+		CLogical_Clock() noexcept;		//acquires a free domain
+		~CLogical_Clock() noexcept;
+
+		CLogical_Clock(const CLogical_Clock&) = delete;
+		CLogical_Clock& operator=(const CLogical_Clock&) = delete;
+
+		int64_t Tick() noexcept;
+		void Observe(const int64_t logical_time) noexcept;
+		void Observe(const CLogical_Clock &clock) noexcept;	//all the ticks the other clock has made so far
+
+		static int64_t Domain_Of(const int64_t logical_time) noexcept {
+			return logical_time & Domain_Mask;
+		}
+
+		static int64_t Counter_Of(const int64_t logical_time) noexcept {
+			return logical_time >> Domain_Bits;
+		}
+};
+
+//the clock stamps the events, which the current thread creates, until the scope ends; the global clock does so outside any scope
+class CLogical_Clock_Scope {
+	protected:
+		CLogical_Clock *mPrevious;
+
+	public:
+		explicit CLogical_Clock_Scope(CLogical_Clock *clock) noexcept;	//nullptr keeps the current clock
+		~CLogical_Clock_Scope() noexcept;
+
+		CLogical_Clock_Scope(const CLogical_Clock_Scope&) = delete;
+		CLogical_Clock_Scope& operator=(const CLogical_Clock_Scope&) = delete;
+};
+
+int64_t Tick_Logical_Clock() noexcept;	//the next logical time of the current thread's clock
+
 scgms::IDevice_Event* allocate_device_event(scgms::NDevice_Event_Code code) noexcept;
+scgms::IDevice_Event* allocate_device_event(const scgms::TDevice_Event& raw) noexcept;	//adopts raw, i.e.; no AddRef and no new logical time
+//adopts raw, whose parameters are ignored, and copies the parameters to the event's own storage
+scgms::IDevice_Event* allocate_device_event(const scgms::TDevice_Event& raw, const double *parameters_begin, const double *parameters_end) noexcept;
+
+struct TEvent_Pool_Statistics {
+	size_t pool_size;
+	size_t high_water_mark;			//maximum number of slots simultaneously taken from the pool, including those cached by the threads
+	size_t heap_fallback_count;		//number of events allocated on the heap, because the pool was exhausted
+};
+
+DLL_EXPORT HRESULT IfaceCalling get_event_pool_statistics(TEvent_Pool_Statistics* statistics) noexcept;
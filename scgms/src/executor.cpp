@@ -38,25 +38,55 @@
 #include "filters.h"
 #include "device_event.h"
 
+#include <optional>
+
 CFilter_Executor::CFilter_Executor(const GUID filter_id, std::recursive_mutex &communication_guard, scgms::IFilter *next_filter, scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data) :
-	mCommunication_Guard(communication_guard),  mOn_Filter_Created(on_filter_created), mOn_Filter_Created_Data(on_filter_created_data) {
+	mCommunication_Guard(&communication_guard), mFilter_Id(filter_id), mOn_Filter_Created(on_filter_created), mOn_Filter_Created_Data(on_filter_created_data) {
 	
 	mFilter = create_filter_body(filter_id, next_filter);
+	if (mFilter) {
+		refcnt::Query_Interface<scgms::IFilter, scgms::IFilter_Batch>(mFilter.get(), scgms::IID_Filter_Batch, mFilter_Batch);
+	}
 }
 
 void CFilter_Executor::Release_Filter() {
+	mFilter_Batch.reset();
 	if (mFilter) {
 		mFilter.reset();
 	}
 }
 
 
+void CFilter_Executor::Set_Communication_Guard(std::recursive_mutex &communication_guard) {
+	mCommunication_Guard.store(&communication_guard);
+}
+
+void CFilter_Executor::Set_Profile(CFilter_Profile *profile) {
+	mProfile = profile;
+}
+
+void CFilter_Executor::Set_Logical_Clock(CLogical_Clock *clock) {
+	mLogical_Clock = clock;
+}
+
+void CFilter_Executor::Observe(scgms::IDevice_Event *event) noexcept {
+	scgms::TDevice_Event *raw;
+	if (mLogical_Clock && event && (event->Raw(&raw) == S_OK)) {
+		mLogical_Clock->Observe(raw->logical_time);
+	}
+}
+
+void CFilter_Executor::Unroll_Batches() {
+	mFilter_Batch.reset();
+}
+
 HRESULT IfaceCalling CFilter_Executor::Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) {
 
 	if (!mFilter) {
 		return E_FAIL;
 	}
 
+	CLogical_Clock_Scope clock_scope{ mLogical_Clock };
 	HRESULT rc = mFilter->Configure(configuration, error_description);
 	if ((rc == S_OK) && mOn_Filter_Created) {
 		//at this point, we will call a callback function to perform any additional configuration of the filter we've just configured 
@@ -66,15 +96,82 @@ HRESULT IfaceCalling CFilter_Executor::Configure(scgms::IFilter_Configuration* c
 	return rc;
 }
 
+std::recursive_mutex& CFilter_Executor::Lock_Communication_Guard() {
+	//the lock may have been replaced while we were waiting for it, as the chain was being built
+	//therefore, we have to verify that we hold the one, which is current
+	std::recursive_mutex *communication_guard = mCommunication_Guard.load();
+	communication_guard->lock();
+	for (std::recursive_mutex *current_guard = mCommunication_Guard.load(); current_guard != communication_guard; current_guard = mCommunication_Guard.load()) {
+		communication_guard->unlock();
+		communication_guard = current_guard;
+		communication_guard->lock();
+	}
+
+	return *communication_guard;
+}
+
 HRESULT IfaceCalling CFilter_Executor::Execute(scgms::IDevice_Event *event) {
 	//Simply acquire the lock and then call execute method of the filter
-	std::lock_guard<std::recursive_mutex> guard{ mCommunication_Guard };
+	std::lock_guard<std::recursive_mutex> guard{ Lock_Communication_Guard(), std::adopt_lock };
+
+	//whatever the filter emits in response, it will be stamped after the event
+	CLogical_Clock_Scope clock_scope{ mLogical_Clock };
+	Observe(event);
+
+	if (mProfile) {
+		mProfile->Count_Event(event);
+		CProfiled_Call call{ *mProfile };
+		return mFilter->Execute(event);
+	}
 	
 	return mFilter->Execute(event);
 }
 
+HRESULT IfaceCalling CFilter_Executor::Execute_Batch(scgms::IDevice_Event** begin, scgms::IDevice_Event** end) {
+	//the lock is acquired just once for the entire batch
+	std::lock_guard<std::recursive_mutex> guard{ Lock_Communication_Guard(), std::adopt_lock };
+
+	CLogical_Clock_Scope clock_scope{ mLogical_Clock };
+	for (auto iter = begin; iter != end; iter++) {
+		Observe(*iter);
+	}
+
+	//the entire batch is measured as a single call
+	std::optional<CProfiled_Call> call;
+	if (mProfile) {
+		for (auto iter = begin; iter != end; iter++) {
+			mProfile->Count_Event(*iter);
+		}
+		call.emplace(*mProfile);
+	}
+
+	if (mFilter_Batch) {
+		return mFilter_Batch->Execute_Batch(begin, end);
+	}
+
+	//legacy filter - unroll the batch
+	for (auto iter = begin; iter != end; iter++) {
+		const HRESULT rc = mFilter->Execute(*iter);
+		if (!Succeeded(rc)) {
+			for (iter++; iter != end; iter++) {
+				(*iter)->Release();
+			}
+			return rc;
+		}
+	}
+
+	return S_OK;
+}
+
 
 HRESULT IfaceCalling CFilter_Executor::QueryInterface(const GUID*  riid, void ** ppvObj) {
+	//batches must go through the executor's lock too, hence we answer it for any filter
+	if (*riid == scgms::IID_Filter_Batch) {
+		*ppvObj = static_cast<scgms::IFilter_Batch*>(this);
+		AddRef();
+		return S_OK;
+	}
+
 	return mFilter ? mFilter->QueryInterface(riid, ppvObj) : E_FAIL;
 }
 
@@ -119,7 +216,7 @@ HRESULT IfaceCalling CTerminal_Filter::Execute(scgms::IDevice_Event *event) {
 	return S_OK;
 }
 
-CCopying_Terminal_Filter::CCopying_Terminal_Filter(std::vector<CDevice_Event> &events, bool do_not_copy_info_events) : CTerminal_Filter(nullptr), mEvents(events), mDo_Not_Copy_Info_Events(do_not_copy_info_events) {
+CCopying_Terminal_Filter::CCopying_Terminal_Filter(CReplay_Buffer &events) : CTerminal_Filter(nullptr), mEvents(events) {
 
 }
 
@@ -128,16 +225,8 @@ HRESULT IfaceCalling CCopying_Terminal_Filter::Execute(scgms::IDevice_Event *eve
 		
 	const HRESULT rc = event->Raw(&raw_event);
 	if (Succeeded(rc)) {
-
-		if (mDo_Not_Copy_Info_Events && (scgms::UDevice_Event_internal::major_type(raw_event->event_code) == scgms::UDevice_Event_internal::NDevice_Event_Major_Type::info)) {
-			return CTerminal_Filter::Execute(event);
-		} else {
-			CDevice_Event clone;
-			clone.Initialize(raw_event);
-
-			mEvents.push_back(std::move(clone));
-			return CTerminal_Filter::Execute(event);
-		}
+		mEvents.Append(*raw_event);	//ignores the info events
+		return CTerminal_Filter::Execute(event);
 	}
 
 	return rc;
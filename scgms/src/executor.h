@@ -37,34 +37,55 @@
 #pragma once
 
 #include <scgms/rtl/FilterLib.h>
+#include <scgms/iface/FilterExtIface.h>
 
 #include "device_event.h"
+#include "profiler.h"
+#include "replay_buffer.h"
 
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 
 
 #pragma warning( push )
 #pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
 
-class CFilter_Executor : public virtual scgms::IFilter, public virtual refcnt::CNotReferenced {
+class CFilter_Executor : public virtual scgms::IFilter, public virtual scgms::IFilter_Batch, public virtual refcnt::CNotReferenced {
 	protected:
-		std::recursive_mutex &mCommunication_Guard;
+		std::atomic<std::recursive_mutex*> mCommunication_Guard;
+		const GUID mFilter_Id;
 		scgms::SFilter mFilter;
+		refcnt::SReferenced<scgms::IFilter_Batch> mFilter_Batch;	//set, if the filter processes batches natively
 		scgms::TOn_Filter_Created mOn_Filter_Created;
 		const void* mOn_Filter_Created_Data;
+		CFilter_Profile *mProfile = nullptr;	//owned by the chain's profiler, if any
+		CLogical_Clock *mLogical_Clock = nullptr;	//owned by the chain, stamps the events the filter creates
+
+		void Observe(scgms::IDevice_Event *event) noexcept;
+
+		std::recursive_mutex& Lock_Communication_Guard();
 
 	public:
 		CFilter_Executor(const GUID filter_id, std::recursive_mutex &communication_guard, scgms::IFilter *next_filter, scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data);
 		virtual ~CFilter_Executor() = default;
 
 		void Release_Filter();
+		void Set_Communication_Guard(std::recursive_mutex &communication_guard);	//permitted while the chain is being built only
+		const GUID& Filter_Id() const noexcept { return mFilter_Id; };
+		CFilter_Profile* Profile() const noexcept { return mProfile; };
+		void Set_Profile(CFilter_Profile *profile);	//permitted while the chain is being built only
+		void Set_Logical_Clock(CLogical_Clock *clock);	//permitted while the chain is being built only
+		void Unroll_Batches();	//the filter will receive the batched events one by one, even if it can process batches natively
 
 		virtual HRESULT IfaceCalling QueryInterface(const GUID*  riid, void ** ppvObj) override;
 
 		// scgms::IFilter iface
 		virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list *error_description) override final;
 		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final;
+
+		// scgms::IFilter_Batch iface
+		virtual HRESULT IfaceCalling Execute_Batch(scgms::IDevice_Event** begin, scgms::IDevice_Event** end) override final;
 };
 
 //executer designed to consume events only and to signal the shutdown event
@@ -88,11 +109,10 @@ class CTerminal_Filter : public virtual scgms::IFilter, public virtual refcnt::C
 
 class CCopying_Terminal_Filter : public virtual CTerminal_Filter {
 	protected:
-		std::vector<CDevice_Event> &mEvents;
-		bool mDo_Not_Copy_Info_Events = true;
+		CReplay_Buffer &mEvents;	//info events are not copied
 
 	public:
-		CCopying_Terminal_Filter(std::vector<CDevice_Event> &events, bool do_not_copy_info_events);
+		CCopying_Terminal_Filter(CReplay_Buffer &events);
 		virtual ~CCopying_Terminal_Filter() = default;
 
 		// scgms::IFilter iface
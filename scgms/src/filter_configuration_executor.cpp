@@ -75,6 +75,36 @@ HRESULT IfaceCalling CFilter_Configuration_Executor::Terminate(const BOOL wait_f
 	return mComposite_Filter.Clear();
 }
 
+HRESULT IfaceCalling CFilter_Configuration_Executor::QueryInterface(const GUID*  riid, void ** ppvObj) {
+	//the chain can be inspected only if it has been profiled
+	if ((*riid == scgms::IID_Filter_Chain_Profile_Inspection) && mComposite_Filter.Profiler()) {
+		*ppvObj = static_cast<scgms::IFilter_Chain_Profile_Inspection*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	return E_NOINTERFACE;
+}
+
+HRESULT IfaceCalling CFilter_Configuration_Executor::Get_Filter_Count(size_t* count) {
+	const CChain_Profiler *profiler = mComposite_Filter.Profiler();
+	if (!profiler) {
+		return E_NOT_SET;
+	}
+
+	*count = profiler->Filter_Count();
+	return S_OK;
+}
+
+HRESULT IfaceCalling CFilter_Configuration_Executor::Get_Filter_Profile(const size_t position, scgms::TFilter_Profile* profile) {
+	const CChain_Profiler *profiler = mComposite_Filter.Profiler();
+	if (!profiler) {
+		return E_NOT_SET;
+	}
+
+	return profiler->Get_Profile(position, *profile) ? S_OK : E_INVALIDARG;
+}
+
 DLL_EXPORT HRESULT IfaceCalling execute_filter_configuration(scgms::IFilter_Chain_Configuration *configuration, scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data, scgms::IFilter *custom_output, scgms::IFilter_Executor **executor, refcnt::wstr_list *error_description) {
 	std::unique_ptr<CFilter_Configuration_Executor> raw_executor = std::make_unique<CFilter_Configuration_Executor>(custom_output);
 	//increase the reference just in a case that we would be released prematurely in the Build_Filter_Chain call
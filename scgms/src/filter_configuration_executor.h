@@ -39,6 +39,7 @@
 #include <scgms/iface/FilterIface.h>
 #include <scgms/rtl/FilterLib.h>
 #include <scgms/rtl/referencedImpl.h>
+#include <scgms/iface/FilterExtIface.h>
 
 #include "executor.h"
 #include "composite_filter.h"
@@ -47,10 +48,10 @@
 #pragma warning( push )
 #pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance 
 
-class CFilter_Configuration_Executor : public virtual scgms::IFilter_Executor, public virtual refcnt::CReferenced {
+class CFilter_Configuration_Executor : public virtual scgms::IFilter_Executor, public virtual scgms::IFilter_Chain_Profile_Inspection, public virtual refcnt::CReferenced {
 	protected:
 		std::recursive_mutex mCommunication_Guard;
-		CComposite_Filter mComposite_Filter{ mCommunication_Guard };
+		CComposite_Filter mComposite_Filter{ mCommunication_Guard, Chain_Execution_Options_From_Environment() };
 		CTerminal_Filter mTerminal_Filter{ nullptr };
 
 	public:
@@ -61,6 +62,12 @@ class CFilter_Configuration_Executor : public virtual scgms::IFilter_Executor, p
 
 		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final;
 		virtual HRESULT IfaceCalling Terminate(const BOOL wait_for_shutdown) override final;
+
+		virtual HRESULT IfaceCalling QueryInterface(const GUID*  riid, void ** ppvObj) override;
+
+		// scgms::IFilter_Chain_Profile_Inspection iface
+		virtual HRESULT IfaceCalling Get_Filter_Count(size_t* count) override final;
+		virtual HRESULT IfaceCalling Get_Filter_Profile(const size_t position, scgms::TFilter_Profile* profile) override final;
 };
 
 #pragma warning( pop )
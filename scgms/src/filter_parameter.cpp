@@ -43,6 +43,7 @@
 #include <scgms/lang/dstrings.h>
 
 #include <fstream>
+#include <cstring>
 
 const std::wstring CFilter_Parameter::mUnused_Variable_Name = rsUnused_Variable_Name;
 
@@ -54,6 +55,47 @@ double str_2_rat_dbl(const std::wstring& str, bool& converted_ok) {
 	return value;
 }
 
+namespace {
+	//distinguishes a missing container from an empty one
+	template <typename T, typename C>
+	void Write_Container(scgms::CCheckpoint_Writer &writer, C &container) {
+		std::vector<T> values;
+		T *begin, *end;
+		if (container && (container->get(&begin, &end) == S_OK)) {
+			values.assign(begin, end);
+		}
+
+		writer.Write(static_cast<bool>(container));
+		writer.Write(values);
+	}
+
+	template <typename T, typename C>
+	bool Read_Container(scgms::CCheckpoint_Reader &reader, C &container) {
+		bool present = false;
+		std::vector<T> values;
+		if (!reader.Read(present) || !reader.Read(values)) {
+			return false;
+		}
+
+		container = present ? refcnt::Create_Container_shared<T, C>(values.data(), values.data() + values.size()) : C{};
+		return !present || container;
+	}
+
+	void Write_String(scgms::CCheckpoint_Writer &writer, const std::wstring &str) {
+		writer.Write(std::vector<wchar_t>{ str.begin(), str.end() });
+	}
+
+	bool Read_String(scgms::CCheckpoint_Reader &reader, std::wstring &str) {
+		std::vector<wchar_t> chars;
+		if (!reader.Read(chars)) {
+			return false;
+		}
+
+		str.assign(chars.begin(), chars.end());
+		return true;
+	}
+}
+
 DLL_EXPORT HRESULT IfaceCalling create_filter_parameter(const scgms::NParameter_Type type, const wchar_t* config_name, scgms::IFilter_Parameter** parameter) {
 	return Manufacture_Object<CFilter_Parameter, scgms::IFilter_Parameter>(parameter, type, config_name);
 }
@@ -229,6 +271,67 @@ HRESULT IfaceCalling CFilter_Parameter::Clone(scgms::IFilter_Parameter **deep_co
 	return S_OK;
 }
 
+void CFilter_Parameter::Save_Binary(scgms::CCheckpoint_Writer &writer) {
+	Write_String(writer, mVariable_Name);
+	Write_Container<wchar_t>(writer, mWChar_Container);
+
+	writer.Write(static_cast<uint64_t>(mArray_Vars.size()));
+	for (const auto &var : mArray_Vars) {
+		Write_String(writer, var);
+	}
+	writer.Write(static_cast<uint64_t>(mFirst_Array_Var_idx));
+
+	Write_Container<int64_t>(writer, mTime_Segment_ID);
+	Write_Container<double>(writer, mModel_Parameters);
+	writer.Write(mData);
+}
+
+bool CFilter_Parameter::Load_Binary(scgms::CCheckpoint_Reader &reader) {
+	if (!Read_String(reader, mVariable_Name) || !Read_Container<wchar_t>(reader, mWChar_Container)) {
+		return false;
+	}
+
+	uint64_t count = 0;
+	if (!reader.Read(count)) {
+		return false;
+	}
+	mArray_Vars.clear();
+	for (uint64_t i = 0; i < count; i++) {
+		std::wstring var;
+		if (!Read_String(reader, var)) {
+			return false;
+		}
+		mArray_Vars.push_back(std::move(var));
+	}
+
+	uint64_t first_array_var_idx = 0;
+	if (!reader.Read(first_array_var_idx)) {
+		return false;
+	}
+	mFirst_Array_Var_idx = static_cast<size_t>(first_array_var_idx);
+
+	if (!Read_Container<int64_t>(reader, mTime_Segment_ID) || !Read_Container<double>(reader, mModel_Parameters)) {
+		return false;
+	}
+
+	decltype(mData) data;
+	if (!reader.Read(data)) {
+		return false;
+	}
+
+	//a bool with any other representation than 0 or 1 would be undefined behavior, so we refuse a corrupted one
+	if (mType == scgms::NParameter_Type::ptBool) {
+		unsigned char representation = 0;
+		std::memcpy(&representation, &data, sizeof(representation));
+		if (representation > 1) {
+			return false;
+		}
+	}
+
+	mData = data;
+	return true;
+}
+
 HRESULT IfaceCalling CFilter_Parameter::Set_Variable(const wchar_t* name, const wchar_t* value) {
 	if (name == CFilter_Parameter::mUnused_Variable_Name) {
 		return TYPE_E_AMBIGUOUSNAME;
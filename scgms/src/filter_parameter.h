@@ -37,6 +37,7 @@
 #pragma once
 
 #include <scgms/rtl/FilterLib.h>
+#include <scgms/rtl/FilterExtLib.h>
 #include <scgms/rtl/referencedImpl.h>
 #include <scgms/rtl/FilesystemLib.h>
 #include <scgms/utils/string_utils.h>
@@ -334,6 +335,14 @@ class CFilter_Parameter : public virtual scgms::IFilter_Parameter, public virtua
 		//conversion
 		HRESULT from_string(const scgms::NParameter_Type desired_type, const wchar_t* str);
 
+		//the parsed value, including the variable references, for the configuration cache
+		//the deferred parameters cannot be cached, because their content does not come from the configuration
+		bool Is_Deferred() const {
+			return !mDeferred_Path_Or_Var.empty();
+		}
+		void Save_Binary(scgms::CCheckpoint_Writer &writer);
+		bool Load_Binary(scgms::CCheckpoint_Reader &reader);
+
 		virtual HRESULT IfaceCalling Get_Type(scgms::NParameter_Type *type) override final;
 		virtual HRESULT IfaceCalling Get_Config_Name(wchar_t **config_name) override final;
 
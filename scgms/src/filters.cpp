@@ -35,12 +35,44 @@
  */
 
 #include "filters.h"
+#include "fitness_cache.h"
 
 #include <scgms/rtl/FilesystemLib.h>
 #include <scgms/utils/descriptor_utils.h>
 #include <scgms/utils/winapi_mapping.h>
 #include <scgms/lang/dstrings.h>
 
+#include <scgms/rtl/FilterExtLib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cwchar>
+#include <fstream>
+#include <thread>
+
+namespace {
+	const char* rsLazy_Libraries_Variable = "SCGMS_LAZY_LIBRARIES";
+	const wchar_t* rsDescriptor_Index_File = L"scgms-descriptor-index.bin";
+
+	constexpr uint64_t Descriptor_Index_Magic = 0x3158'4449'4353'4d47;	//'GMSCIDX1', to refuse a foreign or an outdated file
+
+	bool Read_Lazy_Libraries_Variable() {
+		size_t assumed_len = 0;
+		auto var_os_err = getenv_s(&assumed_len, nullptr, 0, rsLazy_Libraries_Variable);
+		if ((var_os_err == 0) && (assumed_len > 0)) {
+			std::vector<char> var_buf(assumed_len);
+			var_os_err = getenv_s(&assumed_len, var_buf.data(), assumed_len, rsLazy_Libraries_Variable);
+			if (var_os_err == 0) {
+				var_buf.push_back(0);	//make sure its ASCIIZ
+				return (var_buf[0] != 0) && (std::strcmp(var_buf.data(), "0") != 0);
+			}
+		}
+
+		return false;
+	}
+}
+
 namespace imported {
 	const char* rsGet_Filter_Descriptors = "do_get_filter_descriptors";
 	const char* rsGet_Metric_Descriptors = "do_get_metric_descriptors";
@@ -111,6 +143,15 @@ DLL_EXPORT HRESULT IfaceCalling create_approximator(const GUID *approx_id, scgms
 	return loaded_filters.create_approximator_body(approx_id, signal, approx);
 }
 
+DLL_EXPORT HRESULT IfaceCalling get_library_dispatch_statistics(TLibrary_Dispatch_Statistics* statistics) noexcept {
+	if (!statistics) {
+		return E_INVALIDARG;
+	}
+
+	loaded_filters.Get_Dispatch_Statistics(*statistics);
+	return S_OK;
+}
+
 void CLoaded_Filters::load_libraries() {
 #ifndef ANDROID
 	const auto filters_dir = Get_Dll_Dir() / std::wstring{rsSolversDir};
@@ -120,41 +161,255 @@ void CLoaded_Filters::load_libraries() {
 
 	// filters directory must exist and must be a directory
 	if (!filesystem::exists(filters_dir) || !filesystem::is_directory(filters_dir)) {
+		mAll_Loaded = true;
 		return;
 	}
 
+	const bool lazy = Read_Lazy_Libraries_Variable();
+	const filesystem::path index_path = filters_dir / rsDescriptor_Index_File;
+	std::map<filesystem::path, TIndexed_Library> index;
+	if (lazy) {
+		Read_Descriptor_Index(index_path, index);
+	}
+
+	bool index_outdated = false;
+	std::map<filesystem::path, TIndexed_Library> unused_libraries;	//not to load them again and again
+
 	for (const auto& dir_entry : filesystem::directory_iterator(filters_dir)) {
 		const auto &filepath = dir_entry.path();
 
 		// just checks the platform-dependent extension to filter out unwanted 
 		if (CDynamic_Library::Is_Library(filepath)) {
-			imported::TLibraryInfo lib;
-
-			if (lib.library.Load(filepath)) {
-				bool lib_used = Resolve_Func<scgms::TCreate_Filter>(lib.create_filter, lib.library, imported::rsDo_Create_Filter);
-				
-				lib_used |= Resolve_Func<scgms::TCreate_Metric>(lib.create_metric, lib.library, imported::rsDo_Create_Metric);
-				lib_used |= Resolve_Func<scgms::TCreate_Signal>(lib.create_signal, lib.library, imported::rsDo_Create_Signal);
-				lib_used |= Resolve_Func<scgms::TCreate_Discrete_Model>(lib.create_discrete_model, lib.library, imported::rsDo_Create_Discrete_model);
-				lib_used |= Resolve_Func<scgms::TCreate_Approximator>(lib.create_approximator, lib.library, imported::rsDo_Create_Approximator);
-				lib_used |= Resolve_Func<solver::TGeneric_Solver>(lib.solve_generic, lib.library, imported::rsDo_Solve_Generic);
-
-				lib_used |= Load_Descriptors<scgms::TGet_Filter_Descriptors, scgms::TFilter_Descriptor>(mFilter_Descriptors, lib.library, imported::rsGet_Filter_Descriptors);
-				lib_used |= Load_Descriptors<scgms::TGet_Metric_Descriptors, scgms::TMetric_Descriptor>(mMetric_Descriptors, lib.library, imported::rsGet_Metric_Descriptors);
-				lib_used |= Load_Descriptors<scgms::TGet_Model_Descriptors, scgms::TModel_Descriptor>(mModel_Descriptors, lib.library, imported::rsGet_Model_Descriptors);
-				lib_used |= Load_Descriptors<scgms::TGet_Solver_Descriptors, scgms::TSolver_Descriptor>(mSolver_Descriptors, lib.library, imported::rsGet_Solvers_Descriptors);
-				lib_used |= Load_Descriptors<scgms::TGet_Approx_Descriptors, scgms::TApprox_Descriptor>(mApprox_Descriptors, lib.library, imported::rsGet_Approx_Descriptors);
-				lib_used |= Load_Descriptors<scgms::TGet_Signal_Descriptors, scgms::TSignal_Descriptor>(mSignal_Descriptors, lib.library, imported::rsGet_Signal_Descriptors);
-
-				if (lib_used) {
-					mLibraries.push_back(std::move(lib));
+			auto lib = std::make_unique<imported::TLibraryInfo>();
+			lib->path = filepath;
+
+			std::error_code ec;
+			lib->file_size = static_cast<uint64_t>(filesystem::file_size(filepath, ec));
+			lib->file_time = static_cast<int64_t>(filesystem::last_write_time(filepath, ec).time_since_epoch().count());
+
+			if (lazy) {
+				const auto indexed = index.find(filepath.filename());
+				if ((indexed != index.end()) && (indexed->second.file_size == lib->file_size) && (indexed->second.file_time == lib->file_time)) {
+					if (indexed->second.used) {
+						lib->provided_ids = indexed->second.provided_ids;
+						mLibraries.push_back(std::move(lib));
+					}
+					else {
+						unused_libraries[filepath.filename()] = indexed->second;
+					}
+
+					index.erase(indexed);
+					continue;
 				}
-				else {
-					lib.library.Unload();
+
+				index_outdated = true;
+			}
+
+			if (Load_Library(*lib)) {
+				mLibraries.push_back(std::move(lib));
+			}
+			else {
+				unused_libraries[filepath.filename()] = TIndexed_Library{ lib->file_size, lib->file_time, false, {} };
+			}
+		}
+	}
+
+	if (lazy) {
+		if (index_outdated || !index.empty()) {	//a library has changed, has been added or removed
+			Write_Descriptor_Index(index_path, unused_libraries);
+		}
+	}
+	else {
+		Load_All();
+	}
+}
+
+bool CLoaded_Filters::Load_Library(imported::TLibraryInfo &lib) {
+	if (!lib.library.Load(lib.path)) {
+		return false;
+	}
+
+	bool lib_used = Resolve_Func<scgms::TCreate_Filter>(lib.create_filter, lib.library, imported::rsDo_Create_Filter);
+
+	lib_used |= Resolve_Func<scgms::TCreate_Metric>(lib.create_metric, lib.library, imported::rsDo_Create_Metric);
+	lib_used |= Resolve_Func<scgms::TCreate_Signal>(lib.create_signal, lib.library, imported::rsDo_Create_Signal);
+	lib_used |= Resolve_Func<scgms::TCreate_Discrete_Model>(lib.create_discrete_model, lib.library, imported::rsDo_Create_Discrete_model);
+	lib_used |= Resolve_Func<scgms::TCreate_Approximator>(lib.create_approximator, lib.library, imported::rsDo_Create_Approximator);
+	lib_used |= Resolve_Func<solver::TGeneric_Solver>(lib.solve_generic, lib.library, imported::rsDo_Solve_Generic);
+
+	lib_used |= Load_Descriptors<scgms::TGet_Filter_Descriptors, scgms::TFilter_Descriptor>(lib.filter_descriptors, lib.library, imported::rsGet_Filter_Descriptors);
+	lib_used |= Load_Descriptors<scgms::TGet_Metric_Descriptors, scgms::TMetric_Descriptor>(lib.metric_descriptors, lib.library, imported::rsGet_Metric_Descriptors);
+	lib_used |= Load_Descriptors<scgms::TGet_Model_Descriptors, scgms::TModel_Descriptor>(lib.model_descriptors, lib.library, imported::rsGet_Model_Descriptors);
+	lib_used |= Load_Descriptors<scgms::TGet_Solver_Descriptors, scgms::TSolver_Descriptor>(lib.solver_descriptors, lib.library, imported::rsGet_Solvers_Descriptors);
+	lib_used |= Load_Descriptors<scgms::TGet_Approx_Descriptors, scgms::TApprox_Descriptor>(lib.approx_descriptors, lib.library, imported::rsGet_Approx_Descriptors);
+	lib_used |= Load_Descriptors<scgms::TGet_Signal_Descriptors, scgms::TSignal_Descriptor>(lib.signal_descriptors, lib.library, imported::rsGet_Signal_Descriptors);
+
+	if (!lib_used) {
+		lib.library.Unload();
+		return false;
+	}
+
+	lib.provided_ids = Provided_Ids(lib);
+	{
+		std::unique_lock<std::shared_mutex> lock{ mProviders_Guard };
+		for (const auto &id : lib.provided_ids) {
+			auto &providers = mProviders[id];
+			if (std::find(providers.begin(), providers.end(), &lib) == providers.end()) {
+				providers.push_back(&lib);
+			}
+		}
+	}
+
+	lib.loaded.store(true, std::memory_order_release);
+	return true;
+}
+
+std::vector<GUID> CLoaded_Filters::Provided_Ids(const imported::TLibraryInfo &lib) const {
+	std::vector<GUID> ids;
+	for (const auto &desc : lib.filter_descriptors) {
+		ids.push_back(desc.id);
+	}
+	for (const auto &desc : lib.metric_descriptors) {
+		ids.push_back(desc.id);
+	}
+	for (const auto &desc : lib.model_descriptors) {
+		ids.push_back(desc.id);
+		ids.insert(ids.end(), desc.calculated_signal_ids, desc.calculated_signal_ids + desc.number_of_calculated_signals);
+	}
+	for (const auto &desc : lib.solver_descriptors) {
+		ids.push_back(desc.id);
+	}
+	for (const auto &desc : lib.approx_descriptors) {
+		ids.push_back(desc.id);
+	}
+	for (const auto &desc : lib.signal_descriptors) {
+		ids.push_back(desc.id);
+	}
+
+	return ids;
+}
+
+void CLoaded_Filters::Load_Providers(const GUID &id) {
+	if (mAll_Loaded) {
+		return;
+	}
+
+	bool known = false;
+	{
+		std::lock_guard<std::mutex> lock{ mLoad_Guard };
+		for (auto &lib : mLibraries) {
+			if (std::find(lib->provided_ids.begin(), lib->provided_ids.end(), id) != lib->provided_ids.end()) {
+				known = true;
+				if (!lib->loaded) {
+					Load_Library(*lib);
 				}
 			}
 		}
 	}
+
+	if (!known) {
+		Load_All();
+	}
+}
+
+void CLoaded_Filters::Load_All() {
+	if (mAll_Loaded) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock{ mLoad_Guard };
+	if (mAll_Loaded) {
+		return;	//another thread has been faster
+	}
+
+	//the merged descriptors are filled just once, as the callers keep the pointers to them
+	for (auto &lib : mLibraries) {
+		if (lib->loaded || Load_Library(*lib)) {
+			std::copy(lib->filter_descriptors.begin(), lib->filter_descriptors.end(), std::back_inserter(mFilter_Descriptors));
+			std::copy(lib->metric_descriptors.begin(), lib->metric_descriptors.end(), std::back_inserter(mMetric_Descriptors));
+			std::copy(lib->model_descriptors.begin(), lib->model_descriptors.end(), std::back_inserter(mModel_Descriptors));
+			std::copy(lib->solver_descriptors.begin(), lib->solver_descriptors.end(), std::back_inserter(mSolver_Descriptors));
+			std::copy(lib->approx_descriptors.begin(), lib->approx_descriptors.end(), std::back_inserter(mApprox_Descriptors));
+			std::copy(lib->signal_descriptors.begin(), lib->signal_descriptors.end(), std::back_inserter(mSignal_Descriptors));
+		}
+	}
+
+	mAll_Loaded = true;
+}
+
+bool CLoaded_Filters::Read_Descriptor_Index(const filesystem::path &index_path, std::map<filesystem::path, TIndexed_Library> &index) {
+	std::ifstream index_file{ index_path, std::ifstream::binary };
+	if (!index_file.is_open()) {
+		return false;
+	}
+
+	std::vector<char> buf{ std::istreambuf_iterator<char>(index_file), std::istreambuf_iterator<char>() };
+	auto container = refcnt::Create_Container_shared<char>(buf.data(), buf.data() + buf.size());
+	scgms::CCheckpoint_Reader reader{ container.get() };
+
+	uint64_t magic = 0, count = 0;
+	if (!reader.Read(magic) || (magic != Descriptor_Index_Magic) || !reader.Read(count)) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < count; i++) {
+		std::vector<wchar_t> file_name;
+		TIndexed_Library indexed;
+		if (!reader.Read(file_name) || !reader.Read(indexed.file_size) || !reader.Read(indexed.file_time) || !reader.Read(indexed.used) || !reader.Read(indexed.provided_ids)) {
+			index.clear();
+			return false;
+		}
+
+		index[std::wstring{ file_name.begin(), file_name.end() }] = std::move(indexed);
+	}
+
+	return reader.Finished();
+}
+
+void CLoaded_Filters::Write_Descriptor_Index(const filesystem::path &index_path, const std::map<filesystem::path, TIndexed_Library> &unused_libraries) {
+	scgms::CCheckpoint_Writer writer;
+	writer.Write(Descriptor_Index_Magic);
+	writer.Write(static_cast<uint64_t>(mLibraries.size() + unused_libraries.size()));
+
+	auto write_library = [&writer](const filesystem::path &file_name, const TIndexed_Library &indexed) {
+		const std::wstring name = file_name.wstring();
+		writer.Write(std::vector<wchar_t>{ name.begin(), name.end() });
+		writer.Write(indexed.file_size);
+		writer.Write(indexed.file_time);
+		writer.Write(indexed.used);
+		writer.Write(indexed.provided_ids);
+	};
+
+	for (const auto &lib : mLibraries) {
+		write_library(lib->path.filename(), TIndexed_Library{ lib->file_size, lib->file_time, true, lib->provided_ids });
+	}
+
+	for (const auto &[file_name, indexed] : unused_libraries) {
+		write_library(file_name, indexed);
+	}
+
+	auto container = refcnt::Create_Container_shared<char>(nullptr, nullptr);
+	char *begin, *end;
+	if ((writer.Store(container.get()) != S_OK) || (container->get(&begin, &end) != S_OK)) {
+		return;
+	}
+
+	//more processes may start at once, so we write a private file first, and then rename it; the directory may be read-only though
+	filesystem::path temporary_path = index_path;
+	temporary_path += L"." + std::to_wstring(std::hash<std::thread::id>{}(std::this_thread::get_id()) ^ static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+	{
+		std::ofstream index_file{ temporary_path, std::ofstream::binary };
+		if (!index_file.is_open()) {
+			return;
+		}
+		index_file.write(begin, std::distance(begin, end));
+	}
+
+	std::error_code ec;
+	filesystem::rename(temporary_path, index_path, ec);
+	if (ec) {
+		filesystem::remove(temporary_path, ec);
+	}
 }
 
 
@@ -163,55 +418,92 @@ HRESULT CLoaded_Filters::create_filter_body(const GUID *id, scgms::IFilter *next
 		return E_INVALIDARG;
 	}
 	auto call_create_filter = [](const imported::TLibraryInfo &info) { return info.create_filter; }; 
-	return Call_Func(call_create_filter, id, next_filter, filter);
+	return Call_Func_For(*id, call_create_filter, id, next_filter, filter);
 }
 
 HRESULT CLoaded_Filters::create_metric_body(const scgms::TMetric_Parameters *parameters, scgms::IMetric **metric) {
 	auto call_create_metric = [](const imported::TLibraryInfo &info) { return info.create_metric; }; 
-	return Call_Func(call_create_metric, parameters, metric);
+	if (!parameters) {
+		Load_All();
+		return Call_Func(call_create_metric, parameters, metric);
+	}
+	return Call_Func_For(parameters->metric_id, call_create_metric, parameters, metric);
 }
 
 HRESULT CLoaded_Filters::create_signal_body(const GUID *calc_id, scgms::ITime_Segment *segment, const GUID* approx_id, scgms::ISignal **signal) {
 	auto call_create_signal = [](const imported::TLibraryInfo &info) { return info.create_signal; };
-	return Call_Func(call_create_signal, calc_id, segment, approx_id, signal);
+	if (!calc_id) {
+		Load_All();
+		return Call_Func(call_create_signal, calc_id, segment, approx_id, signal);
+	}
+	return Call_Func_For(*calc_id, call_create_signal, calc_id, segment, approx_id, signal);
 }
 
 HRESULT CLoaded_Filters::create_discrete_model_body(const GUID *model_id, scgms::IModel_Parameter_Vector *parameters, scgms::IFilter *output, scgms::IDiscrete_Model **model) {
 	auto call_create_discrete_model = [](const imported::TLibraryInfo &info) { return info.create_discrete_model; };
-	return Call_Func(call_create_discrete_model, model_id, parameters, output, model);
+	if (!model_id) {
+		Load_All();
+		return Call_Func(call_create_discrete_model, model_id, parameters, output, model);
+	}
+	return Call_Func_For(*model_id, call_create_discrete_model, model_id, parameters, output, model);
 }
 
 HRESULT CLoaded_Filters::solve_generic_body(const GUID *solver_id, const solver::TSolver_Setup *setup, solver::TSolver_Progress *progress) {
 	auto call_solve_filter = [](const imported::TLibraryInfo &info) { return info.solve_generic; };
-	return Call_Func(call_solve_filter, solver_id, setup, progress);
+	auto solve = [this, &call_solve_filter, solver_id, progress](const solver::TSolver_Setup *solver_setup) {
+		if (!solver_id) {
+			Load_All();
+			return Call_Func(call_solve_filter, solver_id, solver_setup, progress);
+		}
+		return Call_Func_For(*solver_id, call_solve_filter, solver_id, solver_setup, progress);
+	};
+
+	if (!setup || !setup->objective) {
+		return solve(setup);
+	}
+
+	//the solvers may re-evaluate bit-equal solutions, which can be pretty expensive with e.g.; the filter chains
+	CFitness_Cache cache{ *setup };
+	const solver::TSolver_Setup cached_setup = cache.Cached_Setup();
+	return solve(&cached_setup);
 }
 
 HRESULT CLoaded_Filters::create_approximator_body(const GUID *approx_id, scgms::ISignal *signal, scgms::IApproximator **approx) {
 	auto call_create_approx = [](const imported::TLibraryInfo &info) { return info.create_approximator; };
-	return Call_Func(call_create_approx, approx_id, signal, approx);
+	if (!approx_id) {
+		Load_All();
+		return Call_Func(call_create_approx, approx_id, signal, approx);
+	}
+	return Call_Func_For(*approx_id, call_create_approx, approx_id, signal, approx);
 }
 
 HRESULT CLoaded_Filters::get_filter_descriptors_body(scgms::TFilter_Descriptor **begin, scgms::TFilter_Descriptor **end) {
+	Load_All();
 	return do_get_descriptors<scgms::TFilter_Descriptor>(mFilter_Descriptors, begin, end);
 }
 
 HRESULT CLoaded_Filters::get_metric_descriptors_body(scgms::TMetric_Descriptor **begin, scgms::TMetric_Descriptor **end) {
+	Load_All();
 	return do_get_descriptors<scgms::TMetric_Descriptor>(mMetric_Descriptors, begin, end);
 }
 
 HRESULT CLoaded_Filters::get_model_descriptors_body(scgms::TModel_Descriptor **begin, scgms::TModel_Descriptor **end) {
+	Load_All();
 	return do_get_descriptors<scgms::TModel_Descriptor>(mModel_Descriptors, begin, end);
 }
 
 HRESULT CLoaded_Filters::get_solver_descriptors_body(scgms::TSolver_Descriptor **begin, scgms::TSolver_Descriptor **end) {
+	Load_All();
 	return do_get_descriptors<scgms::TSolver_Descriptor>(mSolver_Descriptors, begin, end);
 }
 
 HRESULT CLoaded_Filters::get_approx_descriptors_body(scgms::TApprox_Descriptor **begin, scgms::TApprox_Descriptor **end) {
+	Load_All();
 	return do_get_descriptors<scgms::TApprox_Descriptor>(mApprox_Descriptors, begin, end);
 }
 
 HRESULT CLoaded_Filters::get_signal_descriptors_body(scgms::TSignal_Descriptor** begin, scgms::TSignal_Descriptor** end) {
+	Load_All();
 	return do_get_descriptors<scgms::TSignal_Descriptor>(mSignal_Descriptors, begin, end);
 }
 
@@ -225,7 +517,7 @@ void CLoaded_Filters::describe_loaded_filters(refcnt::Swstr_list error_descripti
 
 	if (!mLibraries.empty()) {
 		for (auto& lib : mLibraries) {
-			error_description.push(lib.library.Lib_Path().wstring());
+			error_description.push(lib->path.wstring());
 		}
 	}
 	else {
@@ -235,6 +527,7 @@ void CLoaded_Filters::describe_loaded_filters(refcnt::Swstr_list error_descripti
 
 GUID CLoaded_Filters::Resolve_Signal_By_Name(const wchar_t* name, bool& valid) {
 	valid = false;
+	Load_All();	//the index does not know the signal names
 	const std::wstring cname{ name };
 	for (const auto& elem : mSignal_Descriptors) {
 		if (cname.compare(elem.signal_description) == 0) {
@@ -254,6 +547,57 @@ GUID CLoaded_Filters::Resolve_Signal_By_Name(const wchar_t* name, bool& valid) {
 	return Invalid_GUID;
 }
 
+size_t TGUID_Hash::operator()(const GUID &id) const noexcept {
+	uint64_t low, high;
+	static_assert(sizeof(GUID) == sizeof(low) + sizeof(high), "GUID is expected to have 16 bytes");
+	std::memcpy(&low, &id, sizeof(low));
+	std::memcpy(&high, reinterpret_cast<const char*>(&id) + sizeof(low), sizeof(high));
+	return static_cast<size_t>(low ^ (high * 0x9E3779B97F4A7C15ull));
+}
+
+void CLoaded_Filters::Get_Dispatch_Statistics(TLibrary_Dispatch_Statistics &statistics) const noexcept {
+	statistics.creation_calls = mCreation_Calls;
+	statistics.dispatched_calls = mDispatched_Calls;
+	statistics.fallback_calls = mFallback_Calls;
+}
+
+bool CLoaded_Filters::Get_Filter_Descriptor(const GUID &id, scgms::TFilter_Descriptor &desc) {
+	Load_Providers(id);
+
+	for (const auto &lib : mLibraries) {
+		if (lib->loaded.load(std::memory_order_acquire)) {
+			const auto iter = std::find_if(lib->filter_descriptors.begin(), lib->filter_descriptors.end(), [&id](const scgms::TFilter_Descriptor &candidate) { return candidate.id == id; });
+			if (iter != lib->filter_descriptors.end()) {
+				desc = *iter;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+uint64_t CLoaded_Filters::Fingerprint() const {
+	//the libraries' files, so that we do not need to load them; a rebuilt library may have changed its descriptors
+	uint64_t hash = 14695981039346656037ull;	//FNV-1a
+	auto hash_bytes = [&hash](const void* data, const size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	};
+
+	for (const auto &lib : mLibraries) {
+		const std::wstring path = lib->path.wstring();
+		hash_bytes(path.data(), path.size() * sizeof(wchar_t));
+		hash_bytes(&lib->file_size, sizeof(lib->file_size));
+		hash_bytes(&lib->file_time, sizeof(lib->file_time));
+	}
+
+	return hash;
+}
+
 scgms::SFilter create_filter_body(const GUID &id, scgms::IFilter *next_filter) {
 	scgms::SFilter result;
 	scgms::IFilter *filter;
@@ -272,3 +616,12 @@ void describe_loaded_filters(refcnt::Swstr_list error_description) {
 GUID resolve_signal_by_name(const wchar_t* name, bool& valid) {
 	return loaded_filters.Resolve_Signal_By_Name(name, valid);
 }
+
+bool get_filter_descriptor_by_id_body(const GUID &id, scgms::TFilter_Descriptor &desc) {
+	return loaded_filters.Get_Filter_Descriptor(id, desc);
+}
+
+uint64_t loaded_filters_fingerprint() {
+	static const uint64_t fingerprint = loaded_filters.Fingerprint();	//the libraries are loaded just once
+	return fingerprint;
+}
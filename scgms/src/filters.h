@@ -41,10 +41,32 @@
 #include <scgms/iface/ApproxIface.h>
 #include <scgms/rtl/Dynamic_Library.h>
 #include <scgms/rtl/FilterLib.h>
+#include <scgms/rtl/FilesystemLib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace imported {
 	struct TLibraryInfo {
 		CDynamic_Library library{};
+		filesystem::path path;
+		uint64_t file_size = 0;
+		int64_t file_time = 0;				//to tell, whether the index is up to date
+		std::atomic<bool> loaded{ false };	//once set, the entry points and the descriptors do not change anymore
+		std::vector<GUID> provided_ids;		//from the descriptor index, so that we know when to load the library
+
+		std::vector<scgms::TFilter_Descriptor> filter_descriptors;
+		std::vector<scgms::TMetric_Descriptor> metric_descriptors;
+		std::vector<scgms::TModel_Descriptor> model_descriptors;
+		std::vector<scgms::TSolver_Descriptor> solver_descriptors;
+		std::vector<scgms::TApprox_Descriptor> approx_descriptors;
+		std::vector<scgms::TSignal_Descriptor> signal_descriptors;
+
 		scgms::TCreate_Filter create_filter = nullptr;
 		scgms::TCreate_Metric create_metric = nullptr;
 		scgms::TCreate_Signal create_signal = nullptr;
@@ -54,6 +76,16 @@ namespace imported {
 	};
 }
 
+struct TLibrary_Dispatch_Statistics {
+	size_t creation_calls;		//of filters, metrics, signals, discrete models and approximators
+	size_t dispatched_calls;	//succeeded by calling just the library, which provides the GUID
+	size_t fallback_calls;		//had to try all the libraries
+};
+
+struct TGUID_Hash {
+	size_t operator()(const GUID &id) const noexcept;
+};
+
 class CLoaded_Filters {
 	protected:
 		std::vector<scgms::TFilter_Descriptor> mFilter_Descriptors;
@@ -63,7 +95,17 @@ class CLoaded_Filters {
 		std::vector<scgms::TApprox_Descriptor> mApprox_Descriptors;
 		std::vector<scgms::TSignal_Descriptor> mSignal_Descriptors;
 
-		std::vector<imported::TLibraryInfo> mLibraries;
+		//with SCGMS_LAZY_LIBRARIES set, the libraries are loaded, once a GUID they provide is needed, or once all the descriptors are
+		//the GUIDs are known from an index file in the filters directory, which is updated whenever a library changes
+		std::vector<std::unique_ptr<imported::TLibraryInfo>> mLibraries;	//does not change after the construction
+		std::mutex mLoad_Guard;
+		std::atomic<bool> mAll_Loaded{ false };	//and the merged descriptors above are filled
+
+		//libraries, which provide the GUID, in the order they have been loaded; immutable, once all the libraries are loaded
+		std::unordered_map<GUID, std::vector<imported::TLibraryInfo*>, TGUID_Hash> mProviders;
+		std::shared_mutex mProviders_Guard;
+
+		std::atomic<size_t> mCreation_Calls{ 0 }, mDispatched_Calls{ 0 }, mFallback_Calls{ 0 };
 
 	protected:
 		template <typename TDesc_Func, typename TDesc_Item>
@@ -92,10 +134,24 @@ class CLoaded_Filters {
 
 		template <typename functype, typename... Args>
 		HRESULT Call_Func(functype funcegetter, Args... args) const {
+			return Call_Func_Except({}, funcegetter, args...);
+		}
+
+		//calls the function of the loaded libraries, but the already tried ones
+		template <typename functype, typename... Args>
+		HRESULT Call_Func_Except(const std::vector<imported::TLibraryInfo*> &tried, functype funcegetter, Args... args) const {
 			HRESULT rc = E_NOTIMPL;	//not found
 
 			for (const auto &iter : mLibraries) {
-				auto funcptr = funcegetter(iter);
+				if (!iter->loaded.load(std::memory_order_acquire)) {
+					continue;
+				}
+
+				if (std::find(tried.begin(), tried.end(), iter.get()) != tried.end()) {
+					continue;
+				}
+
+				auto funcptr = funcegetter(*iter);
 				if (funcptr != nullptr) {
 					HRESULT local_rc = (funcptr)(args...);
 					if (local_rc == S_OK) {
@@ -113,7 +169,78 @@ class CLoaded_Filters {
 			return rc;
 		}
 
+		//calls the function of the libraries, which provide the id, or of all the libraries, if none of them implements it
+		template <typename functype, typename... Args>
+		HRESULT Call_Func_For(const GUID &id, functype funcegetter, Args... args) {
+			mCreation_Calls++;
+			Load_Providers(id);
+
+			//copy the providers, unless the map cannot change anymore, as the called function may get here recursively
+			const std::vector<imported::TLibraryInfo*>* providers = nullptr;
+			std::vector<imported::TLibraryInfo*> providers_copy;
+			if (mAll_Loaded.load(std::memory_order_acquire)) {
+				const auto iter = mProviders.find(id);
+				if (iter != mProviders.end()) {
+					providers = &iter->second;
+				}
+			}
+			else {
+				std::shared_lock<std::shared_mutex> lock{ mProviders_Guard };
+				const auto iter = mProviders.find(id);
+				if (iter != mProviders.end()) {
+					providers_copy = iter->second;
+					providers = &providers_copy;
+				}
+			}
+
+			HRESULT provider_rc = E_NOTIMPL;
+			std::vector<imported::TLibraryInfo*> tried;
+			if (providers) {
+				for (auto provider : *providers) {
+					tried.push_back(provider);
+
+					auto funcptr = funcegetter(*provider);
+					if (funcptr != nullptr) {
+						const HRESULT local_rc = (funcptr)(args...);
+						if (local_rc == S_OK) {
+							mDispatched_Calls++;
+							return S_OK;
+						}
+
+						if (local_rc != E_NOTIMPL) {
+							provider_rc = local_rc;
+						}
+					}
+				}
+			}
+
+			//e.g., an object, which its library does not describe, or another library may succeed, where the describing one failed - as with Call_Func
+			mFallback_Calls++;
+			HRESULT rc = Call_Func_Except(tried, funcegetter, args...);
+			if ((rc == E_NOTIMPL) && !mAll_Loaded) {
+				//e.g., a signal of a model, which is not listed by the index
+				Load_All();
+				rc = Call_Func_Except(tried, funcegetter, args...);
+			}
+
+			//no need to replace the meaningful rc of the library, which has recognized the GUID, with E_NOTIMPL
+			return ((rc == E_NOTIMPL) && (provider_rc != E_NOTIMPL)) ? provider_rc : rc;
+		}
+
 		void load_libraries();
+		bool Load_Library(imported::TLibraryInfo &lib);
+		void Load_Providers(const GUID &id);
+		void Load_All();
+		std::vector<GUID> Provided_Ids(const imported::TLibraryInfo &lib) const;
+
+		struct TIndexed_Library {
+			uint64_t file_size;
+			int64_t file_time;
+			bool used;		//false, if the library does not export any SmartCGMS entry point
+			std::vector<GUID> provided_ids;
+		};
+		bool Read_Descriptor_Index(const filesystem::path &index_path, std::map<filesystem::path, TIndexed_Library> &index);
+		void Write_Descriptor_Index(const filesystem::path &index_path, const std::map<filesystem::path, TIndexed_Library> &unused_libraries);
 	public:
 		CLoaded_Filters();
 
@@ -134,10 +261,16 @@ class CLoaded_Filters {
 	
 		void describe_loaded_filters(refcnt::Swstr_list error_description);
 		GUID Resolve_Signal_By_Name(const wchar_t* name, bool& valid);
+		bool Get_Filter_Descriptor(const GUID &id, scgms::TFilter_Descriptor &desc);	//loads just the library, which provides the filter
+		uint64_t Fingerprint() const;
+		void Get_Dispatch_Statistics(TLibrary_Dispatch_Statistics &statistics) const noexcept;
 };
 
 DLL_EXPORT HRESULT IfaceCalling solve_generic(const GUID * solver_id, const solver::TSolver_Setup * setup, solver::TSolver_Progress * progress);
+DLL_EXPORT HRESULT IfaceCalling get_library_dispatch_statistics(TLibrary_Dispatch_Statistics* statistics) noexcept;
 
 scgms::SFilter create_filter_body(const GUID &id, scgms::IFilter *next_filter);
 void describe_loaded_filters(refcnt::Swstr_list error_description);
 GUID resolve_signal_by_name(const wchar_t* name, bool& valid);
+uint64_t loaded_filters_fingerprint();	//changes, if the configuration could load differently, e.g.; because a filter library has been added or rebuilt
+bool get_filter_descriptor_by_id_body(const GUID &id, scgms::TFilter_Descriptor &desc);	//unlike the scgms::get_filter_descriptor_by_id, does not need all the libraries loaded
@@ -0,0 +1,197 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#include "fitness_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace {
+	//summed over all the caches, so that they can be watched while solving
+	std::atomic<size_t> total_hits{ 0 }, total_misses{ 0 }, total_evictions{ 0 };
+}
+
+CFitness_Cache::CFitness_Cache(const solver::TSolver_Setup &setup) :
+	mSetup(setup),
+	mShard_Capacity(std::max<size_t>(1, Memory_Budget / (Shard_Count * (setup.problem_size * sizeof(double) + sizeof(solver::TFitness) + 4 * sizeof(size_t))))) {
+}
+
+uint64_t CFitness_Cache::Hash(const double* solution) const noexcept {
+	//FNV-1a over the bits of the solution, so that bit-equal solutions get the same hash
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < mSetup.problem_size; i++) {
+		uint64_t bits;
+		std::memcpy(&bits, &solution[i], sizeof(bits));
+		for (size_t j = 0; j < sizeof(bits); j++) {
+			hash ^= (bits >> (j * 8)) & 0xFF;
+			hash *= 1099511628211ull;
+		}
+	}
+
+	return hash;
+}
+
+bool CFitness_Cache::Lookup(const uint64_t hash, const double* solution, solver::TFitness &fitness) {
+	TShard &shard = mShards[hash & (Shard_Count - 1)];
+	std::lock_guard<std::mutex> lock{ shard.guard };
+
+	const auto iter = shard.index.find(hash);
+	if (iter == shard.index.end()) {
+		return false;
+	}
+
+	for (const size_t entry : iter->second) {
+		if (std::memcmp(&shard.solutions[entry * mSetup.problem_size], solution, mSetup.problem_size * sizeof(double)) == 0) {
+			fitness = shard.fitnesses[entry];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void CFitness_Cache::Insert(const uint64_t hash, const double* solution, const solver::TFitness &fitness) {
+	TShard &shard = mShards[hash & (Shard_Count - 1)];
+	std::lock_guard<std::mutex> lock{ shard.guard };
+
+	auto &entries = shard.index[hash];
+	for (const size_t entry : entries) {
+		if (std::memcmp(&shard.solutions[entry * mSetup.problem_size], solution, mSetup.problem_size * sizeof(double)) == 0) {
+			return;	//another thread has evaluated the same solution meanwhile
+		}
+	}
+
+	size_t entry = shard.fitnesses.size();
+	if (entry < mShard_Capacity) {
+		shard.solutions.resize(shard.solutions.size() + mSetup.problem_size);
+		shard.fitnesses.push_back(fitness);
+	}
+	else {
+		//reuse the oldest entry
+		entry = shard.age.front();
+		shard.age.pop_front();
+
+		const uint64_t evicted_hash = Hash(&shard.solutions[entry * mSetup.problem_size]);
+		auto &evicted_entries = evicted_hash == hash ? entries : shard.index[evicted_hash];
+		evicted_entries.erase(std::find(evicted_entries.begin(), evicted_entries.end(), entry));
+		if (evicted_entries.empty() && (evicted_hash != hash)) {
+			shard.index.erase(evicted_hash);
+		}
+
+		shard.fitnesses[entry] = fitness;
+		total_evictions++;
+	}
+
+	std::copy(solution, solution + mSetup.problem_size, shard.solutions.begin() + entry * mSetup.problem_size);
+	entries.push_back(entry);
+	shard.age.push_back(entry);
+}
+
+BOOL CFitness_Cache::Evaluate(const size_t solution_count, const double* solutions, double* const fitnesses) {
+	solver::TFitness* const fitness_array = reinterpret_cast<solver::TFitness*>(fitnesses);
+
+	std::vector<uint64_t> hashes(solution_count);
+	std::vector<size_t> missed;
+	for (size_t i = 0; i < solution_count; i++) {
+		hashes[i] = Hash(solutions + i * mSetup.problem_size);
+		if (!Lookup(hashes[i], solutions + i * mSetup.problem_size, fitness_array[i])) {
+			missed.push_back(i);
+		}
+	}
+
+	total_hits += solution_count - missed.size();
+	total_misses += missed.size();
+
+	if (missed.empty()) {
+		return TRUE;
+	}
+
+	if (missed.size() == solution_count) {
+		//no need to copy anything
+		if (mSetup.objective(mSetup.data, solution_count, solutions, fitnesses) != TRUE) {
+			return FALSE;
+		}
+
+		for (size_t i = 0; i < solution_count; i++) {
+			Insert(hashes[i], solutions + i * mSetup.problem_size, fitness_array[i]);
+		}
+
+		return TRUE;
+	}
+
+	//evaluate just the missed solutions, yet still as a single batch to keep the objective's parallelism
+	std::vector<double> missed_solutions(missed.size() * mSetup.problem_size);
+	for (size_t i = 0; i < missed.size(); i++) {
+		const double* solution = solutions + missed[i] * mSetup.problem_size;
+		std::copy(solution, solution + mSetup.problem_size, missed_solutions.begin() + i * mSetup.problem_size);
+	}
+
+	std::vector<solver::TFitness> missed_fitnesses(missed.size());
+	if (mSetup.objective(mSetup.data, missed.size(), missed_solutions.data(), reinterpret_cast<double*>(missed_fitnesses.data())) != TRUE) {
+		return FALSE;
+	}
+
+	for (size_t i = 0; i < missed.size(); i++) {
+		fitness_array[missed[i]] = missed_fitnesses[i];
+		Insert(hashes[missed[i]], solutions + missed[i] * mSetup.problem_size, missed_fitnesses[i]);
+	}
+
+	return TRUE;
+}
+
+solver::TSolver_Setup CFitness_Cache::Cached_Setup() {
+	solver::TSolver_Setup cached_setup = mSetup;
+	cached_setup.data = this;
+	cached_setup.objective = &CFitness_Cache::Cached_Objective;
+	return cached_setup;
+}
+
+BOOL IfaceCalling CFitness_Cache::Cached_Objective(const void* data, const size_t solution_count, const double* solutions, double* const fitnesses) {
+	CFitness_Cache *cache = reinterpret_cast<CFitness_Cache*>(const_cast<void*>(data));
+	return cache->Evaluate(solution_count, solutions, fitnesses);
+}
+
+DLL_EXPORT HRESULT IfaceCalling get_fitness_cache_statistics(TFitness_Cache_Statistics* statistics) noexcept {
+	if (!statistics) {
+		return E_INVALIDARG;
+	}
+
+	statistics->hits = total_hits;
+	statistics->misses = total_misses;
+	statistics->evictions = total_evictions;
+	return S_OK;
+}
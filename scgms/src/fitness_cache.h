@@ -0,0 +1,89 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#pragma once
+
+#include <scgms/iface/SolverIface.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//memoizes the fitness of the solutions, which a solver evaluates repeatedly - e.g.; hints, solutions clamped to the bounds and converged populations
+//the solutions are compared bit-wise, and only the successfully evaluated ones are cached
+//the cache lives for a single solve, so that neither the objective, nor the configuration behind it may change
+class CFitness_Cache {
+	protected:
+		static constexpr size_t Shard_Count = 16;						//power of two
+		static constexpr size_t Memory_Budget = 64 * 1024 * 1024;		//bytes per cache, to bound the memory for the large problems
+
+		struct TShard {
+			std::mutex guard;
+			std::unordered_map<uint64_t, std::vector<size_t>> index;	//solution hash => indices to the entries
+			std::vector<double> solutions;	//problem_size doubles per entry
+			std::vector<solver::TFitness> fitnesses;
+			std::deque<size_t> age;			//entry indices, the oldest first, to evict them
+		};
+
+		const solver::TSolver_Setup &mSetup;
+		const size_t mShard_Capacity;
+		std::array<TShard, Shard_Count> mShards;
+
+		uint64_t Hash(const double* solution) const noexcept;
+		bool Lookup(const uint64_t hash, const double* solution, solver::TFitness &fitness);
+		void Insert(const uint64_t hash, const double* solution, const solver::TFitness &fitness);
+
+		//evaluates a batch of the solutions with the original objective, but those cached
+		BOOL Evaluate(const size_t solution_count, const double* solutions, double* const fitnesses);
+	public:
+		CFitness_Cache(const solver::TSolver_Setup &setup);
+
+		//the setup to pass to the solver, i.e.; a copy of the original one with the objective going through the cache
+		solver::TSolver_Setup Cached_Setup();
+
+		static BOOL IfaceCalling Cached_Objective(const void* data, const size_t solution_count, const double* solutions, double* const fitnesses);
+};
+
+struct TFitness_Cache_Statistics {
+	size_t hits;		//evaluations spared, summed over all the solves so far
+	size_t misses;
+	size_t evictions;	//entries dropped, because the cache was full
+};
+
+DLL_EXPORT HRESULT IfaceCalling get_fitness_cache_statistics(TFitness_Cache_Statistics* statistics) noexcept;
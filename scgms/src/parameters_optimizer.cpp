@@ -37,7 +37,9 @@
 #include <scgms/rtl/SolverLib.h>
 #include <scgms/rtl/referencedImpl.h>
 #include <scgms/rtl/FilterLib.h>
+#include <scgms/iface/FilterExtIface.h>
 #include <scgms/utils/DebugHelper.h>
+#include <scgms/utils/string_utils.h>
 #include <scgms/lang/dstrings.h>
 
 #include "parameters_optimizer.h"
@@ -48,8 +50,14 @@
 #include "composite_filter.h"
 #include "device_event.h"
 #include "persistent_chain_configuration.h"
+#include "worker_pool.h"
 
 #include <stack>
+#include <array>
+#include <memory>
+#include <atomic>
+#include <cmath>
+#include <limits>
 #include <mutex>
 #include <set>
 #include <numeric>
@@ -65,9 +73,12 @@ class CNull_wstr_list : public refcnt::Swstr_list {
 		void for_each(std::function<void(const std::wstring& wstr)> callback) const {};
 };
 
+constexpr size_t Replay_Batch_Size = 256;	//number of replayed events sent to the optimizing body at once
+
+const wchar_t* rsOptimizer_Workers_Not_Started = L"The optimizer worker processes could not be started, the candidates are evaluated in the optimizer's process. The workers are supported on Linux only and they cannot be forked, while the process runs other threads.";
+
 struct TOptimizing_Configuration {
 	scgms::SFilter_Chain_Configuration optimizing_body;
-	std::vector<CDevice_Event> events_to_replay;
 };
 
 struct TConfig_Characteristics {
@@ -87,6 +98,8 @@ class CError_Metric_Future {
 		solver::TFitness mError_Metric = solver::Nan_Fitness;
 			//has to be array as vector could actually reallocate the memory block on push_back
 		size_t mError_Metric_Count = 0;	//count of all used metrics
+		std::array<scgms::ISignal_Error_Inspection*, solver::Maximum_Objectives_Count> mError_Metric_Filters{};	//owned by the chain, to collect the metrics of a reused chain
+		std::array<scgms::ISignal_Error_Bound*, solver::Maximum_Objectives_Count> mError_Metric_Bounds{};	//nullptr for the filters, which do not bound their metric
 
 	public:
 		CError_Metric_Future(scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data) : mOn_Filter_Created(on_filter_created), mOn_Filter_Created_Data(on_filter_created_data) {};
@@ -101,6 +114,11 @@ class CError_Metric_Future {
 						return E_FAIL;
 					}
 
+					mError_Metric_Filters[mError_Metric_Count] = insp.get();
+
+					refcnt::SReferenced<scgms::ISignal_Error_Bound> bound;
+					refcnt::Query_Interface<scgms::IFilter, scgms::ISignal_Error_Bound>(filter, scgms::IID_Signal_Error_Bound, bound);
+					mError_Metric_Bounds[mError_Metric_Count] = bound.get();
 					mError_Metric_Count++;
 				}
 			}
@@ -116,6 +134,33 @@ class CError_Metric_Future {
 			return mError_Metric_Count;
 		}
 
+		//calculates the metrics now, instead of waiting for the dtors of the filters
+		size_t Collect_Error_Metric(double * const fitness) const {
+			for (size_t i = 0; i < mError_Metric_Count; i++) {
+				double metric = std::numeric_limits<double>::quiet_NaN();
+				mError_Metric_Filters[i]->Promise_Metric(scgms::All_Segments_Id, &metric, false);
+				fitness[mError_Metric_Count - i - 1] = metric;
+			}
+
+			return mError_Metric_Count;
+		}
+
+		//true, if the single metric cannot get to the cutoff anymore; then, the fitness is the infinity
+		//the bound itself must not be reported, as the solver would rank the candidate better than it actually is
+		bool Exceeds_Cutoff(const double cutoff, double * const fitness) const {
+			if ((mError_Metric_Count != 1) || !mError_Metric_Bounds[0]) {
+				return false;	//there is no total order of more metrics
+			}
+
+			double bound = std::numeric_limits<double>::quiet_NaN();
+			if ((mError_Metric_Bounds[0]->Get_Metric_Lower_Bound(&bound) == S_OK) && (bound > cutoff)) {
+				fitness[0] = std::numeric_limits<double>::infinity();
+				return true;
+			}
+
+			return false;
+		}
+
 		size_t Metric_Count() const {
 			return mError_Metric_Count;
 		}
@@ -126,6 +171,28 @@ HRESULT IfaceCalling On_Filter_Created_Wrapper(scgms::IFilter *filter, const voi
 	return on_filter_created->On_Filter_Created(filter);
 }
 
+//instantiated optimizing body, which can evaluate more candidate solutions, if all its filters are reusable
+struct TOptimizing_Chain {
+	TOptimizing_Configuration configuration;
+	std::recursive_mutex communication_guard;
+	CTerminal_Filter terminal_filter{ nullptr };
+	CError_Metric_Future error_metric_future;
+	std::unique_ptr<CComposite_Filter> composite_filter;	//declared last to be destroyed first, thus filling the future error metric
+	bool reusable = false;
+
+	TOptimizing_Chain(TOptimizing_Configuration &&optimizing_configuration, scgms::TOn_Filter_Created on_filter_created, const void* on_filter_created_data)
+		: configuration(std::move(optimizing_configuration)), error_metric_future(on_filter_created, on_filter_created_data),
+		  composite_filter(std::make_unique<CComposite_Filter>(communication_guard)) {
+	}
+
+	void Shut_Down() {
+		scgms::IDevice_Event* shutdown_event = allocate_device_event(scgms::NDevice_Event_Code::Shut_Down);
+		if (Succeeded(composite_filter->Execute(shutdown_event))) {
+			terminal_filter.Wait_For_Shutdown();	//wait only if the shutdown did go through succesfully
+		}
+	}
+};
+
 class  CParameters_Optimizer {
 	protected:
 		size_t mProblem_Size = 0;
@@ -133,10 +200,20 @@ class  CParameters_Optimizer {
 		std::vector<double> mLower_Bound, mUpper_Bound, mFound_Parameters;
 
 		std::mutex mOptimizing_Pool_Guard;
-		std::vector<CDevice_Event> mEvents_To_Replay_Master_Copy;
+		CReplay_Buffer mEvents_To_Replay;	//shared by all the optimizing configurations as it is immutable once fetched
 		scgms::SFilter_Chain_Configuration mOptimizing_Body_Master_Copy;
 
 		std::stack<TOptimizing_Configuration> mOptimizing_Pool;
+		std::stack<std::unique_ptr<TOptimizing_Chain>> mChain_Pool;		//reusable chains, which are not shut down yet
+		size_t mReusable_Replay_End = 0;	//the reused chains get all the events to replay, but the final shut down; zero if the chains cannot be reused
+
+		bool mEarly_Abort_Enabled = false;	//only while solving, because the aborted candidates do not get their exact fitness
+		std::atomic<double> mEarly_Abort_Cutoff{ std::numeric_limits<double>::quiet_NaN() };	//the best single-objective fitness so far
+
+		std::unique_ptr<CFitness_Worker_Pool> mWorker_Pool;	//only while solving, if requested; evaluates the candidates in the worker processes
+
+		std::vector<std::vector<char>> mCheckpoint;	//state of the optimizing body's filters after replaying the first mCheckpoint_Event_Count events
+		size_t mCheckpoint_Event_Count = 0;			//zero, if there is no checkpoint to restore
 
 		const scgms::TOn_Filter_Created mOn_Filter_Created;
 		const void* mOn_Filter_Created_Data;
@@ -178,15 +255,6 @@ class  CParameters_Optimizer {
 				//it is empty, we need to construct a new one (which still needs the lock as it accesses the master copies)
 				TOptimizing_Configuration result;
 
-				//copy the events
-				for (size_t i = 0; i < mEvents_To_Replay_Master_Copy.size(); i++) {
-					scgms::TDevice_Event& src_event = mEvents_To_Replay_Master_Copy[i].Raw();
-					CDevice_Event dst_event;
-					dst_event.Initialize(&src_event);
-
-					result.events_to_replay.push_back(std::move(dst_event));
-				}
-
 				//copy the config
 				result.optimizing_body = Deep_Copy_Subconfiguration(0, mCharacteristics.optimizing_body_end - mCharacteristics.optimizing_body_begin, mOptimizing_Body_Master_Copy, false);
 
@@ -230,6 +298,204 @@ class  CParameters_Optimizer {
 			return result;
 		}
 
+		//replays at most max_count events, while the body's state does not depend on the parameters, and returns the number of the replayed events
+		size_t Replay_Checkpointable_Events(CComposite_Filter &composite_filter, const size_t max_count) {
+			size_t replayed_count = 0;
+
+			while ((replayed_count < max_count) && (replayed_count + 1 < mEvents_To_Replay.size())) {	//at least the last event has to go through the regular replay
+				if (mEvents_To_Replay.Event_Code(replayed_count) == scgms::NDevice_Event_Code::Shut_Down) {
+					break;
+				}
+
+				scgms::IDevice_Event* event_to_replay = nullptr;
+				if (!Succeeded(mEvents_To_Replay.Materialize(replayed_count, &event_to_replay))) {
+					break;
+				}
+
+				if (!Succeeded(composite_filter.Execute(event_to_replay))) {
+					return 0;	//we cannot tell the state of the body
+				}
+
+				if (composite_filter.Save_Checkpoint(nullptr) != S_OK) {
+					break;	//this event made the state parameter-dependent, so it cannot be a part of the checkpoint
+				}
+
+				replayed_count++;
+			}
+
+			return replayed_count;
+		}
+
+		//the optimizing body usually does nothing, what would depend on its parameters, for a while - e.g., before the first solver run of a calculated signal
+		//hence we find such a prefix of the events to replay, and save the body's state after it, so that each fitness calculation may restore the state instead of replaying the prefix
+		void Prepare_Checkpoint() {
+			mCheckpoint.clear();
+			mCheckpoint_Event_Count = 0;
+
+			size_t checkpoint_event_count = std::numeric_limits<size_t>::max();
+			refcnt::Swstr_list empty_error_description = mEmpty_Error_Description;
+
+			//the first pass finds the prefix, the second one replays just the prefix and saves the checkpoint
+			for (size_t pass = 0; pass < 2; pass++) {
+				TOptimizing_Configuration opt = Pop_Optimizing_Configuration(mFound_Parameters.data());
+				if (!opt.optimizing_body) {
+					return;
+				}
+
+				std::recursive_mutex communication_guard;
+				CTerminal_Filter terminal_filter{ nullptr };
+				{
+					CComposite_Filter composite_filter{ communication_guard };
+					if ((composite_filter.Build_Filter_Chain(opt.optimizing_body.get(), &terminal_filter, nullptr, nullptr, empty_error_description) == S_OK) &&
+						(composite_filter.Save_Checkpoint(nullptr) == S_OK)) {
+
+						const size_t replayed_count = Replay_Checkpointable_Events(composite_filter, checkpoint_event_count);
+						if (pass == 0) {
+							checkpoint_event_count = replayed_count;
+						}
+						else if ((replayed_count == checkpoint_event_count) && (composite_filter.Save_Checkpoint(&mCheckpoint) == S_OK)) {
+							mCheckpoint_Event_Count = checkpoint_event_count;
+						}
+					}
+					else {
+						checkpoint_event_count = 0;
+					}
+
+					scgms::IDevice_Event* shutdown_event = allocate_device_event(scgms::NDevice_Event_Code::Shut_Down);
+					if (Succeeded(composite_filter.Execute(shutdown_event))) {
+						terminal_filter.Wait_For_Shutdown();	//wait only if the shutdown did go through succesfully
+					}
+				}
+
+				Push_Optimizing_Pool(opt);
+
+				if (checkpoint_event_count == 0) {
+					break;	//nothing to spare
+				}
+			}
+
+			if (mCheckpoint_Event_Count == 0) {
+				mCheckpoint.clear();
+			}
+		}
+
+		//pops a reused chain, reset with the solution, or builds a new one
+		std::unique_ptr<TOptimizing_Chain> Pop_Optimizing_Chain(const double* solution, refcnt::Swstr_list &error_description) {
+			std::unique_ptr<TOptimizing_Chain> chain;
+			{
+				std::lock_guard<std::mutex> lg{ mOptimizing_Pool_Guard };
+				if (!mChain_Pool.empty()) {
+					chain = std::move(mChain_Pool.top());
+					mChain_Pool.pop();
+				}
+			}
+
+			if (chain) {
+				std::vector<scgms::SModel_Parameter_Vector> parameters;
+				std::vector<TFilter_Reset_Parameters> reset_parameters;
+				for (size_t i = 0; i < mFilter_Indices.size(); i++) {
+					std::vector<double> values;	//in the configuration's format
+					values.insert(values.end(), mLower_Bound.begin() + mFilter_Parameter_Offsets[i], mLower_Bound.begin() + mFilter_Parameter_Offsets[i] + mFilter_Parameter_Counts[i]);
+					values.insert(values.end(), solution + mFilter_Parameter_Offsets[i], solution + mFilter_Parameter_Offsets[i] + mFilter_Parameter_Counts[i]);
+					values.insert(values.end(), mUpper_Bound.begin() + mFilter_Parameter_Offsets[i], mUpper_Bound.begin() + mFilter_Parameter_Offsets[i] + mFilter_Parameter_Counts[i]);
+
+					parameters.push_back(refcnt::Create_Container_shared<double, scgms::SModel_Parameter_Vector>(values.data(), values.data() + values.size()));
+					reset_parameters.push_back({ mFilter_Indices[i] - mCharacteristics.optimizing_body_begin, mParameters_Config_Names[i].c_str(), parameters.back().get() });
+				}
+
+				if (Succeeded(chain->composite_filter->Reset(reset_parameters))) {
+					return chain;
+				}
+
+				chain->Shut_Down();	//and build a new one
+			}
+
+			TOptimizing_Configuration opt = Pop_Optimizing_Configuration(solution);
+			if (!opt.optimizing_body) {
+				return nullptr;
+			}
+
+			chain = std::make_unique<TOptimizing_Chain>(std::move(opt), mOn_Filter_Created, mOn_Filter_Created_Data);
+			if (chain->composite_filter->Build_Filter_Chain(chain->configuration.optimizing_body.get(), &chain->terminal_filter, On_Filter_Created_Wrapper, &chain->error_metric_future, error_description) != S_OK) {
+				return nullptr;
+			}
+
+			chain->reusable = (mReusable_Replay_End > 0) && chain->composite_filter->Reusable();
+			return chain;
+		}
+
+		void Push_Optimizing_Chain(std::unique_ptr<TOptimizing_Chain> chain) {
+			std::lock_guard<std::mutex> lg{ mOptimizing_Pool_Guard };
+			mChain_Pool.push(std::move(chain));
+		}
+
+		void Clear_Chain_Pool() {
+			std::lock_guard<std::mutex> lg{ mOptimizing_Pool_Guard };
+			while (!mChain_Pool.empty()) {
+				mChain_Pool.top()->Shut_Down();
+				mChain_Pool.pop();
+			}
+		}
+
+		//the chains can be reused, if the replayed events end with the only shut down, which the reused chains do not get
+		size_t Reusable_Replay_End() {
+			for (size_t i = 0; i < mEvents_To_Replay.size(); i++) {
+				if (mEvents_To_Replay.Event_Code(i) == scgms::NDevice_Event_Code::Shut_Down) {
+					return i + 1 == mEvents_To_Replay.size() ? i : 0;
+				}
+			}
+
+			return mEvents_To_Replay.size();
+		}
+
+		//lowers the cutoff, if the fitness is better
+		void Update_Early_Abort_Cutoff(const double fitness) {
+			if (std::isnan(fitness)) {
+				return;
+			}
+
+			double cutoff = mEarly_Abort_Cutoff.load();
+			while ((std::isnan(cutoff) || (fitness < cutoff)) && !mEarly_Abort_Cutoff.compare_exchange_weak(cutoff, fitness)) {
+				//cutoff has been reloaded by the failed CAS
+			}
+		}
+
+		//replays the events [begin, end), while releasing them regardless the result
+		//stops early, once the chain's metric exceeds the cutoff - then, aborted is set and the fitness is the infinity
+		bool Replay_Events(TOptimizing_Chain &chain, const size_t begin, const size_t end, const double cutoff, double* const fitness, bool &aborted) {
+			CComposite_Filter &composite_filter = *chain.composite_filter;
+			aborted = false;
+
+			std::vector<scgms::IDevice_Event*> batch;	//the events are sent in batches to spare the per-event locking and virtual calls
+			batch.reserve(std::min(Replay_Batch_Size, end - begin));
+
+			for (size_t i = begin; i < end; i++) {
+				scgms::IDevice_Event* event_to_replay = nullptr;
+				if (!Succeeded(mEvents_To_Replay.Materialize(i, &event_to_replay))) {	//with a deep copy of the parameters, which a filter might modify
+					for (auto pending_event : batch) {
+						pending_event->Release();
+					}
+					return false;
+				}
+
+				batch.push_back(event_to_replay);
+				if ((batch.size() == Replay_Batch_Size) || (i + 1 == end)) {
+					const bool succeeded = Succeeded(composite_filter.Execute_Batch(batch.data(), batch.data() + batch.size()));	//releases the events regardless the result
+					batch.clear();
+					if (!succeeded) {
+						return false;
+					}
+
+					if (!std::isnan(cutoff) && chain.error_metric_future.Exceeds_Cutoff(cutoff, fitness)) {
+						aborted = true;
+						return true;
+					}
+				}
+			}
+
+			return true;
+		}
+
 		void Push_Optimizing_Pool(TOptimizing_Configuration& config) {
 			//push valid configs only
 			if (config.optimizing_body) {
@@ -491,7 +757,7 @@ class  CParameters_Optimizer {
 		}
 
 		bool Fetch_Events_To_Replay(const size_t optimizing_body_begin, refcnt::Swstr_list &error_description) {
-			mEvents_To_Replay_Master_Copy.clear();
+			mEvents_To_Replay.Clear();
 		 
 			//if it is the very first filter, than we can safely fetch no events to replay - but it is correct
 			//or, we would need an additional logic to verify that no one connects to this filter
@@ -503,7 +769,7 @@ class  CParameters_Optimizer {
 			scgms::SFilter_Chain_Configuration reduced_filter_configuration = Deep_Copy_Subconfiguration(0, optimizing_body_begin, mConfiguration, false);
 
 			std::recursive_mutex communication_guard;
-			CCopying_Terminal_Filter terminal_filter{ mEvents_To_Replay_Master_Copy, true };
+			CCopying_Terminal_Filter terminal_filter{ mEvents_To_Replay };
 
 			//when copying, we avoid any info events as:
 			//	1 - it is a bad practice to control anything with them
@@ -514,11 +780,13 @@ class  CParameters_Optimizer {
 
 				if (composite_filter.Build_Filter_Chain(reduced_filter_configuration.get(), &terminal_filter, mOn_Filter_Created, mOn_Filter_Created_Data, error_description) == S_OK) {
 					terminal_filter.Wait_For_Shutdown();
+					mEvents_To_Replay.Seal();
+					mReusable_Replay_End = Reusable_Replay_End();
 					return true;
 				}
 				else {
 					composite_filter.Clear();	//terminate for sure
-					mEvents_To_Replay_Master_Copy.clear(); //sanitize as this might have been filled partially
+					mEvents_To_Replay.Clear(); //sanitize as this might have been filled partially
 					error_description.push(dsFailed_to_execute_first_filters);
 
 					return false;
@@ -620,7 +888,7 @@ class  CParameters_Optimizer {
 		}
 
 		~CParameters_Optimizer() {
-			//
+			Clear_Chain_Pool();	//in the case that we failed before clearing it
 		}
 
 		HRESULT Optimize(const GUID solver_id, const size_t population_size, const size_t max_generations, 
@@ -647,7 +915,7 @@ class  CParameters_Optimizer {
 				return E_FAIL;
 			}
 
-			//now, we have  mEvents_To_Replay_Master_Copy filled, and have to fill optimizing body's master copy
+			//now, we have  mEvents_To_Replay filled, and have to fill optimizing body's master copy
 			//this is the only time we request to eliminate any variables in the configuration so that each candidate solution will have the possibly-used variables resolve to exactly the same values
 			mOptimizing_Body_Master_Copy = Deep_Copy_Subconfiguration(mCharacteristics.optimizing_body_begin, mCharacteristics.optimizing_body_end, mConfiguration, true);
 			if (!mOptimizing_Body_Master_Copy) {
@@ -655,6 +923,8 @@ class  CParameters_Optimizer {
 				return E_FAIL;
 			}
 
+			Prepare_Checkpoint();
+
 			std::vector<const double*> effective_hints;
 			effective_hints.push_back(mFound_Parameters.data());
 			for (size_t i = 0; i < hint_count; i++) {
@@ -671,6 +941,19 @@ class  CParameters_Optimizer {
 				max_generations, population_size, std::numeric_limits<double>::min()
 			};
 
+			mEarly_Abort_Enabled = true;	//before the fork, so that the workers abort the candidates as well; each with its own cutoff though
+
+			//fork the workers now, while we run no chain, thus no other thread, which could hold a lock
+			const size_t worker_count = CFitness_Worker_Pool::Worker_Count_From_Environment();
+			if (worker_count > 0) {
+				mWorker_Pool = std::make_unique<CFitness_Worker_Pool>(mProblem_Size);
+				if (!mWorker_Pool->Start(worker_count, [this](const double* solution, double* const fitness) { return Calculate_Single_Fitness(solution, fitness, mEmpty_Error_Description); })) {
+					mWorker_Pool.reset();	//evaluate in this process then
+					error_description.push(rsOptimizer_Workers_Not_Started);	//not an error, but the user has asked for the workers
+					dprintf("%s\n", Narrow_WString(rsOptimizer_Workers_Not_Started).c_str());
+				}
+			}
+
 			//as the configuration may hold some native filters, let us keep an over-subscription reduced instance to keep the libraries loaded
 
 			{
@@ -686,6 +969,8 @@ class  CParameters_Optimizer {
 
 					//optimizing now...
 					rc = solve_generic(&solver_id, &solver_setup, &progress);
+					mEarly_Abort_Enabled = false;
+					mWorker_Pool.reset();	//the validation runs in this process
 
 					scgms::IDevice_Event* oversubscript_shutdown_event = allocate_device_event(scgms::NDevice_Event_Code::Shut_Down);
 					if (Succeeded(oversubscript_composite_filter.Execute(oversubscript_shutdown_event))) {
@@ -701,6 +986,8 @@ class  CParameters_Optimizer {
 				}
 			}
 
+			Clear_Chain_Pool();
+
 			//eventually, we need to copy the solution to the original configuration - on success
 			if (rc == S_OK) {
 				for (size_t i = 0; i < mFilter_Indices.size(); i++) {
@@ -733,6 +1020,10 @@ class  CParameters_Optimizer {
 		}
 
 		bool Calculate_Fitness(const size_t solution_count, const double* solutions, double* const fitnesses, refcnt::Swstr_list empty_error_description) {
+			if (mWorker_Pool) {
+				return mWorker_Pool->Evaluate(solution_count, solutions, fitnesses);
+			}
+
 			if (solution_count > 1) {
 				bool success_flag = true;
 				std::for_each(std::execution::par/* par_unseq*/, solver::CInt_Iterator<size_t>{ 0 }, solver::CInt_Iterator<size_t>{ solution_count }, [=, this, &success_flag](const auto& id) {
@@ -752,78 +1043,64 @@ class  CParameters_Optimizer {
 		}
 
 		bool Calculate_Single_Fitness(const double* solution, double* const fitness, refcnt::Swstr_list empty_error_description) {
-			bool failure_detected = false;
-
-			TOptimizing_Configuration opt = Pop_Optimizing_Configuration(solution);
-			if (!opt.optimizing_body) {
+			std::unique_ptr<TOptimizing_Chain> chain = Pop_Optimizing_Chain(solution, empty_error_description);
+			if (!chain) {
 				return false;
 			}
 
-			//Have the means to pickup the final metric
-			CError_Metric_Future error_metric_future{ mOn_Filter_Created, mOn_Filter_Created_Data };
-
-			//run the configuration
-			std::recursive_mutex communication_guard;
-			CTerminal_Filter terminal_filter{ nullptr };
-			{
-				//must be in the block that we can precisely call its dtor to get the future error properly
-				CComposite_Filter composite_filter{ communication_guard };
+			bool failure_detected = false;
 
-				if (composite_filter.Build_Filter_Chain(opt.optimizing_body.get(), &terminal_filter, On_Filter_Created_Wrapper, &error_metric_future, empty_error_description) != S_OK) {
-					return std::numeric_limits<double>::quiet_NaN();
+			//skip the events, whose outcome does not depend on the parameters, by restoring the state they lead to
+			size_t first_event_to_replay = 0;
+			if (mCheckpoint_Event_Count > 0) {
+				if (chain->composite_filter->Restore_Checkpoint(mCheckpoint) == S_OK) {
+					first_event_to_replay = mCheckpoint_Event_Count;
 				}
+				else {
+					failure_detected = true;	//some filters may have restored already, so we cannot just replay all the events
+				}
+			}
 
-				//wait for the result
-				if (!opt.events_to_replay.empty()) {
-					for (size_t i = 0; i < opt.events_to_replay.size(); i++) {		//we can replay the pre-calculated events
-
-						scgms::IDevice_Event* event_to_replay = nullptr;
-						failure_detected = !Succeeded(opt.events_to_replay[i].Clone(&event_to_replay));
-
-						const auto event_code = opt.events_to_replay[i].Raw().event_code;
-						if ((event_code == scgms::NDevice_Event_Code::Parameters) || (event_code == scgms::NDevice_Event_Code::Parameters_Hint)) {
-							//such event carries a reference to parameters array, which is shared across the optimizing pool
-							//to preserve the original value, let us make a deep copy of it in case that some filter would modify it - which would advertly affect entire optimization
-
-							scgms::TDevice_Event* raw_event_to_replay = nullptr;
-							failure_detected = !Succeeded(event_to_replay->Raw(&raw_event_to_replay));
-
-							if (!failure_detected) {
-								if (raw_event_to_replay->parameters) {
-									scgms::IModel_Parameter_Vector* new_vector = refcnt::Copy_Container<double, scgms::IModel_Parameter_Vector>(raw_event_to_replay->parameters);
-									raw_event_to_replay->parameters->Release();	//copied
-									raw_event_to_replay->parameters = new_vector;	//and replaced with their deep copy
-								}
-							}
-
-							//note we do not do the same for strings, because we already removed any string events from being replayed - see Fetch_Events_To_Replay
-						}
-
-						if (!failure_detected) {
-							failure_detected = !Succeeded(composite_filter.Execute(event_to_replay));
-						}
+			//a candidate, which cannot be better than the best one so far, does not need to replay all the events
+			const double cutoff = mEarly_Abort_Enabled ? mEarly_Abort_Cutoff.load() : std::numeric_limits<double>::quiet_NaN();
+			bool aborted = false;
+			if (!failure_detected) {
+				failure_detected = !Replay_Events(*chain, first_event_to_replay, chain->reusable ? mReusable_Replay_End : mEvents_To_Replay.size(), cutoff, fitness, aborted);
+			}
 
-						if (failure_detected) {
-							//something has not gone well => break, but be that nice to issue the shutdown event first
-							scgms::IDevice_Event* shutdown_event = allocate_device_event(scgms::NDevice_Event_Code::Shut_Down );
-							if (Succeeded(composite_filter.Execute(shutdown_event))) {
-								terminal_filter.Wait_For_Shutdown();	//wait only if the shutdown did go through succesfully
-							}
-							break;
-						}
-					}
-				}
-				else {
-					terminal_filter.Wait_For_Shutdown();//no pre-calculated events can be replayed=> we need to go the old-fashioned way
+			//a reusable chain is not shut down, so we have to pickup the metrics now and return it back to the pool
+			if (chain->reusable && !failure_detected) {
+				const bool metrics_available = aborted || (chain->error_metric_future.Collect_Error_Metric(fitness) == mCharacteristics.objective_count);	//we have to pick at as many metrics as promised
+				Push_Optimizing_Chain(std::move(chain));
+				if (metrics_available && !aborted && (mCharacteristics.objective_count == 1)) {
+					Update_Early_Abort_Cutoff(fitness[0]);
 				}
+				return metrics_available;
+			}
 
-			} //calls dtor of the signal error filter, thus filling the future error metric
+			if (failure_detected || aborted) {
+				//something has not gone well => be that nice to issue the shutdown event
+				chain->Shut_Down();
+			}
+			else if (mEvents_To_Replay.empty()) {
+				chain->terminal_filter.Wait_For_Shutdown();//no pre-calculated events can be replayed=> we need to go the old-fashioned way
+			}
+
+			chain->composite_filter.reset();	//calls dtor of the signal error filter, thus filling the future error metric
 
 			//return the configuration back to the pool
-			Push_Optimizing_Pool(opt);
+			Push_Optimizing_Pool(chain->configuration);
+
+			if (aborted) {
+				return !failure_detected;	//the fitness is already set to the infinity
+			}
 
 			//pickup the fitnesses value/error metrics and return it
-			return (!failure_detected) && (error_metric_future.Get_Error_Metric(fitness) == mCharacteristics.objective_count);	//we have to pick at as many metrics as promised
+			const bool metrics_available = (!failure_detected) && (chain->error_metric_future.Get_Error_Metric(fitness) == mCharacteristics.objective_count);	//we have to pick at as many metrics as promised
+			if (metrics_available && (mCharacteristics.objective_count == 1)) {
+				Update_Early_Abort_Cutoff(fitness[0]);
+			}
+			return metrics_available;
 		}
 };
 
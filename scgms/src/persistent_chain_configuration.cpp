@@ -37,6 +37,7 @@
 #include "persistent_chain_configuration.h"
 #include "configuration_link.h"
 #include "filters.h"
+#include "filter_parameter.h"
 
 #include <scgms/rtl/FilesystemLib.h>
 #include <scgms/rtl/FilterLib.h>
@@ -48,6 +49,72 @@
 
 #include <fstream>
 #include <exception>
+#include <chrono>
+#include <cwchar>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+namespace {
+	const char* rsConfiguration_Cache_Variable = "SCGMS_CONFIGURATION_CACHE";	//directory to keep the cached configurations in; no caching, if not set
+	const wchar_t* rsConfiguration_Cache_Extension = L".scgmsconf";
+
+	constexpr uint64_t Configuration_Cache_Magic = 0x3146'4e4f'4353'4d47;	//'GMSCONF1', to refuse a foreign or an outdated file
+
+	bool Read_Cache_Directory(filesystem::path &directory) {
+		size_t assumed_len = 0;
+		auto var_os_err = getenv_s(&assumed_len, nullptr, 0, rsConfiguration_Cache_Variable);
+		if ((var_os_err == 0) && (assumed_len > 0)) {
+			std::vector<char> var_buf(assumed_len);
+			var_os_err = getenv_s(&assumed_len, var_buf.data(), assumed_len, rsConfiguration_Cache_Variable);
+			if (var_os_err == 0) {
+				var_buf.push_back(0);	//make sure its ASCIIZ
+				directory = var_buf.data();
+				return !directory.empty();
+			}
+		}
+
+		return false;
+	}
+
+	//the cached configuration is valid for the same configuration text and the same set of loaded filters only
+	uint64_t Configuration_Key(const char *memory, const size_t len) {
+		uint64_t hash = 14695981039346656037ull ^ loaded_filters_fingerprint();	//FNV-1a
+		for (size_t i = 0; i < len; i++) {
+			hash ^= static_cast<unsigned char>(memory[i]);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	//the type is read as a plain number from the cache file, so it must be one we know before we cast it
+	bool Is_Cached_Parameter_Type(const std::underlying_type_t<scgms::NParameter_Type> raw_type, scgms::NParameter_Type &type) {
+		switch (static_cast<scgms::NParameter_Type>(raw_type)) {
+			case scgms::NParameter_Type::ptNull:
+			case scgms::NParameter_Type::ptWChar_Array:
+			case scgms::NParameter_Type::ptInt64_Array:
+			case scgms::NParameter_Type::ptDouble:
+			case scgms::NParameter_Type::ptRatTime:
+			case scgms::NParameter_Type::ptInt64:
+			case scgms::NParameter_Type::ptBool:
+			case scgms::NParameter_Type::ptSubject_Id:
+			case scgms::NParameter_Type::ptDouble_Array:
+			case scgms::NParameter_Type::ptSignal_Model_Id:
+			case scgms::NParameter_Type::ptDiscrete_Model_Id:
+			case scgms::NParameter_Type::ptMetric_Id:
+			case scgms::NParameter_Type::ptSolver_Id:
+			case scgms::NParameter_Type::ptModel_Produced_Signal_Id:
+			case scgms::NParameter_Type::ptSignal_Id:
+				type = static_cast<scgms::NParameter_Type>(raw_type);
+				return true;
+
+			default:
+				return false;
+		}
+	}
+}
 
 CPersistent_Chain_Configuration::CPersistent_Chain_Configuration() {
 	//
@@ -113,10 +180,176 @@ HRESULT IfaceCalling CPersistent_Chain_Configuration::Load_From_File(const wchar
 }
 
 HRESULT IfaceCalling CPersistent_Chain_Configuration::Load_From_Memory(const char* memory, const size_t len, refcnt::wstr_list* error_description) noexcept {
-	CSimpleIniW mIni;
-
 	refcnt::Swstr_list shared_error_description = refcnt::make_shared_reference_ext<refcnt::Swstr_list, refcnt::wstr_list>(error_description, true);
 
+	//the cache holds the whole configuration, so it cannot be used to append to an existing one
+	//the cache is just an optimization, so any failure with it falls back to parsing the configuration
+	filesystem::path cache_path;
+	uint64_t key = 0;
+	try {
+		if (mData.empty() && Read_Cache_Directory(cache_path)) {
+			key = Configuration_Key(memory, len);
+
+			std::wstringstream file_name;
+			file_name << std::hex << std::setw(16) << std::setfill(L'0') << key << rsConfiguration_Cache_Extension;
+			cache_path /= file_name.str();
+
+			if (Load_From_Cache(cache_path, key)) {
+				return S_OK;
+			}
+		}
+	}
+	catch (...) {
+		cache_path.clear();
+	}
+
+	bool cacheable = false;
+	const HRESULT rc = Parse_From_Memory(memory, len, shared_error_description, cacheable);
+	if ((rc == S_OK) && cacheable && !cache_path.empty()) {
+		try {
+			Save_To_Cache(cache_path, key);
+		}
+		catch (...) {
+			//the configuration is already loaded, we just do not have it cached
+		}
+	}
+
+	return rc;
+}
+
+bool CPersistent_Chain_Configuration::Load_From_Cache(const filesystem::path &cache_path, const uint64_t key) {
+	std::ifstream cache_file{ cache_path, std::ifstream::binary };
+	if (!cache_file.is_open()) {
+		return false;
+	}
+
+	std::vector<char> buf{ std::istreambuf_iterator<char>(cache_file), std::istreambuf_iterator<char>() };
+	auto container = refcnt::Create_Container_shared<char>(buf.data(), buf.data() + buf.size());
+	scgms::CCheckpoint_Reader reader{ container.get() };
+
+	uint64_t magic = 0, cached_key = 0, link_count = 0;
+	if (!reader.Read(magic) || (magic != Configuration_Cache_Magic) || !reader.Read(cached_key) || (cached_key != key) || !reader.Read(link_count)) {
+		return false;
+	}
+
+	//first, load all the links, so that we do not add just some of them, if the cache gets corrupted
+	const std::wstring parent_path = Get_Parent_Path();
+	std::vector<refcnt::SReferenced<scgms::IFilter_Configuration_Link>> links;
+	for (uint64_t i = 0; i < link_count; i++) {
+		GUID id;
+		uint64_t parameter_count = 0;
+		if (!reader.Read(id) || !reader.Read(parameter_count)) {
+			return false;
+		}
+
+		refcnt::SReferenced<scgms::IFilter_Configuration_Link> filter_config{ new CFilter_Configuration_Link{id} };
+		for (uint64_t j = 0; j < parameter_count; j++) {
+			std::underlying_type_t<scgms::NParameter_Type> raw_type;
+			scgms::NParameter_Type type;
+			std::vector<wchar_t> config_name;
+			if (!reader.Read(raw_type) || !Is_Cached_Parameter_Type(raw_type, type) || !reader.Read(config_name)) {
+				return false;
+			}
+			config_name.push_back(0);
+
+			std::unique_ptr<CFilter_Parameter> raw_filter_parameter = std::make_unique<CFilter_Parameter>(type, config_name.data());
+			raw_filter_parameter->Set_Parent_Path(parent_path.c_str());
+			if (!raw_filter_parameter->Load_Binary(reader)) {
+				return false;
+			}
+
+			scgms::IFilter_Parameter* raw_param = static_cast<scgms::IFilter_Parameter*>(raw_filter_parameter.get());
+			if (!Succeeded(filter_config->add(&raw_param, &raw_param + 1))) {
+				return false;
+			}
+			raw_filter_parameter.release();
+		}
+
+		links.push_back(std::move(filter_config));
+	}
+
+	if (!reader.Finished()) {
+		return false;
+	}
+
+	for (auto &link : links) {
+		auto raw_filter_config = link.get();
+		add(&raw_filter_config, &raw_filter_config + 1);
+	}
+
+	Advertise_Parent_Path();
+	return true;
+}
+
+void CPersistent_Chain_Configuration::Save_To_Cache(const filesystem::path &cache_path, const uint64_t key) {
+	scgms::CCheckpoint_Writer writer;
+	writer.Write(Configuration_Cache_Magic);
+	writer.Write(key);
+	writer.Write(static_cast<uint64_t>(mData.size()));
+
+	for (scgms::IFilter_Configuration_Link* link : mData) {
+		GUID id;
+		scgms::IFilter_Parameter **parameter_begin, **parameter_end;
+		if ((link->Get_Filter_Id(&id) != S_OK) || !Succeeded(link->get(&parameter_begin, &parameter_end))) {
+			return;
+		}
+
+		writer.Write(id);
+		writer.Write(static_cast<uint64_t>(std::distance(parameter_begin, parameter_end)));
+		for (; parameter_begin != parameter_end; parameter_begin++) {
+			CFilter_Parameter* parameter = dynamic_cast<CFilter_Parameter*>(*parameter_begin);
+			if (!parameter || parameter->Is_Deferred()) {
+				return;	//we do not know, how to store it, or its content does not come from the configuration
+			}
+
+			scgms::NParameter_Type type;
+			wchar_t* config_name = nullptr;
+			if ((parameter->Get_Type(&type) != S_OK) || (parameter->Get_Config_Name(&config_name) != S_OK) || !config_name) {
+				return;
+			}
+
+			writer.Write(static_cast<std::underlying_type_t<scgms::NParameter_Type>>(type));
+			writer.Write(std::vector<wchar_t>{ config_name, config_name + wcslen(config_name) });
+			parameter->Save_Binary(writer);
+		}
+	}
+
+	auto container = refcnt::Create_Container_shared<char>(nullptr, nullptr);
+	char *begin, *end;
+	if ((writer.Store(container.get()) != S_OK) || (container->get(&begin, &end) != S_OK)) {
+		return;
+	}
+
+	//more processes may load the same configuration at once, so we write a private file first, and then rename it
+	std::error_code ec;
+	filesystem::create_directories(cache_path.parent_path(), ec);
+
+	filesystem::path temporary_path = cache_path;
+	temporary_path += L"." + std::to_wstring(std::hash<std::thread::id>{}(std::this_thread::get_id()) ^ static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+
+	{
+		std::ofstream cache_file{ temporary_path, std::ofstream::binary };
+		if (!cache_file.is_open()) {
+			return;
+		}
+		cache_file.write(begin, std::distance(begin, end));
+		if (!cache_file.good()) {
+			cache_file.close();
+			filesystem::remove(temporary_path, ec);
+			return;
+		}
+	}
+
+	filesystem::rename(temporary_path, cache_path, ec);
+	if (ec) {
+		filesystem::remove(temporary_path, ec);
+	}
+}
+
+HRESULT CPersistent_Chain_Configuration::Parse_From_Memory(const char* memory, const size_t len, refcnt::Swstr_list &shared_error_description, bool &cacheable) noexcept {
+	CSimpleIniW mIni;
+	cacheable = false;
+
 	if (mIni.LoadData(memory, len) != SI_Error::SI_OK) {
 		shared_error_description.push(L"Could not load INI file from memory");
 		return E_FAIL;
@@ -124,6 +357,7 @@ HRESULT IfaceCalling CPersistent_Chain_Configuration::Load_From_Memory(const cha
 
 	bool loaded_all_filters = true;
 	bool encountered_E_NOT_SET = false;
+	bool diagnosed_all = true;	//false, if a diagnostic message could be reproduced only by parsing the configuration again
 
 	const std::wstring parent_path = Get_Parent_Path();
 
@@ -154,7 +388,7 @@ HRESULT IfaceCalling CPersistent_Chain_Configuration::Load_From_Memory(const cha
 
 			scgms::TFilter_Descriptor desc = scgms::Null_Filter_Descriptor;
 
-			if (section_id_ok && scgms::get_filter_descriptor_by_id(id, desc)) {
+			if (section_id_ok && get_filter_descriptor_by_id_body(id, desc)) {	//loads just the library of the filter, if the libraries are loaded lazily
 				refcnt::SReferenced<scgms::IFilter_Configuration_Link> filter_config{ new CFilter_Configuration_Link{id} };
 
 				//so.. now, try to load the filter parameters - aka filter_config
@@ -195,6 +429,7 @@ HRESULT IfaceCalling CPersistent_Chain_Configuration::Load_From_Memory(const cha
 								error_desc.append(L" (3)");
 								error_desc.append(str_value);
 								shared_error_description.push(error_desc.c_str());
+								diagnosed_all = false;
 							}
 
 						}
@@ -205,6 +440,7 @@ HRESULT IfaceCalling CPersistent_Chain_Configuration::Load_From_Memory(const cha
 							error_desc.append(L" (2)");
 							error_desc.append(desc.ui_parameter_name[i]);
 							shared_error_description.push(error_desc.c_str());
+							diagnosed_all = false;
 						}
 					}
 
@@ -230,6 +466,7 @@ HRESULT IfaceCalling CPersistent_Chain_Configuration::Load_From_Memory(const cha
 		else {
 			std::wstring error_desc = dsInvalid_Section_Name + name_str;
 			shared_error_description.push(error_desc.c_str());
+			diagnosed_all = false;
 		}
 
 	}
@@ -240,6 +477,7 @@ HRESULT IfaceCalling CPersistent_Chain_Configuration::Load_From_Memory(const cha
 		describe_loaded_filters(shared_error_description);
 	}
 
+	cacheable = loaded_all_filters && !encountered_E_NOT_SET && diagnosed_all;
 	return (loaded_all_filters || encountered_E_NOT_SET) ? S_OK : S_FALSE;
 }
 
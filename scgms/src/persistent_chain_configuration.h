@@ -51,6 +51,12 @@ class CPersistent_Chain_Configuration : public virtual scgms::IPersistent_Filter
 		std::wstring Get_Parent_Path() noexcept;
 		void Advertise_Parent_Path() noexcept;
 
+	protected:
+		//the parsed configurations may be cached in a binary form, so that the same configuration does not need to be parsed over and over again
+		HRESULT Parse_From_Memory(const char *memory, const size_t len, refcnt::Swstr_list &error_description, bool &cacheable) noexcept;
+		bool Load_From_Cache(const filesystem::path &cache_path, const uint64_t key);
+		void Save_To_Cache(const filesystem::path &cache_path, const uint64_t key);
+
 	protected:
 		wchar_t* Describe_GUID(const GUID& val, const scgms::NParameter_Type param_type, const scgms::CSignal_Description& signal_descriptors) const noexcept;	
 
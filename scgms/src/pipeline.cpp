@@ -0,0 +1,100 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#include "pipeline.h"
+
+CPipeline_Stage::CPipeline_Stage(scgms::IFilter* stage_entry, const size_t queue_capacity) : mStage_Entry(stage_entry), mQueue(queue_capacity) {
+	//
+}
+
+CPipeline_Stage::~CPipeline_Stage() {
+	Stop();
+}
+
+void CPipeline_Stage::Start() {
+	if (mWorker) {
+		return;	//already running
+	}
+
+	std::lock_guard<std::mutex> guard{ mProducer_Guard };
+	mRunning = true;
+	mWorker = std::make_unique<std::thread>(&CPipeline_Stage::Run_Worker, this);
+}
+
+void CPipeline_Stage::Stop() {
+	if (!mWorker) {
+		return;
+	}
+
+	{
+		//nullptr is the sentinel, which makes the worker to quit once it delivers all the events queued before it
+		//the producers check mRunning with the guard held, hence no event can be queued after the sentinel
+		std::lock_guard<std::mutex> guard{ mProducer_Guard };
+		mRunning = false;
+		mQueue.Push(nullptr);
+	}
+
+	if (mWorker->joinable()) {
+		mWorker->join();
+	}
+	mWorker.reset();
+}
+
+void CPipeline_Stage::Run_Worker() {
+	while (scgms::IDevice_Event* event = mQueue.Pop()) {
+		mStage_Entry->Execute(event);	//we have no one to report the error to, the upstream filter has already continued
+	}
+}
+
+HRESULT IfaceCalling CPipeline_Stage::Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) {
+	return S_OK;
+}
+
+HRESULT IfaceCalling CPipeline_Stage::Execute(scgms::IDevice_Event *event) {
+	if (!event) {
+		return E_INVALIDARG;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard{ mProducer_Guard };
+		if (mRunning) {
+			mQueue.Push(event);	//and by this, we delegate event's release to the worker
+			return S_OK;
+		}
+	}
+
+	return mStage_Entry->Execute(event);
+}
@@ -0,0 +1,155 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#pragma once
+
+#include <scgms/rtl/FilterLib.h>
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <memory>
+
+//bounded, single-producer single-consumer ring of events
+//producer and consumer block, when the ring is full, or empty, respectively
+class CSPSC_Event_Ring {
+	protected:
+		static constexpr size_t Cache_Line_Size = 64;
+
+		std::vector<scgms::IDevice_Event*> mSlots;
+		const size_t mMask;
+
+		alignas(Cache_Line_Size) std::atomic<size_t> mHead{ 0 };	//next slot to read, written by the consumer only
+		alignas(Cache_Line_Size) std::atomic<size_t> mTail{ 0 };	//next slot to write, written by the producer only
+
+#ifdef __cpp_lib_atomic_wait
+		void Wait_For_Change(const std::atomic<size_t> &position, const size_t old) noexcept {
+			position.wait(old, std::memory_order_acquire);
+		}
+
+		void Notify_Change(std::atomic<size_t> &position) noexcept {
+			position.notify_one();
+		}
+#else
+		//prior to C++20, there is no atomic wait, so that the waiting side sleeps on a condition variable
+		std::mutex mChange_Guard;
+		std::condition_variable mChanged;
+
+		void Wait_For_Change(const std::atomic<size_t> &position, const size_t old) noexcept {
+			std::unique_lock<std::mutex> lock{ mChange_Guard };
+			mChanged.wait(lock, [&position, old]() { return position.load(std::memory_order_acquire) != old; });
+		}
+
+		void Notify_Change(std::atomic<size_t> &position) noexcept {
+			{
+				//the waiting side either has not checked the position yet, or it already waits
+				std::lock_guard<std::mutex> lock{ mChange_Guard };
+			}
+			mChanged.notify_all();
+		}
+#endif
+
+		static size_t Round_Up_To_Power_Of_Two(const size_t value) noexcept {
+			size_t result = 1;
+			while (result < value) {
+				result <<= 1;
+			}
+			return result;
+		}
+
+	public:
+		CSPSC_Event_Ring(const size_t capacity) : mSlots(Round_Up_To_Power_Of_Two(std::max(capacity, static_cast<size_t>(2)))), mMask(mSlots.size() - 1) {};
+
+		void Push(scgms::IDevice_Event* event) noexcept {
+			const size_t tail = mTail.load(std::memory_order_relaxed);
+			size_t head = mHead.load(std::memory_order_acquire);
+			while (tail - head >= mSlots.size()) {
+				Wait_For_Change(mHead, head);
+				head = mHead.load(std::memory_order_acquire);
+			}
+
+			mSlots[tail & mMask] = event;
+			mTail.store(tail + 1, std::memory_order_release);
+			Notify_Change(mTail);
+		}
+
+		scgms::IDevice_Event* Pop() noexcept {
+			const size_t head = mHead.load(std::memory_order_relaxed);
+			size_t tail = mTail.load(std::memory_order_acquire);
+			while (tail == head) {
+				Wait_For_Change(mTail, tail);
+				tail = mTail.load(std::memory_order_acquire);
+			}
+
+			scgms::IDevice_Event* event = mSlots[head & mMask];
+			mHead.store(head + 1, std::memory_order_release);
+			Notify_Change(mHead);
+			return event;
+		}
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
+
+//Entry point of a pipeline stage - upstream filter sees it as its next filter.
+//Once started, events are queued and a dedicated worker delivers them to the first executor of the stage,
+//thus the upstream filters do not wait for the downstream ones. Until started or once stopped,
+//the events are passed through synchronously, i.e.; exactly as if there would be no stage at all.
+class CPipeline_Stage : public virtual scgms::IFilter, public virtual refcnt::CNotReferenced {
+	protected:
+		scgms::IFilter* mStage_Entry;
+		std::mutex mProducer_Guard;		//serializes all the producers, so that the ring has a single one
+		CSPSC_Event_Ring mQueue;
+		bool mRunning = false;	//accessed with mProducer_Guard held only
+		std::unique_ptr<std::thread> mWorker;
+
+		void Run_Worker();
+
+	public:
+		CPipeline_Stage(scgms::IFilter* stage_entry, const size_t queue_capacity);
+		virtual ~CPipeline_Stage();
+
+		void Start();
+		void Stop();	//delivers all events queued so far, and then returns to the pass-through mode
+
+		// scgms::IFilter iface
+		virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) override final;
+		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final;
+};
+
+#pragma warning( pop )
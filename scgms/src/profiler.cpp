@@ -0,0 +1,263 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#include "profiler.h"
+
+#include <scgms/utils/string_utils.h>
+
+#include <fstream>
+#include <algorithm>
+
+namespace {
+	//floor of log2 of the duration, i.e.; the bucket i holds the durations [2^i, 2^(i+1))
+	size_t Histogram_Bucket(uint64_t duration) noexcept {
+		size_t bucket = 0;
+		while ((duration > 1) && (bucket < scgms::Profile_Histogram_Bucket_Count - 1)) {
+			duration >>= 1;
+			bucket++;
+		}
+
+		return bucket;
+	}
+
+	//upper bound of the bucket, in which the given quantile falls
+	uint64_t Histogram_Quantile(const uint64_t (&histogram)[scgms::Profile_Histogram_Bucket_Count], const double quantile) noexcept {
+		uint64_t total = 0;
+		for (const auto count : histogram) {
+			total += count;
+		}
+
+		const uint64_t threshold = static_cast<uint64_t>(static_cast<double>(total) * quantile);
+		uint64_t accumulated = 0;
+		for (size_t i = 0; i < scgms::Profile_Histogram_Bucket_Count; i++) {
+			accumulated += histogram[i];
+			if ((accumulated > threshold) || (accumulated == total)) {
+				return (static_cast<uint64_t>(1) << (i + 1)) - 1;
+			}
+		}
+
+		return 0;
+	}
+
+	std::string Filter_Name(const GUID &filter_id) {
+		scgms::TFilter_Descriptor desc = scgms::Null_Filter_Descriptor;
+		return scgms::get_filter_descriptor_by_id(filter_id, desc) ? Narrow_WString(desc.description) : Narrow_WString(GUID_To_WString(filter_id));
+	}
+
+	std::string JSON_String(const std::string &str) {
+		std::string result{ '"' };
+		for (const char c : str) {
+			if ((c == '"') || (c == '\\')) {
+				result += '\\';
+			}
+			result += c;
+		}
+		result += '"';
+		return result;
+	}
+
+	template <size_t N>
+	void Write_JSON_Array(std::ofstream &dst, const uint64_t (&values)[N]) {
+		dst << '[';
+		for (size_t i = 0; i < N; i++) {
+			dst << (i > 0 ? ", " : "") << values[i];
+		}
+		dst << ']';
+	}
+}
+
+void CFilter_Profile::Count_Event(scgms::IDevice_Event *event) noexcept {
+	scgms::TDevice_Event *raw_event;
+	if (event && (event->Raw(&raw_event) == S_OK) && (static_cast<size_t>(raw_event->event_code) < mEvent_Counts.size())) {
+		mEvent_Counts[static_cast<size_t>(raw_event->event_code)].fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void CFilter_Profile::Record_Call(const uint64_t inclusive_time, const uint64_t exclusive_time) noexcept {
+	mCall_Count.fetch_add(1, std::memory_order_relaxed);
+	mInclusive_Time.fetch_add(inclusive_time, std::memory_order_relaxed);
+	mExclusive_Time.fetch_add(exclusive_time, std::memory_order_relaxed);
+	mInclusive_Histogram[Histogram_Bucket(inclusive_time)].fetch_add(1, std::memory_order_relaxed);
+	mExclusive_Histogram[Histogram_Bucket(exclusive_time)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void CFilter_Profile::Get(scgms::TFilter_Profile &profile) const noexcept {
+	profile.filter_id = mFilter_Id;
+	for (size_t i = 0; i < mEvent_Counts.size(); i++) {
+		profile.event_counts[i] = mEvent_Counts[i].load(std::memory_order_relaxed);
+	}
+	profile.call_count = mCall_Count.load(std::memory_order_relaxed);
+	profile.inclusive_time = mInclusive_Time.load(std::memory_order_relaxed);
+	profile.exclusive_time = mExclusive_Time.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < scgms::Profile_Histogram_Bucket_Count; i++) {
+		profile.inclusive_histogram[i] = mInclusive_Histogram[i].load(std::memory_order_relaxed);
+		profile.exclusive_histogram[i] = mExclusive_Histogram[i].load(std::memory_order_relaxed);
+	}
+}
+
+
+thread_local CProfiled_Call* CProfiled_Call::mCurrent_Call = nullptr;
+
+CProfiled_Call::CProfiled_Call(CFilter_Profile &profile) noexcept : mProfile(profile), mOuter_Call(mCurrent_Call), mStart(TClock::now()) {
+	mCurrent_Call = this;
+}
+
+CProfiled_Call::~CProfiled_Call() {
+	const uint64_t inclusive_time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(TClock::now() - mStart).count());
+	mProfile.Record_Call(inclusive_time, inclusive_time > mNested_Time ? inclusive_time - mNested_Time : 0);
+
+	mCurrent_Call = mOuter_Call;
+	if (mOuter_Call) {
+		mOuter_Call->mNested_Time += inclusive_time;
+	}
+}
+
+
+CChain_Profiler::CChain_Profiler(const std::string &output_path, scgms::IFilter *next_filter) : mOutput_Path(output_path), mNext_Filter(next_filter) {
+	//
+}
+
+CFilter_Profile* CChain_Profiler::Prepend_Filter(const GUID &filter_id) {
+	mProfiles.insert(mProfiles.begin(), std::make_unique<CFilter_Profile>(filter_id));
+	return mProfiles[0].get();
+}
+
+bool CChain_Profiler::Get_Profile(const size_t position, scgms::TFilter_Profile &profile) const noexcept {
+	if (position >= mProfiles.size()) {
+		return false;
+	}
+
+	mProfiles[position]->Get(profile);
+	return true;
+}
+
+void CChain_Profiler::Dump() {
+	if (mOutput_Path.empty() || mDumped.exchange(true)) {
+		return;
+	}
+
+	std::vector<scgms::TFilter_Profile> profiles(mProfiles.size());
+	for (size_t i = 0; i < mProfiles.size(); i++) {
+		mProfiles[i]->Get(profiles[i]);
+	}
+
+	Dump_CSV(profiles);
+	Dump_JSON(profiles);
+}
+
+void CChain_Profiler::Dump_CSV(const std::vector<scgms::TFilter_Profile> &profiles) const {
+	std::ofstream dst{ mOutput_Path + ".csv" };
+	if (!dst.is_open()) {
+		return;
+	}
+
+	//just the event codes, which any of the filters received, get their columns
+	std::vector<size_t> event_codes;
+	for (size_t code = 0; code < static_cast<size_t>(scgms::NDevice_Event_Code::count); code++) {
+		if (std::any_of(profiles.begin(), profiles.end(), [code](const scgms::TFilter_Profile &profile) { return profile.event_counts[code] > 0; })) {
+			event_codes.push_back(code);
+		}
+	}
+
+	dst << "position;filter;calls;inclusive_ns;exclusive_ns;inclusive_p50_ns;inclusive_p99_ns;exclusive_p50_ns;exclusive_p99_ns";
+	for (const auto code : event_codes) {
+		dst << ';' << Narrow_WString(scgms::event_code_text[code]);
+	}
+	dst << std::endl;
+
+	for (size_t i = 0; i < profiles.size(); i++) {
+		const auto &profile = profiles[i];
+		dst << i << ';' << Filter_Name(profile.filter_id) << ';' << profile.call_count << ';' << profile.inclusive_time << ';' << profile.exclusive_time
+			<< ';' << Histogram_Quantile(profile.inclusive_histogram, 0.5) << ';' << Histogram_Quantile(profile.inclusive_histogram, 0.99)
+			<< ';' << Histogram_Quantile(profile.exclusive_histogram, 0.5) << ';' << Histogram_Quantile(profile.exclusive_histogram, 0.99);
+		for (const auto code : event_codes) {
+			dst << ';' << profile.event_counts[code];
+		}
+		dst << std::endl;
+	}
+}
+
+void CChain_Profiler::Dump_JSON(const std::vector<scgms::TFilter_Profile> &profiles) const {
+	std::ofstream dst{ mOutput_Path + ".json" };
+	if (!dst.is_open()) {
+		return;
+	}
+
+	dst << "{\n\t\"histogram_buckets\": \"i-th bucket counts the calls taking [2^i, 2^(i+1)) ns\",\n\t\"filters\": [";
+	for (size_t i = 0; i < profiles.size(); i++) {
+		const auto &profile = profiles[i];
+		dst << (i > 0 ? "," : "") << "\n\t\t{\n";
+		dst << "\t\t\t\"position\": " << i << ",\n";
+		dst << "\t\t\t\"id\": " << JSON_String(Narrow_WString(GUID_To_WString(profile.filter_id))) << ",\n";
+		dst << "\t\t\t\"filter\": " << JSON_String(Filter_Name(profile.filter_id)) << ",\n";
+		dst << "\t\t\t\"calls\": " << profile.call_count << ",\n";
+		dst << "\t\t\t\"inclusive_ns\": " << profile.inclusive_time << ",\n";
+		dst << "\t\t\t\"exclusive_ns\": " << profile.exclusive_time << ",\n";
+
+		dst << "\t\t\t\"events\": {";
+		bool first_code = true;
+		for (size_t code = 0; code < static_cast<size_t>(scgms::NDevice_Event_Code::count); code++) {
+			if (profile.event_counts[code] > 0) {
+				dst << (first_code ? " " : ", ") << JSON_String(Narrow_WString(scgms::event_code_text[code])) << ": " << profile.event_counts[code];
+				first_code = false;
+			}
+		}
+		dst << " },\n";
+
+		dst << "\t\t\t\"inclusive_histogram\": ";
+		Write_JSON_Array(dst, profile.inclusive_histogram);
+		dst << ",\n\t\t\t\"exclusive_histogram\": ";
+		Write_JSON_Array(dst, profile.exclusive_histogram);
+		dst << "\n\t\t}";
+	}
+	dst << "\n\t]\n}" << std::endl;
+}
+
+HRESULT IfaceCalling CChain_Profiler::Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) {
+	return S_OK;
+}
+
+HRESULT IfaceCalling CChain_Profiler::Execute(scgms::IDevice_Event *event) {
+	scgms::TDevice_Event *raw_event;
+	const bool shut_down = (event->Raw(&raw_event) == S_OK) && (raw_event->event_code == scgms::NDevice_Event_Code::Shut_Down);
+
+	const HRESULT rc = mNext_Filter->Execute(event);
+	if (shut_down) {
+		Dump();
+	}
+
+	return rc;
+}
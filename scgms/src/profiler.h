@@ -0,0 +1,120 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#pragma once
+
+#include <scgms/rtl/FilterLib.h>
+#include <scgms/iface/FilterExtIface.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+//execution statistics of a single filter of the chain
+//the counters are updated by the thread, which holds the filter's communication guard, but may be read anytime
+class CFilter_Profile {
+	protected:
+		const GUID mFilter_Id;
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(scgms::NDevice_Event_Code::count)> mEvent_Counts{};
+		std::atomic<uint64_t> mCall_Count{ 0 };
+		std::atomic<uint64_t> mInclusive_Time{ 0 };
+		std::atomic<uint64_t> mExclusive_Time{ 0 };
+		std::array<std::atomic<uint64_t>, scgms::Profile_Histogram_Bucket_Count> mInclusive_Histogram{};
+		std::array<std::atomic<uint64_t>, scgms::Profile_Histogram_Bucket_Count> mExclusive_Histogram{};
+
+	public:
+		CFilter_Profile(const GUID &filter_id) noexcept : mFilter_Id(filter_id) {};
+
+		void Count_Event(scgms::IDevice_Event *event) noexcept;
+		void Record_Call(const uint64_t inclusive_time, const uint64_t exclusive_time) noexcept;
+
+		void Get(scgms::TFilter_Profile &profile) const noexcept;
+};
+
+//measures a single call of a filter; as the filters call the downstream ones synchronously,
+//the calls nest and each of them subtracts the time of the nested ones to get the exclusive time
+class CProfiled_Call {
+	protected:
+		using TClock = std::chrono::steady_clock;
+
+		static thread_local CProfiled_Call* mCurrent_Call;
+
+		CFilter_Profile &mProfile;
+		CProfiled_Call *mOuter_Call;
+		const TClock::time_point mStart;
+		uint64_t mNested_Time = 0;
+
+	public:
+		CProfiled_Call(CFilter_Profile &profile) noexcept;
+		~CProfiled_Call();
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
+
+//holds the profiles of all filters of a chain; it is also the filter appended to the chain's end,
+//so that it can dump the profiles once the shut down event passes the entire chain
+class CChain_Profiler : public virtual scgms::IFilter, public virtual refcnt::CNotReferenced {
+	protected:
+		const std::string mOutput_Path;	//without the extension; empty to not dump at all
+		scgms::IFilter *mNext_Filter = nullptr;
+		std::vector<std::unique_ptr<CFilter_Profile>> mProfiles;
+		std::atomic<bool> mDumped{ false };
+
+		void Dump_CSV(const std::vector<scgms::TFilter_Profile> &profiles) const;
+		void Dump_JSON(const std::vector<scgms::TFilter_Profile> &profiles) const;
+
+	public:
+		CChain_Profiler(const std::string &output_path, scgms::IFilter *next_filter);
+		virtual ~CChain_Profiler() = default;
+
+		//the chain is built from its last filter, so are the profiles
+		CFilter_Profile* Prepend_Filter(const GUID &filter_id);
+
+		size_t Filter_Count() const noexcept { return mProfiles.size(); };
+		bool Get_Profile(const size_t position, scgms::TFilter_Profile &profile) const noexcept;
+
+		void Dump();	//just once
+
+		// scgms::IFilter iface
+		virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) override final;
+		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final;
+};
+
+#pragma warning( pop )
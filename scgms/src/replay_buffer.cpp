@@ -0,0 +1,163 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#include "replay_buffer.h"
+#include "device_event.h"
+
+#include <scgms/rtl/DeviceLib.h>
+#include <scgms/rtl/referencedImpl.h>
+
+#include <cmath>
+
+uint32_t CReplay_Buffer::Intern_GUID(const GUID& id) {
+	const auto iter = mGUID_Index.find(id);
+	if (iter != mGUID_Index.end()) {
+		return iter->second;
+	}
+
+	const uint32_t index = static_cast<uint32_t>(mGUIDs.size());
+	mGUIDs.push_back(id);
+	mGUID_Index[id] = index;
+	return index;
+}
+
+uint32_t CReplay_Buffer::Intern_Parameters(scgms::IModel_Parameter_Vector* parameters) {
+	if (!parameters) {
+		return No_Parameters;
+	}
+
+	double *begin, *end;
+	std::vector<double> values;
+	if (parameters->get(&begin, &end) == S_OK) {
+		values.assign(begin, end);
+	}
+
+	const auto iter = mParameter_Set_Index.find(values);
+	if (iter != mParameter_Set_Index.end()) {
+		return iter->second;
+	}
+
+	const uint32_t index = static_cast<uint32_t>(mParameter_Sets.size());
+	mParameter_Sets.push_back(values);
+	mParameter_Set_Index[std::move(values)] = index;
+	return index;
+}
+
+bool CReplay_Buffer::Append(const scgms::TDevice_Event& event) {
+	uint32_t parameters = No_Parameters;
+	double level = std::numeric_limits<double>::quiet_NaN();
+
+	switch (scgms::UDevice_Event_internal::major_type(event.event_code)) {
+		case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::info:
+			return false;
+
+		case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::parameters:
+			parameters = Intern_Parameters(event.parameters);
+			break;
+
+		default:
+			level = event.level;
+			break;
+	}
+
+	mEvent_Codes.push_back(event.event_code);
+	mDevice_Times.push_back(event.device_time);
+	mSegment_Ids.push_back(event.segment_id);
+	mDevice_Ids.push_back(Intern_GUID(event.device_id));
+	mSignal_Ids.push_back(Intern_GUID(event.signal_id));
+	mLevels.push_back(level);
+	mParameters.push_back(parameters);
+
+	return true;
+}
+
+void CReplay_Buffer::Seal() {
+	mGUID_Index.clear();
+	mParameter_Set_Index.clear();
+
+	mEvent_Codes.shrink_to_fit();
+	mDevice_Times.shrink_to_fit();
+	mSegment_Ids.shrink_to_fit();
+	mDevice_Ids.shrink_to_fit();
+	mSignal_Ids.shrink_to_fit();
+	mLevels.shrink_to_fit();
+	mParameters.shrink_to_fit();
+}
+
+void CReplay_Buffer::Clear() {
+	mEvent_Codes.clear();
+	mDevice_Times.clear();
+	mSegment_Ids.clear();
+	mDevice_Ids.clear();
+	mSignal_Ids.clear();
+	mLevels.clear();
+	mParameters.clear();
+
+	mGUIDs.clear();
+	mParameter_Sets.clear();
+	mGUID_Index.clear();
+	mParameter_Set_Index.clear();
+}
+
+HRESULT CReplay_Buffer::Materialize(const size_t index, scgms::IDevice_Event** event) const noexcept {
+	if (index >= mEvent_Codes.size()) {
+		return E_INVALIDARG;
+	}
+
+	scgms::TDevice_Event raw;
+	raw.event_code = mEvent_Codes[index];
+	raw.device_id = mGUIDs[mDevice_Ids[index]];
+	raw.signal_id = mGUIDs[mSignal_Ids[index]];
+	raw.device_time = mDevice_Times[index];
+	raw.logical_time = Tick_Logical_Clock();	//each replay is a new event, just like a clone of the original one
+	raw.segment_id = mSegment_Ids[index];
+
+	if (scgms::UDevice_Event_internal::major_type(raw.event_code) == scgms::UDevice_Event_internal::NDevice_Event_Major_Type::parameters) {
+		raw.parameters = nullptr;
+		if (mParameters[index] != No_Parameters) {
+			//copied to the storage of the event's slot, which reuses it for its subsequent parameters events
+			const auto& values = mParameter_Sets[mParameters[index]];
+			*event = allocate_device_event(raw, values.data(), values.data() + values.size());
+			return *event ? S_OK : E_OUTOFMEMORY;
+		}
+	}
+	else {
+		raw.level = mLevels[index];
+	}
+
+	*event = allocate_device_event(raw);
+	return *event ? S_OK : E_OUTOFMEMORY;
+}
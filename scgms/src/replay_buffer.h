@@ -0,0 +1,88 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#pragma once
+
+#include <scgms/rtl/FilterLib.h>
+
+#include <limits>
+#include <map>
+#include <vector>
+
+//immutable, once filled, copy of the events to replay, which all the optimizing chains share
+//the events are stored column-wise and their GUIDs and parameters are interned, so that the buffer occupies as little memory as possible
+//info events are not stored, because the optimizer does not replay them
+class CReplay_Buffer {
+	protected:
+		static constexpr uint32_t No_Parameters = std::numeric_limits<uint32_t>::max();
+
+		std::vector<scgms::NDevice_Event_Code> mEvent_Codes;
+		std::vector<double> mDevice_Times;
+		std::vector<uint64_t> mSegment_Ids;
+		std::vector<uint32_t> mDevice_Ids, mSignal_Ids;	//indices to mGUIDs
+		std::vector<double> mLevels;						//NaN for the parameters events
+		std::vector<uint32_t> mParameters;				//indices to mParameter_Sets, No_Parameters for the other events
+
+		std::vector<GUID> mGUIDs;
+		std::vector<std::vector<double>> mParameter_Sets;
+
+		//used to intern the values until the buffer is sealed
+		std::map<GUID, uint32_t> mGUID_Index;
+		std::map<std::vector<double>, uint32_t> mParameter_Set_Index;
+
+		uint32_t Intern_GUID(const GUID& id);
+		uint32_t Intern_Parameters(scgms::IModel_Parameter_Vector* parameters);
+
+	public:
+		bool Append(const scgms::TDevice_Event& event);	//false, if it is an info event
+		void Seal();	//no more events will be appended
+		void Clear();
+
+		size_t size() const {
+			return mEvent_Codes.size();
+		}
+
+		bool empty() const {
+			return mEvent_Codes.empty();
+		}
+
+		scgms::NDevice_Event_Code Event_Code(const size_t index) const {
+			return mEvent_Codes[index];
+		}
+
+		//creates the index-th event from the pool, with its own copy of the parameters as the filters may modify them
+		HRESULT Materialize(const size_t index, scgms::IDevice_Event** event) const noexcept;
+};
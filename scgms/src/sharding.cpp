@@ -0,0 +1,251 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#include "sharding.h"
+
+CShard_Router::CShard_Router(std::recursive_mutex &communication_guard, CShard_Merge &merge) : mCommunication_Guard(communication_guard), mMerge(merge) {
+	//
+}
+
+void CShard_Router::Add_Shard(scgms::IFilter *shard_entry) {
+	mShards.push_back(shard_entry);
+}
+
+size_t CShard_Router::Shard_Of(const uint64_t segment_id) const noexcept {
+	//the segment ids are mostly consecutive numbers, so we mix them to spread them evenly regardless the shard count
+	uint64_t hash = segment_id + 0x9e3779b97f4a7c15ULL;
+	hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+	hash ^= hash >> 31;
+
+	return static_cast<size_t>(hash % mShards.size());
+}
+
+HRESULT CShard_Router::Broadcast(scgms::IDevice_Event *event) {
+	HRESULT rc = S_OK;
+
+	//the other shards get the clones, the first one gets the original
+	std::vector<scgms::IDevice_Event*> copies(mShards.size(), nullptr);
+	copies[0] = event;
+	for (size_t i = 1; i < mShards.size(); i++) {
+		const HRESULT clone_rc = event->Clone(&copies[i]);
+		if (!Succeeded(clone_rc)) {
+			copies[i] = nullptr;
+			rc = clone_rc;
+		}
+	}
+
+	//the merge must know all the copies before any shard can deliver one of them
+	std::vector<int64_t> logical_times;
+	for (auto copy : copies) {
+		scgms::TDevice_Event *raw_copy;
+		if (copy && (copy->Raw(&raw_copy) == S_OK)) {
+			logical_times.push_back(raw_copy->logical_time);
+		}
+	}
+	mMerge.Expect_Broadcast(logical_times);
+
+	for (size_t i = 0; i < copies.size(); i++) {
+		if (copies[i]) {
+			const HRESULT copy_rc = mShards[i]->Execute(copies[i]);
+			if (!Succeeded(copy_rc)) {
+				rc = copy_rc;
+			}
+		}
+	}
+
+	return rc;
+}
+
+HRESULT IfaceCalling CShard_Router::Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) {
+	return S_OK;
+}
+
+HRESULT IfaceCalling CShard_Router::Execute(scgms::IDevice_Event *event) {
+	if (!event) {
+		return E_INVALIDARG;
+	}
+
+	scgms::TDevice_Event *raw_event;
+	const HRESULT rc = event->Raw(&raw_event);
+	if (rc != S_OK) {
+		event->Release();
+		return rc;
+	}
+
+	std::lock_guard<std::recursive_mutex> guard{ mCommunication_Guard };
+
+	const bool broadcast = (raw_event->segment_id == scgms::All_Segments_Id)
+		|| (raw_event->event_code == scgms::NDevice_Event_Code::Shut_Down)
+		|| (raw_event->event_code == scgms::NDevice_Event_Code::Warm_Reset);
+
+	return broadcast ? Broadcast(event) : mShards[Shard_Of(raw_event->segment_id)]->Execute(event);
+}
+
+
+CShard_Merge::CShard_Merge(scgms::IFilter *next_filter) : mNext_Filter(next_filter) {
+	//
+}
+
+CShard_Merge::~CShard_Merge() {
+	//the broadcasts, which have not been settled, are never forwarded
+	for (auto &broadcast : mBroadcasts) {
+		if (broadcast.second.delivered) {
+			broadcast.second.delivered->Release();
+		}
+	}
+}
+
+void CShard_Merge::Add_Shard() {
+	mShard_Count++;
+}
+
+void CShard_Merge::Expect_Broadcast(const std::vector<int64_t> &logical_times) {
+	if (logical_times.empty()) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard{ mMerge_Guard };
+
+	const size_t broadcast = mNext_Broadcast++;
+	for (const int64_t logical_time : logical_times) {
+		mBroadcast_Copies[logical_time] = broadcast;
+	}
+	mBroadcasts[broadcast].pending_copies = logical_times.size();
+}
+
+std::optional<size_t> CShard_Merge::Broadcast_Of(const int64_t logical_time) {
+	std::lock_guard<std::mutex> guard{ mMerge_Guard };
+
+	const auto copy = mBroadcast_Copies.find(logical_time);
+	if (copy == mBroadcast_Copies.end()) {
+		return std::nullopt;
+	}
+
+	return copy->second;
+}
+
+void CShard_Merge::Settle_Copy(const size_t broadcast, const int64_t logical_time) {
+	scgms::IDevice_Event *delivered = nullptr;
+	{
+		std::lock_guard<std::mutex> guard{ mMerge_Guard };
+
+		mBroadcast_Copies.erase(logical_time);	//the shard has dropped, consumed or replaced the copy, if it is still there
+
+		const auto settled = mBroadcasts.find(broadcast);
+		if ((settled == mBroadcasts.end()) || (--settled->second.pending_copies > 0)) {
+			return;	//the other shards are still processing their copies
+		}
+
+		delivered = settled->second.delivered;
+		mBroadcasts.erase(settled);
+	}
+
+	if (delivered) {
+		Forward(delivered);	//nobody to report the error to, as the shard's worker has settled the copy
+	}
+}
+
+HRESULT CShard_Merge::Forward(scgms::IDevice_Event *event) {
+	std::lock_guard<std::recursive_mutex> guard{ mForward_Guard };
+	return mNext_Filter->Execute(event);
+}
+
+HRESULT IfaceCalling CShard_Merge::Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) {
+	return S_OK;
+}
+
+HRESULT IfaceCalling CShard_Merge::Execute(scgms::IDevice_Event *event) {
+	if (!event) {
+		return E_INVALIDARG;
+	}
+
+	scgms::TDevice_Event *raw_event;
+	if (event->Raw(&raw_event) == S_OK) {
+		std::lock_guard<std::mutex> guard{ mMerge_Guard };
+
+		const auto copy = mBroadcast_Copies.find(raw_event->logical_time);
+		if (copy != mBroadcast_Copies.end()) {
+			auto &broadcast = mBroadcasts[copy->second];
+			mBroadcast_Copies.erase(copy);
+
+			//the broadcast goes on, once all the shards have settled their copies
+			if (!broadcast.delivered) {
+				broadcast.delivered = event;
+			}
+			else {
+				event->Release();
+			}
+
+			return S_OK;
+		}
+	}
+
+	return Forward(event);
+}
+
+
+CShard_Entry::CShard_Entry(scgms::IFilter *shard_entry, CShard_Merge &merge) : mShard_Entry(shard_entry), mMerge(merge) {
+	//
+}
+
+HRESULT IfaceCalling CShard_Entry::Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) {
+	return S_OK;
+}
+
+HRESULT IfaceCalling CShard_Entry::Execute(scgms::IDevice_Event *event) {
+	if (!event) {
+		return E_INVALIDARG;
+	}
+
+	//the event may be gone, once the shard has processed it
+	int64_t logical_time = 0;
+	std::optional<size_t> broadcast;
+	scgms::TDevice_Event *raw_event;
+	if (event->Raw(&raw_event) == S_OK) {
+		logical_time = raw_event->logical_time;
+		broadcast = mMerge.Broadcast_Of(logical_time);
+	}
+
+	const HRESULT rc = mShard_Entry->Execute(event);
+
+	//the shard is synchronous, so that it has processed the copy entirely by now
+	if (broadcast) {
+		mMerge.Settle_Copy(*broadcast, logical_time);
+	}
+
+	return rc;
+}
@@ -0,0 +1,125 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#pragma once
+
+#include <scgms/rtl/FilterLib.h>
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#pragma warning( push )
+#pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
+
+class CShard_Merge;
+
+//distributes the events among the replicas (shards) of the chain body by their segment id
+//events of all segments and the control events go to every shard
+class CShard_Router : public virtual scgms::IFilter, public virtual refcnt::CNotReferenced {
+	protected:
+		std::recursive_mutex &mCommunication_Guard;	//the filter sending to us is not guarded by an executor
+		std::vector<scgms::IFilter*> mShards;
+		CShard_Merge &mMerge;
+
+		size_t Shard_Of(const uint64_t segment_id) const noexcept;
+		HRESULT Broadcast(scgms::IDevice_Event *event);
+
+	public:
+		CShard_Router(std::recursive_mutex &communication_guard, CShard_Merge &merge);
+		virtual ~CShard_Router() = default;
+
+		void Add_Shard(scgms::IFilter *shard_entry);	//permitted while the chain is being built only
+
+		// scgms::IFilter iface
+		virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) override final;
+		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final;
+};
+
+//serializes the events of all shards into the rest of the chain
+//passes each broadcast event just once, when all the shards have processed their copies
+//a shard may drop, consume or replace its copy, so that the copies are counted by the shards' entries, not by their arrivals
+class CShard_Merge : public virtual scgms::IFilter, public virtual refcnt::CNotReferenced {
+	protected:
+		struct TBroadcast {
+			size_t pending_copies = 0;						//copies still processed by the shards
+			scgms::IDevice_Event *delivered = nullptr;		//the first copy, which a shard has delivered, the others are dropped
+		};
+
+		std::mutex mMerge_Guard;					//guards the broadcasts only, it is never held while calling another filter
+		std::recursive_mutex mForward_Guard;		//serializes the shards' events into the next filter
+		scgms::IFilter *mNext_Filter;
+		size_t mShard_Count = 0;
+
+		std::map<int64_t, size_t> mBroadcast_Copies;	//logical time of a copy, which has not arrived yet, to its broadcast
+		std::map<size_t, TBroadcast> mBroadcasts;
+		size_t mNext_Broadcast = 0;
+
+		HRESULT Forward(scgms::IDevice_Event *event);
+
+	public:
+		CShard_Merge(scgms::IFilter *next_filter);
+		virtual ~CShard_Merge();
+
+		void Add_Shard();	//permitted while the chain is being built only
+		void Expect_Broadcast(const std::vector<int64_t> &logical_times);	//the router calls it before it sends the copies
+
+		//the shard's entry picks the broadcast of a copy before the shard's filters can change it, and settles it once the shard has processed it
+		std::optional<size_t> Broadcast_Of(const int64_t logical_time);
+		void Settle_Copy(const size_t broadcast, const int64_t logical_time);
+
+		// scgms::IFilter iface
+		virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) override final;
+		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final;
+};
+
+//the first filter of a shard, called by the shard's worker; tells the merge, when the shard has processed a broadcast copy
+class CShard_Entry : public virtual scgms::IFilter, public virtual refcnt::CNotReferenced {
+	protected:
+		scgms::IFilter *mShard_Entry;
+		CShard_Merge &mMerge;
+
+	public:
+		CShard_Entry(scgms::IFilter *shard_entry, CShard_Merge &merge);
+		virtual ~CShard_Entry() = default;
+
+		// scgms::IFilter iface
+		virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) override final;
+		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final;
+};
+
+#pragma warning( pop )
@@ -41,62 +41,74 @@
 #include <scgms/rtl/referencedImpl.h>
 
 #include "filter_configuration_executor.h"
+#include "simple_bindings.h"
+#include "device_event.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #pragma warning( push )
 #pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
 
 class CSimple_SCGMS_Execution : public virtual scgms::IFilter, public virtual refcnt::CNotReferenced {
 	protected:
-		TSCGMS_Execution_Callback mCallback;
+		//copies of the output events, whose pointers are resolved just before the batch is passed to the host
+		struct TEvent_Batch {
+			std::vector<TSCGMS_Event_Data> events;
+			std::vector<size_t> parameters_offsets;	//to parameters, for each event
+			std::vector<double> parameters;
+			std::vector<std::wstring> strings;		//for each event, empty unless it is an info event
+
+			void clear() {
+				events.clear();
+				parameters_offsets.clear();
+				parameters.clear();
+				strings.clear();
+			}
+		};
+
+		static constexpr size_t Default_Max_Batch_Size = 256;
+
+		TSCGMS_Execution_Callback mCallback = nullptr;
+		TSCGMS_Execution_Batch_Callback mBatch_Callback = nullptr;
+		size_t mMax_Batch_Size = Default_Max_Batch_Size;
+		std::chrono::milliseconds mFlush_Interval{ 0 };
+
+		//declared before the executor, as it may still emit events while being destroyed
+		std::mutex mBatch_Guard;
+		TEvent_Batch mBatch, mSpare_Batch;
+		std::chrono::steady_clock::time_point mBatch_Started;
+		//the full batches in the order of their events; a single thread at a time passes them to the host, without holding any lock,
+		//so that the callback may inject further events, while the batches stay ordered
+		std::deque<TEvent_Batch> mFull_Batches;
+		bool mDelivering = false;
+		std::condition_variable mDelivered;
+		std::atomic<HRESULT> mFlusher_Result{ S_OK };
+
+		bool mStop_Flusher = false;
+		std::condition_variable mFlusher_Wake;
+		std::unique_ptr<std::thread> mFlusher;
+
 		scgms::SFilter_Executor mExecutor;
 		refcnt::Swstr_list mErrors;
 
-	public:
-		CSimple_SCGMS_Execution(TSCGMS_Execution_Callback callback) : mCallback(callback) {
-		}
-
-		~CSimple_SCGMS_Execution() {
-			if (mCallback && (mErrors->empty() != S_OK)) {
-				TSCGMS_Event_Data err;
-				memset(&err, 0, sizeof(err));
-
-				err.device_time = std::numeric_limits<double>::quiet_NaN();
-				err.event_code = static_cast<decltype(err.event_code)>(scgms::NDevice_Event_Code::Error);
-
-				refcnt::wstr_container *wstr;
-				while (mErrors->pop(&wstr) == S_OK) {
-					const auto err_str = refcnt::WChar_Container_To_WString(wstr);
-					err.str = const_cast<wchar_t*>(err_str.c_str());
-					mCallback(&err);
-					wstr->Release();
-				}
+		void Emit(TSCGMS_Event_Data &simple_event) {
+			if (mBatch_Callback) {
+				mBatch_Callback(&simple_event, 1);
 			}
-		}
-
-		bool Execute_Configuration(const char* config, scgms::TOn_Filter_Created filterCreatedCallback = nullptr, const void* filterCreatedCallbackData = nullptr) {
-
-			mErrors = refcnt::Swstr_list{};
-			scgms::SPersistent_Filter_Chain_Configuration configuration{};
-
-			if (configuration->Load_From_Memory(config, strlen(config), mErrors.get()) == S_OK) {
-				scgms::IFilter_Executor *executor;
-				if (execute_filter_configuration(configuration.get(), filterCreatedCallback, filterCreatedCallbackData, mCallback ? this : nullptr, &executor, mErrors.get()) == S_OK) {
-					mExecutor.reset(executor, [](scgms::IFilter_Executor* obj_to_release) { if (obj_to_release != nullptr) obj_to_release->Release(); });
-				}
+			else if (mCallback) {
+				mCallback(&simple_event);
 			}
-
-			return mExecutor.operator bool();
 		}
 
-		virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list *error_description) override final {
-			return E_NOTIMPL;
-		}
-
-		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final {
-			TSCGMS_Event_Data simple_event;
+		//fills the simple event with the values of the event, parameters point to the event, while the info is copied to info_str
+		void Convert_Event(scgms::IDevice_Event *event, TSCGMS_Event_Data &simple_event, std::wstring &info_str) {
 			scgms::TDevice_Event *raw_event;
 			memset(&simple_event, 0, sizeof(simple_event));
-			std::wstring info_str;
 
 			if (event->Raw(&raw_event) == S_OK) {
 				simple_event.event_code = static_cast<decltype(simple_event.event_code)>(raw_event->event_code);
@@ -104,7 +116,7 @@ class CSimple_SCGMS_Execution : public virtual scgms::IFilter, public virtual re
 				simple_event.signal_id = raw_event->signal_id;
 			
 				simple_event.device_time = raw_event->device_time;
-				simple_event.logical_time = raw_event->logical_time;
+				simple_event.logical_time = CLogical_Clock::Counter_Of(raw_event->logical_time);	//without the clock's domain
 				simple_event.segment_id = raw_event->segment_id;
 
 				simple_event.parameters = nullptr;
@@ -136,6 +148,219 @@ class CSimple_SCGMS_Execution : public virtual scgms::IFilter, public virtual re
 						break;
 				}
 			}
+		}
+
+		HRESULT Execute_Batched(scgms::IDevice_Event *event) {
+			TSCGMS_Event_Data simple_event;
+			std::wstring info_str;
+			Convert_Event(event, simple_event, info_str);
+
+			bool flush = false;
+			{
+				std::lock_guard<std::mutex> lock{ mBatch_Guard };
+
+				if (mBatch.events.empty()) {
+					mBatch_Started = std::chrono::steady_clock::now();
+					if (mFlusher) {
+						mFlusher_Wake.notify_one();
+					}
+				}
+
+				mBatch.parameters_offsets.push_back(mBatch.parameters.size());
+				if (simple_event.parameters) {
+					mBatch.parameters.insert(mBatch.parameters.end(), simple_event.parameters, simple_event.parameters + simple_event.count);
+				}
+				mBatch.strings.push_back(std::move(info_str));
+
+				simple_event.parameters = nullptr;
+				simple_event.str = nullptr;
+				mBatch.events.push_back(simple_event);
+
+				//no other event follows the shut down, so the batch would have to wait for the timer or, without it, for Shutdown_SCGMS
+				flush = (mBatch.events.size() >= mMax_Batch_Size) || (simple_event.event_code == static_cast<decltype(simple_event.event_code)>(scgms::NDevice_Event_Code::Shut_Down));
+			}
+
+			event->Release();
+
+			//report a failure of the flusher thread with the next event
+			HRESULT rc = mFlusher_Result.exchange(S_OK);
+			if (flush) {
+				const HRESULT flush_rc = Flush_Batch();
+				if (Succeeded(rc)) {
+					rc = flush_rc;
+				}
+			}
+
+			return rc;
+		}
+
+		//passes the current batch to the host, unless another thread (or the callback calling us back) is passing the batches already;
+		//then, that one passes the current batch too, once it is done with the previous ones
+		HRESULT Flush_Batch() {
+			std::unique_lock<std::mutex> lock{ mBatch_Guard };
+			if (!mBatch.events.empty()) {
+				mFull_Batches.emplace_back();
+				std::swap(mFull_Batches.back(), mBatch);
+				std::swap(mBatch, mSpare_Batch);	//to reuse the already allocated memory
+			}
+
+			if (mDelivering) {
+				return S_OK;
+			}
+			mDelivering = true;
+
+			HRESULT rc = S_OK;
+			while (!mFull_Batches.empty()) {
+				TEvent_Batch batch = std::move(mFull_Batches.front());
+				mFull_Batches.pop_front();
+				lock.unlock();
+
+				for (size_t i = 0; i < batch.events.size(); i++) {
+					auto &simple_event = batch.events[i];
+					const auto code = static_cast<scgms::NDevice_Event_Code>(simple_event.event_code);
+					switch (scgms::UDevice_Event_internal::major_type(code)) {
+						case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::parameters:
+							if (simple_event.count > 0) {
+								simple_event.parameters = batch.parameters.data() + batch.parameters_offsets[i];
+							}
+							break;
+
+						case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::info:
+							simple_event.str = const_cast<wchar_t*>(batch.strings[i].c_str());
+							break;
+
+						default:
+							break;
+					}
+				}
+
+				const HRESULT batch_rc = mBatch_Callback(batch.events.data(), batch.events.size());
+				if (Succeeded(rc)) {
+					rc = batch_rc;
+				}
+
+				batch.clear();
+				lock.lock();
+				if (mSpare_Batch.events.capacity() < batch.events.capacity()) {
+					std::swap(mSpare_Batch, batch);
+				}
+			}
+
+			mDelivering = false;
+			mDelivered.notify_all();
+
+			return rc;
+		}
+
+		//passes all the batches, including those already being passed by another thread
+		void Flush_All_Batches() {
+			Flush_Batch();
+
+			std::unique_lock<std::mutex> lock{ mBatch_Guard };
+			mDelivered.wait(lock, [this]() { return !mDelivering; });
+		}
+
+		void Flusher() {
+			std::unique_lock<std::mutex> lock{ mBatch_Guard };
+
+			while (!mStop_Flusher) {
+				if (mBatch.events.empty()) {
+					mFlusher_Wake.wait(lock);
+					continue;
+				}
+
+				const auto deadline = mBatch_Started + mFlush_Interval;
+				if (std::chrono::steady_clock::now() < deadline) {
+					mFlusher_Wake.wait_until(lock, deadline);
+					continue;
+				}
+
+				lock.unlock();
+				const HRESULT rc = Flush_Batch();
+				if (!Succeeded(rc)) {
+					mFlusher_Result = rc;
+				}
+				lock.lock();
+			}
+		}
+
+		void Stop_Flusher() {
+			if (mFlusher) {
+				{
+					std::lock_guard<std::mutex> lock{ mBatch_Guard };
+					mStop_Flusher = true;
+				}
+				mFlusher_Wake.notify_all();
+
+				if (mFlusher->joinable()) {
+					mFlusher->join();
+				}
+				mFlusher.reset();
+			}
+		}
+
+	public:
+		CSimple_SCGMS_Execution(TSCGMS_Execution_Callback callback) : mCallback(callback) {
+		}
+
+		CSimple_SCGMS_Execution(TSCGMS_Execution_Batch_Callback callback, const size_t max_batch_size, const uint32_t flush_interval_ms) :
+			mBatch_Callback(callback), mMax_Batch_Size(max_batch_size > 0 ? max_batch_size : Default_Max_Batch_Size), mFlush_Interval(flush_interval_ms) {
+
+			if (mBatch_Callback && (mFlush_Interval.count() > 0)) {
+				mFlusher = std::make_unique<std::thread>(&CSimple_SCGMS_Execution::Flusher, this);
+			}
+		}
+
+		~CSimple_SCGMS_Execution() {
+			Stop_Flusher();
+			if (mBatch_Callback) {
+				Flush_All_Batches();
+			}
+
+			if ((mCallback || mBatch_Callback) && (mErrors->empty() != S_OK)) {
+				TSCGMS_Event_Data err;
+				memset(&err, 0, sizeof(err));
+
+				err.device_time = std::numeric_limits<double>::quiet_NaN();
+				err.event_code = static_cast<decltype(err.event_code)>(scgms::NDevice_Event_Code::Error);
+
+				refcnt::wstr_container *wstr;
+				while (mErrors->pop(&wstr) == S_OK) {
+					const auto err_str = refcnt::WChar_Container_To_WString(wstr);
+					err.str = const_cast<wchar_t*>(err_str.c_str());
+					Emit(err);
+					wstr->Release();
+				}
+			}
+		}
+
+		bool Execute_Configuration(const char* config, scgms::TOn_Filter_Created filterCreatedCallback = nullptr, const void* filterCreatedCallbackData = nullptr) {
+
+			mErrors = refcnt::Swstr_list{};
+			scgms::SPersistent_Filter_Chain_Configuration configuration{};
+
+			if (configuration->Load_From_Memory(config, strlen(config), mErrors.get()) == S_OK) {
+				scgms::IFilter_Executor *executor;
+				if (execute_filter_configuration(configuration.get(), filterCreatedCallback, filterCreatedCallbackData, (mCallback || mBatch_Callback) ? this : nullptr, &executor, mErrors.get()) == S_OK) {
+					mExecutor.reset(executor, [](scgms::IFilter_Executor* obj_to_release) { if (obj_to_release != nullptr) obj_to_release->Release(); });
+				}
+			}
+
+			return mExecutor.operator bool();
+		}
+
+		virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list *error_description) override final {
+			return E_NOTIMPL;
+		}
+
+		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final {
+			if (mBatch_Callback) {
+				return Execute_Batched(event);
+			}
+
+			TSCGMS_Event_Data simple_event;
+			std::wstring info_str;
+			Convert_Event(event, simple_event, info_str);
 
 			const HRESULT rc = mCallback(&simple_event);
 
@@ -154,8 +379,51 @@ class CSimple_SCGMS_Execution : public virtual scgms::IFilter, public virtual re
 			return mExecutor->Execute(raw_event);
 		}
 
+		HRESULT Inject_Simple_Event(const TSCGMS_Event_Data &simple_event) {
+			if (simple_event.event_code >= static_cast<std::underlying_type_t<scgms::NDevice_Event_Code>>(scgms::NDevice_Event_Code::count)) {
+				return E_INVALIDARG;
+			}
+
+			scgms::UDevice_Event event_to_send{ static_cast<scgms::NDevice_Event_Code>(simple_event.event_code) };
+			event_to_send.device_id() = simple_event.device_id;
+			event_to_send.signal_id() = simple_event.signal_id;
+
+			event_to_send.device_time() = simple_event.device_time;
+			event_to_send.segment_id() = simple_event.segment_id;
+
+			switch (scgms::UDevice_Event_internal::major_type(event_to_send.event_code())) {
+				case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::level:
+				{
+					event_to_send.level() = simple_event.level;
+					break;
+				}
+				case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::parameters:
+				{
+					event_to_send.parameters->add(simple_event.parameters, simple_event.parameters + simple_event.count);
+					break;
+				}
+				case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::info:
+				{
+					event_to_send.info.set(simple_event.str);
+					break;
+				}
+				default:
+					break;
+			}
+
+			return Inject_Event(event_to_send);
+		}
+
 		HRESULT Terminate(const BOOL wait_for_shutdown) {
-			return mExecutor->Terminate(wait_for_shutdown);
+			const HRESULT rc = mExecutor->Terminate(wait_for_shutdown);
+
+			//pass the events, which have been emitted so far
+			if (mBatch_Callback) {
+				Stop_Flusher();
+				Flush_All_Batches();
+			}
+
+			return rc;
 		}
 
 };
@@ -177,46 +445,48 @@ DLL_EXPORT scgms_execution_t SimpleCalling Execute_SCGMS_Configuration(const cha
 	return raw_result;
 }
 
+DLL_EXPORT scgms_execution_t SimpleCalling Execute_SCGMS_Configuration_Batched(const char *config, TSCGMS_Execution_Batch_Callback callback, scgms::TOn_Filter_Created filterCreatedCallback,
+																				const size_t max_batch_size, const uint32_t flush_interval_ms) {
+
+	std::unique_ptr<CSimple_SCGMS_Execution> result = std::make_unique<CSimple_SCGMS_Execution>(callback, max_batch_size, flush_interval_ms);
+
+	if (result) {
+		if (!result->Execute_Configuration(config, filterCreatedCallback)) {
+			result.reset();
+		}
+	}
+
+	CSimple_SCGMS_Execution* raw_result = result.get();
+	result.release();
+	return raw_result;
+}
+
 DLL_EXPORT BOOL SimpleCalling Inject_SCGMS_Event(const scgms_execution_t execution, const TSCGMS_Event_Data *simple_event) {
 
 	if (!execution || !simple_event) {
 		return FALSE;
 	}
 
-	if (simple_event->event_code >= static_cast<std::underlying_type_t<scgms::NDevice_Event_Code>>(scgms::NDevice_Event_Code::count)) {
+	CSimple_SCGMS_Execution* executor = static_cast<CSimple_SCGMS_Execution*>(execution);
+	
+	return Succeeded(executor->Inject_Simple_Event(*simple_event)) ? TRUE : FALSE;
+}
+
+DLL_EXPORT BOOL SimpleCalling Inject_SCGMS_Events(const scgms_execution_t execution, const TSCGMS_Event_Data *simple_events, const size_t count) {
+
+	if (!execution || (!simple_events && (count > 0))) {
 		return FALSE;
 	}
 
-	scgms::UDevice_Event event_to_send{ static_cast<scgms::NDevice_Event_Code>(simple_event->event_code) };
-	event_to_send.device_id() = simple_event->device_id;
-	event_to_send.signal_id() = simple_event->signal_id;
-
-	event_to_send.device_time() = simple_event->device_time;
-	event_to_send.segment_id() = simple_event->segment_id;
+	CSimple_SCGMS_Execution* executor = static_cast<CSimple_SCGMS_Execution*>(execution);
 
-	switch (scgms::UDevice_Event_internal::major_type(event_to_send.event_code())) {
-		case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::level:
-		{
-			event_to_send.level() = simple_event->level;
-			break;
-		}
-		case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::parameters:
-		{
-			event_to_send.parameters->add(simple_event->parameters, simple_event->parameters + simple_event->count);
-			break;
-		}
-		case scgms::UDevice_Event_internal::NDevice_Event_Major_Type::info:
-		{
-			event_to_send.info.set(simple_event->str);
-			break;
+	for (size_t i = 0; i < count; i++) {
+		if (!Succeeded(executor->Inject_Simple_Event(simple_events[i]))) {
+			return FALSE;
 		}
-		default:
-			break;
 	}
 
-	CSimple_SCGMS_Execution* executor = static_cast<CSimple_SCGMS_Execution*>(execution);
-	
-	return Succeeded(executor->Inject_Event(event_to_send)) ? TRUE : FALSE;
+	return TRUE;
 }
 
 DLL_EXPORT BOOL SimpleCalling Shutdown_SCGMS(const scgms_execution_t execution, BOOL wait_for_shutdown) {
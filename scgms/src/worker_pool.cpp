@@ -0,0 +1,386 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#include "worker_pool.h"
+
+#include <scgms/utils/winapi_mapping.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+	#define FORKED_WORKERS_SUPPORTED
+	#include <atomic>
+	#include <cerrno>
+	#include <ctime>
+	#include <semaphore.h>
+	#include <signal.h>
+	#include <sys/mman.h>
+	#include <sys/types.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+#endif
+
+namespace {
+	const char* rsOptimizer_Workers_Variable = "SCGMS_OPTIMIZER_WORKERS";
+
+	constexpr size_t Slots_Per_Worker = 2;		//so that a worker does not wait, while the optimizer picks the fitness up
+	constexpr size_t Shared_Alignment = 64;		//cache line
+
+	constexpr size_t Align(const size_t size) {
+		return (size + Shared_Alignment - 1) & ~(Shared_Alignment - 1);
+	}
+
+#ifdef FORKED_WORKERS_SUPPORTED
+	struct TShared_Header {
+		sem_t pending;						//number of the submitted, but not yet taken slots
+		std::atomic<size_t> taken{ 0 };		//ring position of the next slot to take
+		std::atomic<bool> shutdown{ false };
+	};
+
+	struct TShared_Slot {
+		sem_t done;
+		int32_t succeeded = 0;
+		solver::TFitness fitness;
+		//followed by the solution
+	};
+
+	static_assert(std::atomic<size_t>::is_always_lock_free && std::atomic<bool>::is_always_lock_free, "The workers need address-free atomics to share them.");
+
+	bool Wait_Semaphore(sem_t &semaphore) {
+		while (sem_wait(&semaphore) != 0) {
+			if (errno != EINTR) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	//a thread of this process could hold a lock, e.g.; of the allocator, which would never be released in the forked worker
+	bool Other_Threads_Running() {
+		std::ifstream status{ "/proc/self/status" };
+		std::string line;
+		while (std::getline(status, line)) {
+			if (line.rfind("Threads:", 0) == 0) {
+				return std::strtoull(line.c_str() + std::strlen("Threads:"), nullptr, 10) != 1;
+			}
+		}
+
+		return true;	//we cannot tell, so let us assume the worse
+	}
+#endif
+}
+
+CFitness_Worker_Pool::CFitness_Worker_Pool(const size_t problem_size) noexcept : mProblem_Size(problem_size) {
+	//
+}
+
+CFitness_Worker_Pool::~CFitness_Worker_Pool() {
+	Stop();
+}
+
+size_t CFitness_Worker_Pool::Worker_Count_From_Environment() {
+#ifdef FORKED_WORKERS_SUPPORTED
+	size_t assumed_len = 0;
+	auto var_os_err = getenv_s(&assumed_len, nullptr, 0, rsOptimizer_Workers_Variable);
+	if ((var_os_err == 0) && (assumed_len > 0)) {
+		std::vector<char> var_buf(assumed_len);
+		var_os_err = getenv_s(&assumed_len, var_buf.data(), assumed_len, rsOptimizer_Workers_Variable);
+		if (var_os_err == 0) {
+			var_buf.push_back(0);	//make sure its ASCIIZ
+
+			char* end_ptr = nullptr;
+			const unsigned long long count = std::strtoull(var_buf.data(), &end_ptr, 10);
+			if ((end_ptr != var_buf.data()) && (*end_ptr == 0)) {
+				return static_cast<size_t>(count);
+			}
+		}
+	}
+#endif
+
+	return 0;
+}
+
+#ifdef FORKED_WORKERS_SUPPORTED
+size_t* CFitness_Worker_Pool::Ring() const noexcept {
+	return reinterpret_cast<size_t*>(mShared + Align(sizeof(TShared_Header)));
+}
+
+unsigned char* CFitness_Worker_Pool::Slot(const size_t index) const noexcept {
+	return mShared + Align(sizeof(TShared_Header)) + Align(mSlot_Count * sizeof(size_t)) + index * mSlot_Stride;
+}
+#endif
+
+bool CFitness_Worker_Pool::Start(const size_t worker_count, const TEvaluate &evaluate) {
+#ifdef FORKED_WORKERS_SUPPORTED
+	if ((worker_count == 0) || mShared || Other_Threads_Running()) {
+		return false;
+	}
+
+	mSlot_Count = worker_count * Slots_Per_Worker;
+	mSlot_Stride = Align(sizeof(TShared_Slot) + mProblem_Size * sizeof(double));
+	mShared_Size = Align(sizeof(TShared_Header)) + Align(mSlot_Count * sizeof(size_t)) + mSlot_Count * mSlot_Stride;
+
+	void* shared = mmap(nullptr, mShared_Size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (shared == MAP_FAILED) {
+		return false;
+	}
+	mShared = static_cast<unsigned char*>(shared);
+
+	TShared_Header* header = new (mShared) TShared_Header{};
+	for (size_t i = 0; i < mSlot_Count; i++) {
+		new (Slot(i)) TShared_Slot{};
+		mFree_Slots.push_back(i);
+	}
+
+	//the header's semaphore first, then the slots' ones in their order, so that Stop knows which ones to destroy
+	if (sem_init(&header->pending, 1, 0) == 0) {
+		mInitialized_Semaphores = 1;
+		while ((mInitialized_Semaphores <= mSlot_Count) && (sem_init(&reinterpret_cast<TShared_Slot*>(Slot(mInitialized_Semaphores - 1))->done, 1, 0) == 0)) {
+			mInitialized_Semaphores++;
+		}
+	}
+
+	if (mInitialized_Semaphores != mSlot_Count + 1) {
+		Stop();
+		return false;
+	}
+
+	for (size_t i = 0; i < worker_count; i++) {
+		const pid_t pid = fork();
+		if (pid == 0) {
+			Worker_Loop(evaluate);
+		}
+
+		if (pid < 0) {
+			Stop();	//let us not run with fewer workers than requested, as the caller may rely on the process isolation
+			return false;
+		}
+
+		mWorkers.push_back(static_cast<long long>(pid));
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void CFitness_Worker_Pool::Stop() {
+#ifdef FORKED_WORKERS_SUPPORTED
+	if (!mShared) {
+		return;
+	}
+
+	TShared_Header* header = reinterpret_cast<TShared_Header*>(mShared);
+	header->shutdown = true;
+	for (size_t i = 0; i < mWorkers.size(); i++) {
+		sem_post(&header->pending);
+	}
+
+	for (const auto worker : mWorkers) {
+		int status = 0;
+		while ((waitpid(static_cast<pid_t>(worker), &status, 0) < 0) && (errno == EINTR)) {
+			//the wait has been interrupted, not finished
+		}
+	}
+	mWorkers.clear();
+
+	//no worker uses the semaphores any longer, so we can destroy the ones we have initialized
+	if (mInitialized_Semaphores > 0) {
+		for (size_t i = 0; i + 1 < mInitialized_Semaphores; i++) {
+			sem_destroy(&reinterpret_cast<TShared_Slot*>(Slot(i))->done);
+		}
+		sem_destroy(&header->pending);
+		mInitialized_Semaphores = 0;
+	}
+
+	munmap(mShared, mShared_Size);
+	mShared = nullptr;
+	mFree_Slots.clear();
+#endif
+}
+
+void CFitness_Worker_Pool::Worker_Loop(const TEvaluate &evaluate) {
+#ifdef FORKED_WORKERS_SUPPORTED
+	TShared_Header* header = reinterpret_cast<TShared_Header*>(mShared);
+	const size_t* ring = Ring();
+
+	while (Wait_Semaphore(header->pending) && !header->shutdown) {
+		const size_t position = header->taken.fetch_add(1);
+		TShared_Slot* slot = reinterpret_cast<TShared_Slot*>(Slot(ring[position % mSlot_Count]));
+		const double* solution = reinterpret_cast<const double*>(reinterpret_cast<unsigned char*>(slot) + sizeof(TShared_Slot));
+
+		slot->succeeded = evaluate(solution, slot->fitness.data()) ? 1 : 0;
+		sem_post(&slot->done);
+	}
+
+	//do not run the parent's dtors and atexit handlers
+	_exit(0);
+#else
+	std::abort();
+#endif
+}
+
+std::vector<size_t> CFitness_Worker_Pool::Acquire_Slots(const size_t count) {
+	//all the slots at once, so that two threads cannot hold a part of the slots, while waiting for the rest of them
+	std::unique_lock<std::mutex> lock{ mSlot_Guard };
+	mSlot_Released.wait(lock, [this, count] { return mFree_Slots.size() >= count; });
+
+	std::vector<size_t> slots{ mFree_Slots.end() - count, mFree_Slots.end() };
+	mFree_Slots.resize(mFree_Slots.size() - count);
+	return slots;
+}
+
+void CFitness_Worker_Pool::Release_Slots(const std::vector<size_t> &slots) {
+	{
+		std::lock_guard<std::mutex> lock{ mSlot_Guard };
+		mFree_Slots.insert(mFree_Slots.end(), slots.begin(), slots.end());
+	}
+
+	mSlot_Released.notify_all();
+}
+
+void CFitness_Worker_Pool::Submit(const size_t slot_index, const double* solution) {
+#ifdef FORKED_WORKERS_SUPPORTED
+	TShared_Header* header = reinterpret_cast<TShared_Header*>(mShared);
+	size_t* ring = Ring();
+	unsigned char* slot = Slot(slot_index);
+
+	std::copy(solution, solution + mProblem_Size, reinterpret_cast<double*>(slot + sizeof(TShared_Slot)));
+
+	//the ring positions have to be posted in their order, as the workers take them in that order
+	std::lock_guard<std::mutex> lock{ mSubmit_Guard };
+	ring[mSubmitted % mSlot_Count] = slot_index;
+	mSubmitted++;
+	sem_post(&header->pending);
+#endif
+}
+
+bool CFitness_Worker_Pool::Workers_Alive() {
+#ifdef FORKED_WORKERS_SUPPORTED
+	for (const auto worker : mWorkers) {
+		int status = 0;
+		if (waitpid(static_cast<pid_t>(worker), &status, WNOHANG) != 0) {
+			return false;	//has terminated, or we cannot tell
+		}
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool CFitness_Worker_Pool::Wait_For(const size_t slot_index) {
+#ifdef FORKED_WORKERS_SUPPORTED
+	TShared_Slot* slot = reinterpret_cast<TShared_Slot*>(Slot(slot_index));
+
+	//a crashed worker would never post the slot, so we check them periodically
+	for (;;) {
+		timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += 100'000'000;
+		if (deadline.tv_nsec >= 1'000'000'000) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1'000'000'000;
+		}
+
+		if (sem_timedwait(&slot->done, &deadline) == 0) {
+			return slot->succeeded != 0;
+		}
+
+		if ((errno != ETIMEDOUT) && (errno != EINTR)) {
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock{ mSlot_Guard };
+		if (mBroken || !Workers_Alive()) {
+			mBroken = true;
+			return false;
+		}
+	}
+#else
+	return false;
+#endif
+}
+
+bool CFitness_Worker_Pool::Evaluate(const size_t solution_count, const double* solutions, double* const fitnesses) {
+#ifdef FORKED_WORKERS_SUPPORTED
+	if (!mShared) {
+		return false;
+	}
+
+	for (size_t first = 0; first < solution_count; first += mSlot_Count) {
+		{
+			std::lock_guard<std::mutex> lock{ mSlot_Guard };
+			if (mBroken) {
+				return false;	//the lost slots would not be ever released
+			}
+		}
+
+		const size_t count = std::min(mSlot_Count, solution_count - first);
+		const std::vector<size_t> acquired = Acquire_Slots(count);
+		for (size_t i = 0; i < count; i++) {
+			Submit(acquired[i], solutions + (first + i) * mProblem_Size);
+		}
+
+		bool succeeded = true;
+		for (size_t i = 0; i < count; i++) {
+			if (Wait_For(acquired[i])) {
+				const TShared_Slot* slot = reinterpret_cast<const TShared_Slot*>(Slot(acquired[i]));
+				std::copy(slot->fitness.begin(), slot->fitness.end(), fitnesses + (first + i) * solver::Maximum_Objectives_Count);
+			}
+			else {
+				succeeded = false;	//but we have to wait for the rest of the slots, as the workers still use them
+			}
+		}
+
+		Release_Slots(acquired);
+		if (!succeeded) {
+			return false;
+		}
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
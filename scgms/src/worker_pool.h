@@ -0,0 +1,97 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+#pragma once
+
+#include <scgms/iface/SolverIface.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+//evaluates the candidate solutions in forked worker processes, each with its own chains, event pool and logical clock
+//the solutions and their fitnesses are exchanged through a ring of slots in an anonymous shared memory
+//the workers are forked, so that they inherit the prepared optimizer state
+//this is available on Linux only, as the pool has to verify through /proc that no other thread runs at the time of fork
+class CFitness_Worker_Pool {
+	public:
+		//called in the worker processes
+		using TEvaluate = std::function<bool(const double* solution, double* const fitness)>;
+
+	protected:
+		const size_t mProblem_Size;
+		size_t mSlot_Count = 0;
+		size_t mSlot_Stride = 0;	//bytes
+		size_t mShared_Size = 0;
+		unsigned char* mShared = nullptr;
+		size_t mInitialized_Semaphores = 0;	//the pending one and then the slots' ones
+		std::vector<long long> mWorkers;	//process ids
+		bool mBroken = false;				//a worker has died, so that some slots might never get their fitness
+
+		std::mutex mSlot_Guard;
+		std::condition_variable mSlot_Released;
+		std::vector<size_t> mFree_Slots;
+
+		std::mutex mSubmit_Guard;
+		size_t mSubmitted = 0;
+
+		//the shared memory holds a header, the ring of the submitted slot indices and the slots
+		size_t* Ring() const noexcept;
+		unsigned char* Slot(const size_t index) const noexcept;
+
+		std::vector<size_t> Acquire_Slots(const size_t count);
+		void Release_Slots(const std::vector<size_t> &slots);
+		void Submit(const size_t slot, const double* solution);
+		bool Wait_For(const size_t slot);
+		bool Workers_Alive();
+
+		[[noreturn]] void Worker_Loop(const TEvaluate &evaluate);
+	public:
+		CFitness_Worker_Pool(const size_t problem_size) noexcept;
+		~CFitness_Worker_Pool();
+
+		//forks the workers; false, if it is not possible - then, the caller has to evaluate the solutions in its own process
+		//refuses to fork, if the process runs any other thread, which could hold a lock at the time of fork
+		bool Start(const size_t worker_count, const TEvaluate &evaluate);
+		void Stop();
+
+		//the fitnesses are spaced by solver::Maximum_Objectives_Count; may be called from more threads at once
+		bool Evaluate(const size_t solution_count, const double* solutions, double* const fitnesses);
+
+		//reads the number of the workers from the SCGMS_OPTIMIZER_WORKERS environment variable; zero to evaluate in the optimizer's process
+		static size_t Worker_Count_From_Environment();
+};
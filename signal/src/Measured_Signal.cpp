@@ -39,6 +39,7 @@
 #undef min
 
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <assert.h>
 
@@ -48,88 +49,50 @@ CMeasured_Signal::CMeasured_Signal(const GUID* approx_id): mApprox(nullptr) {
 	mApprox = approx_id ? scgms::Create_Approximator(*approx_id, self_signal) : scgms::Create_Approximator(self_signal);
 }
 
-HRESULT IfaceCalling CMeasured_Signal::Get_Discrete_Levels(double* const times, double* const levels, const size_t count, size_t *filled) const {
+HRESULT IfaceCalling CMeasured_Signal::QueryInterface(const GUID*  riid, void ** ppvObj) {
+	if (Internal_Query_Interface<scgms::ISignal_Discrete_Spans>(scgms::IID_Signal_Discrete_Spans, *riid, ppvObj)) {
+		return S_OK;
+	}
+	if (Internal_Query_Interface<scgms::ISignal_Retention>(scgms::IID_Signal_Retention, *riid, ppvObj)) {
+		return S_OK;
+	}
+	if (Internal_Query_Interface<scgms::IApproximation_Locality>(scgms::IID_Approximation_Locality, *riid, ppvObj)) {
+		return S_OK;
+	}
 
-	*filled = std::min(count, mTimes.size());
+	return E_NOINTERFACE;
+}
 
-	if (*filled) {
-		const size_t bytes_to_copy = (*filled) * sizeof(double);
-		memcpy(times, mTimes.data(), bytes_to_copy);
-		memcpy(levels, mLevels.data(), bytes_to_copy);
-	}
+HRESULT IfaceCalling CMeasured_Signal::Get_Discrete_Levels(double* const times, double* const levels, const size_t count, size_t *filled) const {
+	*filled = mSeries.Copy(times, levels, count);
 
 	return S_OK;
 }
 
 HRESULT IfaceCalling CMeasured_Signal::Get_Discrete_Bounds(scgms::TBounds* const time_bounds, scgms::TBounds* const level_bounds, size_t *level_count) const {
 	if (level_count) {
-		*level_count = mLevels.size();
+		*level_count = mSeries.Size();
 	}
 
-	if (mLevels.size() == 0) {
+	if (mSeries.Empty()) {
 		return S_FALSE;
 	}
 
 	if (time_bounds) {
-		time_bounds->Min = mTimes[0];
-		time_bounds->Max = mTimes[mTimes.size() - 1];
+		time_bounds->Min = mSeries.Front_Time();
+		time_bounds->Max = mSeries.Back_Time();
 	}
 
 	if (level_bounds) {
-		auto res = std::minmax_element(mLevels.begin(), mLevels.end());
-		level_bounds->Min = *res.first;
-		level_bounds->Max = *res.second;
+		mSeries.Level_Bounds(level_bounds->Min, level_bounds->Max);
 	}
 
 	return S_OK;
 }
 
 HRESULT IfaceCalling CMeasured_Signal::Update_Levels(const double *times, const double *levels, const size_t count) {
-	double last_time = mTimes.empty() ? 0.0 : mTimes[mTimes.size() - 1];
-
 	for (size_t i = 0; i < count; i++) {
-		//is time[i] greater than the last time in mTimes?
-		//yes, we can simply add it
-
-		if (times[i] > last_time) {
-			//we expect this to happen almost all the time, however, not always
-
-			mTimes.push_back(times[i]);
-			mLevels.push_back(levels[i]);
-			last_time = times[i];		//update the correct last time
-		}
-		else {
-			//update or insert?
-			//check whether the times[i] is already present and we will updated it
-
-			//need to reevaluate every time for i as the insertion might change memory addresses
-			//Let us use mLast_Update_Index to perform adaptive interval division,
-			//as we assume that updates would occur for a certain recent period only.
-			//Hence, there is no need to search all the times.
-			decltype(mTimes)::iterator search_begin, search_end;
-			if (!mTimes.empty() && (times[i] < mTimes[mLast_Update_Index])) {
-				search_begin = mTimes.begin();
-				search_end = mTimes.begin() + mLast_Update_Index;
-			}
-			else {
-				search_begin = mTimes.begin() + mLast_Update_Index;
-				search_end = mTimes.end();
-			}
-
-			auto first = std::lower_bound(search_begin, search_end, times[i]);
-			mLast_Update_Index = std::distance(mTimes.begin(), first);
-
-			if (!(first == search_end) && !(times[i] < *first)) {
-				//we have found the time, we just update the value
-				mLevels[mLast_Update_Index] = levels[i];
-			}
-			else {
-				//not found, we have to insert
-				//we expect inserts to be a rare phenomenon
-				mTimes.insert(mTimes.begin() + mLast_Update_Index, times[i]);
-				mLevels.insert(mLevels.begin() + mLast_Update_Index, levels[i]);
-			}
-		}
+		mSeries.Update(times[i], levels[i]);
 	}
 
 	return S_OK;
@@ -149,3 +112,46 @@ HRESULT IfaceCalling CMeasured_Signal::Get_Continuous_Levels(scgms::IModel_Param
 HRESULT IfaceCalling CMeasured_Signal::Get_Default_Parameters(scgms::IModel_Parameter_Vector *parameters) const {
 	return E_NOTIMPL;
 }
+
+HRESULT IfaceCalling CMeasured_Signal::Get_Discrete_Spans(const scgms::TLevels_Span** begin, const scgms::TLevels_Span** end) const {
+	if (!begin || !end) {
+		return E_INVALIDARG;
+	}
+
+	const auto& spans = mSeries.Spans();
+	*begin = spans.data();
+	*end = spans.data() + spans.size();
+
+	return spans.empty() ? S_FALSE : S_OK;
+}
+
+HRESULT IfaceCalling CMeasured_Signal::Get_Discrete_Revision(uint64_t* revision) const {
+	if (!revision) {
+		return E_INVALIDARG;
+	}
+
+	*revision = mSeries.Revision();
+	return S_OK;
+}
+
+HRESULT IfaceCalling CMeasured_Signal::Set_Retention(const double retention) {
+	if (std::isnan(retention) || (retention <= 0.0)) {
+		return E_INVALIDARG;
+	}
+
+	mSeries.Set_Retention(retention);
+	return S_OK;
+}
+
+HRESULT IfaceCalling CMeasured_Signal::Get_Preceding_Affected_Levels(size_t* count) const {
+	if (!count) {
+		return E_INVALIDARG;
+	}
+
+	refcnt::SReferenced<scgms::IApproximation_Locality> locality;
+	if (mApprox) {
+		refcnt::Query_Interface<scgms::IApproximator, scgms::IApproximation_Locality>(mApprox.get(), scgms::IID_Approximation_Locality, locality);
+	}
+
+	return locality ? locality->Get_Preceding_Affected_Levels(count) : E_NOTIMPL;
+}
@@ -38,17 +38,18 @@
 
 #include <scgms/rtl/ApproxLib.h>
 #include <scgms/rtl/referencedImpl.h>
+#include <scgms/iface/ApproxExtIface.h>
+
+#include "chunked_series.h"
 
 #include <map>
 
 #pragma warning( push )
 #pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
 
-class CMeasured_Signal : public virtual scgms::ISignal, public virtual refcnt::CReferenced {
+class CMeasured_Signal : public virtual scgms::ISignal, public virtual scgms::ISignal_Discrete_Spans, public virtual scgms::ISignal_Retention, public virtual scgms::IApproximation_Locality, public virtual refcnt::CReferenced {
 	protected:
-		size_t mLast_Update_Index = 0;
-		std::vector<double> mTimes;
-		std::vector<double> mLevels;
+		CChunked_Series mSeries;
 
 		scgms::SApproximator mApprox;
 
@@ -56,12 +57,19 @@ class CMeasured_Signal : public virtual scgms::ISignal, public virtual refcnt::C
 		CMeasured_Signal(const GUID* approx_id);
 		virtual ~CMeasured_Signal() = default;
 
+		virtual HRESULT IfaceCalling QueryInterface(const GUID*  riid, void ** ppvObj) override;
+
 		virtual HRESULT IfaceCalling Get_Discrete_Levels(double* const times, double* const levels, const size_t count, size_t* filled) const override;
 		virtual HRESULT IfaceCalling Get_Discrete_Bounds(scgms::TBounds* const time_bounds, scgms::TBounds* const level_bounds, size_t* level_count) const override;
 		virtual HRESULT IfaceCalling Update_Levels(const double* times, const double* levels, const size_t count) override;
 
 		virtual HRESULT IfaceCalling Get_Continuous_Levels(scgms::IModel_Parameter_Vector* params, const double* times, double* const levels, const size_t count, const size_t derivation_order) const override;
 		virtual HRESULT IfaceCalling Get_Default_Parameters(scgms::IModel_Parameter_Vector* parameters) const override;
+
+		virtual HRESULT IfaceCalling Get_Discrete_Spans(const scgms::TLevels_Span** begin, const scgms::TLevels_Span** end) const override;
+		virtual HRESULT IfaceCalling Get_Discrete_Revision(uint64_t* revision) const override;
+		virtual HRESULT IfaceCalling Set_Retention(const double retention) override;
+		virtual HRESULT IfaceCalling Get_Preceding_Affected_Levels(size_t* count) const override;	//of its approximator
 };
 
 #pragma warning( pop )
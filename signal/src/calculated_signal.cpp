@@ -45,6 +45,7 @@
 #include <scgms/utils/math_utils.h>
 #include <scgms/utils/string_utils.h>
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 
@@ -57,13 +58,19 @@ CCalculate_Filter::CCalculate_Filter(scgms::IFilter *output) : CBase_Filter(outp
 }
 
 CCalculate_Filter::~CCalculate_Filter() {
-	mSolver_Progress.cancelled = TRUE;
+	Stop_Async_Solver();
 }
 
 HRESULT IfaceCalling CCalculate_Filter::QueryInterface(const GUID*  riid, void ** ppvObj) {
 	if (Internal_Query_Interface<scgms::ICalculate_Filter_Inspection>(scgms::IID_Calculate_Filter_Inspection, *riid, ppvObj)) {
 		return S_OK;
 	}
+	if (Internal_Query_Interface<scgms::IFilter_Checkpointable>(scgms::IID_Filter_Checkpointable, *riid, ppvObj)) {
+		return S_OK;
+	}
+	if (Internal_Query_Interface<scgms::IFilter_Reusable>(scgms::IID_Filter_Reusable, *riid, ppvObj)) {
+		return S_OK;
+	}
 
 	return E_NOINTERFACE;
 }
@@ -75,7 +82,7 @@ std::unique_ptr<CTime_Segment>& CCalculate_Filter::Get_Segment(const uint64_t se
 		return iter->second;
 	}
 	else {
-		std::unique_ptr<CTime_Segment> segment = std::make_unique<CTime_Segment>(segment_id, mCalculated_Signal_Id, mDefault_Parameters, mPrediction_Window, mOutput);
+		std::unique_ptr<CTime_Segment> segment = std::make_unique<CTime_Segment>(segment_id, mCalculated_Signal_Id, mDefault_Parameters, mPrediction_Window, mEmitted_Times_Retention, mSignal_Retention, mOutput);
 		const auto ret = mSegments.insert(std::make_pair(segment_id, std::move(segment)));
 		return ret.first->second;
 	}
@@ -84,10 +91,13 @@ std::unique_ptr<CTime_Segment>& CCalculate_Filter::Get_Segment(const uint64_t se
 HRESULT IfaceCalling CCalculate_Filter::Do_Configure(scgms::SFilter_Configuration configuration, refcnt::Swstr_list& error_description) {
 	mCalculated_Signal_Id = configuration.Read_GUID(rsSelected_Signal);
 	mPrediction_Window = configuration.Read_Double(rsPrediction_Window);
+	mEmitted_Times_Retention = configuration.Read_Double(calculate::rsEmitted_Times_Retention, 24.0 * scgms::One_Hour);
+	mSignal_Retention = configuration.Read_Double(calculate::rsSignal_Retention, 0.0);
 	mSolver_Enabled = configuration.Read_Bool(rsSolve_Parameters);
 	mSolve_On_Calibration = configuration.Read_Bool(rsSolve_On_Calibration);
 	mSolve_On_Time_Segment_End = configuration.Read_Bool(rsSolve_On_Time_Segment_End);
 	mSolve_All_Segments = configuration.Read_Bool(rsSolve_Using_All_Segments);
+	mSolve_Asynchronously = configuration.Read_Bool(calculate::rsSolve_Asynchronously, mSolve_Asynchronously);
 	mReference_Level_Threshold_Count = configuration.Read_Int(rsSolve_On_Level_Count);
 	mSolving_Scheduled = false;
 	mReference_Level_Counter = 0;
@@ -135,7 +145,7 @@ HRESULT IfaceCalling CCalculate_Filter::Do_Configure(scgms::SFilter_Configuratio
 	mUse_Measured_Levels = configuration.Read_Bool(rsUse_Measured_Levels, mUse_Measured_Levels);
 	mLevels_Required = configuration.Read_Int(rsMetric_Levels_Required, desc.total_number_of_parameters);
 
-	if (Is_Invalid_GUID(mCalculated_Signal_Id) || std::isnan(mPrediction_Window)) {
+	if (Is_Invalid_GUID(mCalculated_Signal_Id) || std::isnan(mPrediction_Window) || std::isnan(mEmitted_Times_Retention) || (mEmitted_Times_Retention < 0.0) || std::isnan(mSignal_Retention) || (mSignal_Retention < 0.0)) {
 		return E_INVALIDARG;
 	}
 	if (mSolver_Enabled && (Is_Invalid_GUID(mSolver_Id, mMetric_Id) || std::isnan(mMetric_Threshold))) {
@@ -146,7 +156,16 @@ HRESULT IfaceCalling CCalculate_Filter::Do_Configure(scgms::SFilter_Configuratio
 }
 
 HRESULT CCalculate_Filter::Do_Execute(scgms::UDevice_Event event)  {
-	
+
+	//with the asynchronous solver, the solutions are applied and emitted here, so that they do not race with the events
+	if (mSolve_Asynchronously) {
+		if (event.event_code() == scgms::NDevice_Event_Code::Shut_Down) {
+			Finish_Async_Solver();	//no other event would emit the solution
+		}
+
+		Apply_Async_Solutions();
+	}
+
 	bool event_already_sent = false;
 	HRESULT result = E_UNEXPECTED;
 
@@ -185,6 +204,8 @@ HRESULT CCalculate_Filter::Do_Execute(scgms::UDevice_Event event)  {
 					if (event.segment_id() != scgms::Invalid_Segment_Id) {
 
 						auto test_and_apply_parameters = [&event, this](const std::unique_ptr<CTime_Segment>& segment) {
+							mParameters_Used = true;	//the segment's parameters are no longer the configured ones
+
 							//do these parameters improve?
 							if (Is_Invalid_GUID(mMetric_Id)) {
 								return true;	//if there's no metric set, we believe the parameters as we got them
@@ -362,125 +383,135 @@ double CCalculate_Filter::Calculate_Fitness(scgms::ITime_Segment **segments, con
 	return fitness;
 }
 
-void CCalculate_Filter::Run_Solver(const uint64_t segment_id) {
+scgms::TSolver_Status CCalculate_Filter::Solve_Segments(scgms::ITime_Segment **segments, const size_t segment_count, scgms::SMetric &metric, const std::vector<scgms::SModel_Parameter_Vector> &hints,
+														scgms::SModel_Parameter_Vector working_parameters, scgms::SModel_Parameter_Vector solved_parameters, solver::TSolver_Progress &progress) {
 	//1. we need to calculate present fitness of current parameters
 	//2. then, we attempt to calculate new parameters 
 	//3. subsequently, we calculate fitness of the new parameters
-	//4. eventually, we apply new parameters if they present a better fitness
-
-	mSolver_Status = scgms::TSolver_Status::In_Progress;
-
-	scgms::SMetric metric{ scgms::TMetric_Parameters{ mMetric_Id, bool_2_uc(mUse_Relative_Error),  bool_2_uc(mUse_Squared_Differences), bool_2_uc(mPrefer_More_Levels),  mMetric_Threshold } };
-
-	auto solve_segment = [this, &metric, segment_id](scgms::ITime_Segment **segments, const size_t segment_count, scgms::SModel_Parameter_Vector working_parameters) {
-		
-		size_t real_levels_required = 0;
-		{	//get the number of levels required
-			size_t global_count = 0;
-			if (mLevels_Required < 0) {
-				//handle the relative value
-
-				for (size_t i = 0; i < segment_count; i++) {
-					scgms::ISignal *signal;
-					if (segments[i]->Get_Signal(&mReference_Signal_Id, &signal) == S_OK) {
-						size_t local_count = 0;
-						if (signal->Get_Discrete_Bounds(nullptr, nullptr, &local_count) == S_OK) {
-							global_count += local_count;
-						}
+	//4. eventually, we report whether the new parameters present a better fitness
+
+	size_t real_levels_required = 0;
+	{	//get the number of levels required
+		size_t global_count = 0;
+		if (mLevels_Required < 0) {
+			//handle the relative value
+
+			for (size_t i = 0; i < segment_count; i++) {
+				scgms::ISignal *signal;
+				if (segments[i]->Get_Signal(&mReference_Signal_Id, &signal) == S_OK) {
+					size_t local_count = 0;
+					if (signal->Get_Discrete_Bounds(nullptr, nullptr, &local_count) == S_OK) {
+						global_count += local_count;
 					}
 				}
 			}
-			real_levels_required = static_cast<size_t>(static_cast<int64_t>(global_count) + mLevels_Required);
 		}
+		real_levels_required = static_cast<size_t>(static_cast<int64_t>(global_count) + mLevels_Required);
+	}
 
-		//get the raw hints
-		std::vector<scgms::IModel_Parameter_Vector*> raw_hints;
-		{
-			for (auto& hint : mParameter_Hints) {
-				raw_hints.push_back(hint.get());
-			}
-			if (mDefault_Parameters) {
-				raw_hints.push_back(mDefault_Parameters.get());
-			}
+	//get the raw hints
+	std::vector<scgms::IModel_Parameter_Vector*> raw_hints;
+	{
+		for (auto& hint : hints) {
+			raw_hints.push_back(hint.get());
+		}
+		if (mDefault_Parameters) {
+			raw_hints.push_back(mDefault_Parameters.get());
+		}
 
-			//find the best parameters
-			if (raw_hints.size()>1) {
-				double best_fitness = Calculate_Fitness(segments, segment_count, metric, raw_hints[0]);
-				size_t best_index = 0;
-				for (size_t i = 1; i < raw_hints.size(); i++) {
-					const double local_fitness = Calculate_Fitness(segments, segment_count, metric, raw_hints[i]);
-					if (local_fitness < best_fitness) {
-						best_index = i;
-					}
+		//find the best parameters
+		if (raw_hints.size()>1) {
+			double best_fitness = Calculate_Fitness(segments, segment_count, metric, raw_hints[0]);
+			size_t best_index = 0;
+			for (size_t i = 1; i < raw_hints.size(); i++) {
+				const double local_fitness = Calculate_Fitness(segments, segment_count, metric, raw_hints[i]);
+				if (local_fitness < best_fitness) {
+					best_index = i;
 				}
+			}
 
-				//swap the best hint to the first position
-				if (best_index > 0) {
-					std::swap(raw_hints[0], raw_hints[best_index]);
-				}
+			//swap the best hint to the first position
+			if (best_index > 0) {
+				std::swap(raw_hints[0], raw_hints[best_index]);
 			}
 		}
+	}
 
-		metric->Reset();
-		mSolver_Progress = solver::Null_Solver_Progress;
-		
-		scgms::SModel_Parameter_Vector solved_parameters{ mDefault_Parameters };
+	metric->Reset();
 
-		TSegment_Solver_Setup setup{
-			mSolver_Id, mCalculated_Signal_Id, mReference_Signal_Id,
-			segments, segment_count,
-			metric.get(), real_levels_required, bool_2_uc(mUse_Measured_Levels),
-			mLower_Bound.get(), mUpper_Bound.get(),
-			raw_hints.data(), raw_hints.size(),
-			solved_parameters.get(),
-			&mSolver_Progress
-		};
-
-		if (Solve_Model_Parameters(setup) == S_OK) {
-			//calculate and compare the present parameters with the new one
-
-			const double original_fitness = Calculate_Fitness(segments, segment_count, metric, working_parameters.get());
-			const double solved_fitness = Calculate_Fitness(segments, segment_count, metric, solved_parameters.get());
-			if (solved_fitness < original_fitness) {
-				mSolver_Status = scgms::TSolver_Status::Completed_Improved;
-
-				//OK, we have found better fitness => set it and send respective message
-				if (segment_id != scgms::All_Segments_Id) {
-					const auto &segment = Get_Segment(segment_id);
-					if (segment) {
-						segment->Set_Parameters(solved_parameters);
-					}
-				}
-				else {
-					for (auto& segment : mSegments) {
-						segment.second->Set_Parameters(solved_parameters);
-					}
-				}
+	//all the segments we solve are ours, so they keep the reference levels across the solver runs
+	std::vector<TReference_Levels*> reference_levels;
+	for (size_t i = 0; i < segment_count; i++) {
+		reference_levels.push_back(static_cast<CTime_Segment*>(segments[i])->Reference_Levels());
+	}
+
+	TSegment_Solver_Setup setup{
+		mSolver_Id, mCalculated_Signal_Id, mReference_Signal_Id,
+		segments, segment_count,
+		metric.get(), real_levels_required, bool_2_uc(mUse_Measured_Levels),
+		mLower_Bound.get(), mUpper_Bound.get(),
+		raw_hints.data(), raw_hints.size(),
+		solved_parameters.get(),
+		&progress,
+		reference_levels.data()
+	};
+
+	if (Solve_Model_Parameters(setup) != S_OK) {
+		return scgms::TSolver_Status::Failed;
+	}
+
+	//calculate and compare the present parameters with the new one
+	const double original_fitness = Calculate_Fitness(segments, segment_count, metric, working_parameters.get());
+	const double solved_fitness = Calculate_Fitness(segments, segment_count, metric, solved_parameters.get());
+
+	return solved_fitness < original_fitness ? scgms::TSolver_Status::Completed_Improved : scgms::TSolver_Status::Completed_Not_Improved;
+}
 
-				Add_Parameters_Hint(solved_parameters);
+void CCalculate_Filter::Apply_Solution(const uint64_t segment_id, const scgms::TSolver_Status status, scgms::SModel_Parameter_Vector solved_parameters, const double triggered_time) {
+	mSolver_Status = status;
 
-				scgms::UDevice_Event solved_evt{ scgms::NDevice_Event_Code::Parameters };
-				solved_evt.device_time() = mTriggered_Solver_Time;
-				solved_evt.device_id() = calculate::Calculate_Filter_GUID;
-				solved_evt.signal_id() = mCalculated_Signal_Id;
-				solved_evt.segment_id() = segment_id;
-				solved_evt.parameters.set(solved_parameters);
-				mOutput.Send(solved_evt);
+	switch (status) {
+		case scgms::TSolver_Status::Completed_Improved:
+		{
+			//OK, we have found better fitness => set it and send respective message
+			if (segment_id != scgms::All_Segments_Id) {
+				const auto &segment = Get_Segment(segment_id);
+				if (segment) {
+					segment->Set_Parameters(solved_parameters);
+				}
 			}
 			else {
-				mSolver_Status = scgms::TSolver_Status::Completed_Not_Improved;
-				scgms::UDevice_Event not_improved_evt{ scgms::NDevice_Event_Code::Information };
-				not_improved_evt.device_time() = Unix_Time_To_Rat_Time(time(nullptr));
-				not_improved_evt.device_id() = calculate::Calculate_Filter_GUID;
-				not_improved_evt.signal_id() = mCalculated_Signal_Id;
-				not_improved_evt.segment_id() = segment_id;
-				not_improved_evt.info.set(rsInfo_Solver_Completed_But_No_Improvement);
-				mOutput.Send(not_improved_evt);
+				for (auto& segment : mSegments) {
+					segment.second->Set_Parameters(solved_parameters);
+				}
 			}
 
-		} else {
-			mSolver_Status = scgms::TSolver_Status::Failed;
+			Add_Parameters_Hint(solved_parameters);
+
+			scgms::UDevice_Event solved_evt{ scgms::NDevice_Event_Code::Parameters };
+			solved_evt.device_time() = triggered_time;
+			solved_evt.device_id() = calculate::Calculate_Filter_GUID;
+			solved_evt.signal_id() = mCalculated_Signal_Id;
+			solved_evt.segment_id() = segment_id;
+			solved_evt.parameters.set(solved_parameters);
+			mOutput.Send(solved_evt);
+			break;
+		}
+
+		case scgms::TSolver_Status::Completed_Not_Improved:
+		{
+			scgms::UDevice_Event not_improved_evt{ scgms::NDevice_Event_Code::Information };
+			not_improved_evt.device_time() = Unix_Time_To_Rat_Time(time(nullptr));
+			not_improved_evt.device_id() = calculate::Calculate_Filter_GUID;
+			not_improved_evt.signal_id() = mCalculated_Signal_Id;
+			not_improved_evt.segment_id() = segment_id;
+			not_improved_evt.info.set(rsInfo_Solver_Completed_But_No_Improvement);
+			mOutput.Send(not_improved_evt);
+			break;
+		}
 
+		default:
+		{
 			//for some reason, it has failed
 			scgms::UDevice_Event failed_evt{ scgms::NDevice_Event_Code::Information };
 			failed_evt.device_time() = Unix_Time_To_Rat_Time(time(nullptr));
@@ -489,8 +520,31 @@ void CCalculate_Filter::Run_Solver(const uint64_t segment_id) {
 			failed_evt.segment_id() = segment_id;
 			failed_evt.info.set(rsInfo_Solver_Failed);
 			mOutput.Send(failed_evt);
+			break;
+		}
+	}
+}
+
+void CCalculate_Filter::Run_Solver(const uint64_t segment_id) {
+	mSolver_Status = scgms::TSolver_Status::In_Progress;
+	mParameters_Used = true;
+
+	if (mSolve_Asynchronously) {
+		Schedule_Async_Solver(segment_id);
+		return;
+	}
+
+	scgms::SMetric metric{ scgms::TMetric_Parameters{ mMetric_Id, bool_2_uc(mUse_Relative_Error),  bool_2_uc(mUse_Squared_Differences), bool_2_uc(mPrefer_More_Levels),  mMetric_Threshold } };
+
+	auto solve_segment = [this, &metric, segment_id](scgms::ITime_Segment **segments, const size_t segment_count, scgms::SModel_Parameter_Vector working_parameters) {
+		{
+			std::lock_guard<std::mutex> lock{ mSolver_Guard };
+			mSolver_Progress = solver::Null_Solver_Progress;
 		}
 
+		scgms::SModel_Parameter_Vector solved_parameters{ mDefault_Parameters };
+		const auto status = Solve_Segments(segments, segment_count, metric, mParameter_Hints, working_parameters, solved_parameters, mSolver_Progress);
+		Apply_Solution(segment_id, status, solved_parameters, mTriggered_Solver_Time);
 	};
 
 	//do not forget that CTimeSegment is not reference-counted, so that we can omit all those addrefs and releases
@@ -523,8 +577,168 @@ void CCalculate_Filter::Run_Solver(const uint64_t segment_id) {
 	}
 }
 
+void CCalculate_Filter::Schedule_Async_Solver(const uint64_t segment_id) {
+	//snapshot the segments in the very same way, as Run_Solver enumerates them, so that the worker never touches mSegments
+	auto job = std::make_unique<TSolver_Job>();
+	job->triggered_time = mTriggered_Solver_Time;
+	job->hints = mParameter_Hints;	//the hints are deep copies, which we never modify
+
+	auto add_group = [&job](const uint64_t group_id, std::vector<std::unique_ptr<CTime_Segment>> segments) {
+		if (!segments.empty() && std::all_of(segments.begin(), segments.end(), [](const auto& segment) { return static_cast<bool>(segment); })) {
+			auto working_parameters = segments[0]->Get_Parameters();	//the snapshot has a deep copy of its own
+			job->groups.push_back(TSolver_Job::TSegment_Group{ group_id, std::move(segments), working_parameters });
+		}
+	};
+
+	if (!mSolve_All_Segments) {
+		if (segment_id != scgms::All_Segments_Id) {
+			const auto &segment = Get_Segment(segment_id);
+			if (segment) {
+				std::vector<std::unique_ptr<CTime_Segment>> snapshot;
+				snapshot.push_back(segment->Snapshot());
+				add_group(segment_id, std::move(snapshot));
+			}
+		}
+		else {
+			for (auto &segment : mSegments) {
+				std::vector<std::unique_ptr<CTime_Segment>> snapshot;
+				snapshot.push_back(segment.second->Snapshot());
+				add_group(segment_id, std::move(snapshot));
+			}
+		}
+	}
+	else {
+		std::vector<std::unique_ptr<CTime_Segment>> snapshot;
+		for (auto &segment : mSegments) {
+			snapshot.push_back(segment.second->Snapshot());
+		}
+		add_group(segment_id, std::move(snapshot));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{ mSolver_Guard };
+
+		//supersede whatever is being solved or waits to be solved
+		job->generation = ++mSolver_Generation;
+		if (mWorker_Progress) {
+			mWorker_Progress->cancelled = TRUE;
+		}
+		mPending_Job = std::move(job);
+
+		if (!mSolver_Thread.joinable()) {
+			mStop_Solver = false;
+			mSolver_Thread = std::thread{ &CCalculate_Filter::Async_Solver, this };
+		}
+	}
+
+	mSolver_Changed.notify_one();
+}
+
+void CCalculate_Filter::Async_Solver() {
+	scgms::SMetric metric{ scgms::TMetric_Parameters{ mMetric_Id, bool_2_uc(mUse_Relative_Error),  bool_2_uc(mUse_Squared_Differences), bool_2_uc(mPrefer_More_Levels),  mMetric_Threshold } };
+
+	while (true) {
+		std::unique_ptr<TSolver_Job> job;
+		{
+			std::unique_lock<std::mutex> lock{ mSolver_Guard };
+			mSolver_Changed.wait(lock, [this]() { return mStop_Solver || mPending_Job; });
+			if (!mPending_Job) {
+				return;	//stopped, or finished
+			}
+
+			job = std::move(mPending_Job);
+		}
+
+		for (auto &group : job->groups) {
+			solver::TSolver_Progress progress = solver::Null_Solver_Progress;
+			{
+				std::lock_guard<std::mutex> lock{ mSolver_Guard };
+				if (job->generation != mSolver_Generation) {
+					break;
+				}
+
+				mSolver_Progress = solver::Null_Solver_Progress;
+				mWorker_Progress = &progress;
+			}
+
+			std::vector<scgms::ITime_Segment*> raw_segments;
+			for (auto &segment : group.segments) {
+				raw_segments.push_back(static_cast<scgms::ITime_Segment*>(segment.get()));
+			}
+
+			//a private copy, the worker must not write into the shared default parameters
+			scgms::SModel_Parameter_Vector solved_parameters;
+			solved_parameters.set(mDefault_Parameters);
+
+			const auto status = Solve_Segments(raw_segments.data(), raw_segments.size(), metric, job->hints, group.working_parameters, solved_parameters, progress);
+
+			{
+				std::lock_guard<std::mutex> lock{ mSolver_Guard };
+				mWorker_Progress = nullptr;
+				mSolver_Progress = progress;
+
+				if (job->generation != mSolver_Generation) {
+					break;	//superseded while solving, the result is stale
+				}
+
+				mSolver_Results.push_back(TSolver_Result{ group.segment_id, status, solved_parameters, job->triggered_time });
+			}
+
+			if (status == scgms::TSolver_Status::Completed_Improved) {
+				job->hints.push_back(solved_parameters);	//as the synchronous solver would hint the next segments; nobody modifies them
+			}
+		}
+	}
+}
+
+void CCalculate_Filter::Apply_Async_Solutions() {
+	std::vector<TSolver_Result> results;
+	{
+		std::lock_guard<std::mutex> lock{ mSolver_Guard };
+		std::swap(results, mSolver_Results);
+	}
+
+	for (auto &result : results) {
+		Apply_Solution(result.segment_id, result.status, result.solved_parameters, result.triggered_time);
+	}
+}
+
+void CCalculate_Filter::Finish_Async_Solver() {
+	{
+		std::lock_guard<std::mutex> lock{ mSolver_Guard };
+		mStop_Solver = true;
+	}
+
+	mSolver_Changed.notify_all();
+
+	//the worker never waits for the chain, so we can wait for it
+	if (mSolver_Thread.joinable()) {
+		mSolver_Thread.join();
+	}
+}
+
+void CCalculate_Filter::Stop_Async_Solver() {
+	{
+		std::lock_guard<std::mutex> lock{ mSolver_Guard };
+		mStop_Solver = true;
+		mSolver_Generation++;
+		mPending_Job.reset();
+		mSolver_Results.clear();
+		if (mWorker_Progress) {
+			mWorker_Progress->cancelled = TRUE;
+		}
+	}
+
+	mSolver_Changed.notify_all();
+
+	if (mSolver_Thread.joinable()) {
+		mSolver_Thread.join();
+	}
+}
+
 HRESULT IfaceCalling CCalculate_Filter::Get_Solver_Progress(solver::TSolver_Progress* const progress) {
 	// copy progress structure
+	std::lock_guard<std::mutex> lock{ mSolver_Guard };
 	*progress = mSolver_Progress;
 
 	return S_OK;
@@ -538,7 +752,129 @@ HRESULT IfaceCalling CCalculate_Filter::Get_Solver_Information(GUID* const calcu
 }
 
 HRESULT IfaceCalling CCalculate_Filter::Cancel_Solver() {
+	std::lock_guard<std::mutex> lock{ mSolver_Guard };
 	mSolver_Progress.cancelled = TRUE;
+	if (mWorker_Progress) {
+		mWorker_Progress->cancelled = TRUE;
+	}
+
+	return S_OK;
+}
+
+HRESULT IfaceCalling CCalculate_Filter::Save_Checkpoint(refcnt::str_container* checkpoint) {
+	if (mParameters_Used) {
+		return S_FALSE;
+	}
+
+	for (const auto& segment : mSegments) {
+		if (segment.second->Parameters_Used()) {
+			return S_FALSE;
+		}
+	}
+
+	if (!checkpoint) {
+		return S_OK;
+	}
+
+	scgms::CCheckpoint_Writer writer;
+	writer.Write(mTriggered_Solver_Time);
+	writer.Write(mSolving_Scheduled);
+	writer.Write(mReference_Level_Counter);
+	writer.Write(mWarm_Reset_Done);
+
+	writer.Write(static_cast<uint64_t>(mParameter_Hints.size()));
+	for (auto& hint : mParameter_Hints) {
+		double *begin, *end;
+		if (hint->get(&begin, &end) != S_OK) {
+			begin = end = nullptr;
+		}
+		writer.Write(std::vector<double>{ begin, end });
+	}
+
+	writer.Write(static_cast<uint64_t>(mSegments.size()));
+	for (const auto& segment : mSegments) {
+		writer.Write(segment.first);
+		if (!segment.second->Save_Checkpoint(writer)) {
+			return S_FALSE;
+		}
+	}
+
+	return writer.Store(checkpoint);
+}
+
+HRESULT IfaceCalling CCalculate_Filter::Restore_Checkpoint(refcnt::str_container* checkpoint) {
+	if (!mSegments.empty()) {
+		return E_ILLEGAL_STATE_CHANGE;
+	}
+
+	scgms::CCheckpoint_Reader reader{ checkpoint };
+	reader.Read(mTriggered_Solver_Time);
+	reader.Read(mSolving_Scheduled);
+	reader.Read(mReference_Level_Counter);
+	reader.Read(mWarm_Reset_Done);
+
+	uint64_t hint_count = 0;
+	reader.Read(hint_count);
+	for (uint64_t i = 0; i < hint_count; i++) {
+		std::vector<double> hint;
+		if (!reader.Read(hint)) {
+			return E_INVALIDARG;
+		}
+		mParameter_Hints.push_back(refcnt::Create_Container_shared<double, scgms::SModel_Parameter_Vector>(hint.data(), hint.data() + hint.size()));
+	}
+
+	uint64_t segment_count = 0;
+	if (reader.Read(segment_count)) {
+		for (uint64_t i = 0; i < segment_count; i++) {
+			int64_t segment_id = 0;
+			if (!reader.Read(segment_id) || !Get_Segment(segment_id)->Restore_Checkpoint(reader)) {
+				return E_INVALIDARG;
+			}
+		}
+	}
+
+	return reader.Finished() ? S_OK : E_INVALIDARG;
+}
+
+HRESULT IfaceCalling CCalculate_Filter::Reset(const wchar_t* parameters_name, scgms::IModel_Parameter_Vector* parameters) {
+	double *begin = nullptr, *end = nullptr;
+	size_t count = 0;
+	if (parameters_name) {
+		if (!parameters || (std::wstring{ parameters_name } != rsSelected_Model_Bounds)) {
+			return E_INVALIDARG;
+		}
+
+		if (parameters->get(&begin, &end) != S_OK) {
+			return E_INVALIDARG;
+		}
+
+		count = static_cast<size_t>(end - begin) / 3;
+		if ((count == 0) || (count * 3 != static_cast<size_t>(end - begin))) {
+			return E_INVALIDARG;
+		}
+	}
+
+	//the worker reads the bounds and the default parameters, and it would queue the stale parameters otherwise
+	Stop_Async_Solver();
+
+	if (parameters_name) {
+		mLower_Bound = refcnt::Create_Container_shared<double, scgms::SModel_Parameter_Vector>(begin, begin + count);
+		mDefault_Parameters = refcnt::Create_Container_shared<double, scgms::SModel_Parameter_Vector>(begin + count, begin + 2 * count);
+		mUpper_Bound = refcnt::Create_Container_shared<double, scgms::SModel_Parameter_Vector>(begin + 2 * count, end);
+	}
+
+	mSegments.clear();	//they copied the former default parameters
+	mParameter_Hints.clear();
+	mSolving_Scheduled = false;
+	mReference_Level_Counter = 0;
+	mTriggered_Solver_Time = 0;
+	mWarm_Reset_Done = false;
+	mParameters_Used = false;
+	{
+		std::lock_guard<std::mutex> lock{ mSolver_Guard };
+		mSolver_Progress = solver::Null_Solver_Progress;
+	}
+	mSolver_Status = mSolver_Enabled ? scgms::TSolver_Status::Idle : scgms::TSolver_Status::Disabled;
 
 	return S_OK;
 }
@@ -39,11 +39,15 @@
 #include <scgms/rtl/FilterLib.h>
 #include <scgms/rtl/SolverLib.h>
 #include <scgms/rtl/referencedImpl.h>
+#include <scgms/rtl/FilterExtLib.h>
 
 #include "time_segment.h"
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <thread>
 
 #pragma warning( push )
 #pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
@@ -51,12 +55,14 @@
 /*
  * Filter class for calculating signals from incoming parameters
  */
-class CCalculate_Filter : public scgms::CBase_Filter, public scgms::ICalculate_Filter_Inspection {
+class CCalculate_Filter : public scgms::CBase_Filter, public scgms::ICalculate_Filter_Inspection, public scgms::IFilter_Checkpointable, public scgms::IFilter_Reusable {
 	protected:
 		// calculated signal ID
 		GUID mCalculated_Signal_Id = Invalid_GUID;
 		GUID mReference_Signal_Id = Invalid_GUID;
 		double mPrediction_Window = 0.0;
+		double mEmitted_Times_Retention = 0.0;
+		double mSignal_Retention = 0.0;	//zero keeps all the input levels
 		scgms::SModel_Parameter_Vector mDefault_Parameters, mLower_Bound, mUpper_Bound;
 		GUID mSolver_Id = Invalid_GUID;
 		GUID mMetric_Id = Invalid_GUID;
@@ -73,22 +79,64 @@ class CCalculate_Filter : public scgms::CBase_Filter, public scgms::ICalculate_F
 		bool mSolve_On_Calibration = true;
 		bool mSolve_On_Time_Segment_End = false;
 		bool mSolve_All_Segments = false;
+		bool mSolve_Asynchronously = false;
 		int64_t mReference_Level_Threshold_Count = 0;
 		int64_t mReference_Level_Counter = 0;
 		
 		bool mWarm_Reset_Done = false;
+		bool mParameters_Used = false;	//whether the parameters have affected the state, see the segments too
 		solver::TSolver_Progress mSolver_Progress = solver::Null_Solver_Progress;
 		scgms::TSolver_Status mSolver_Status = scgms::TSolver_Status::Disabled;
 		const bool mAllow_Update = true;			//should make it configurable once needed
 		std::map<int64_t, std::unique_ptr<CTime_Segment>> mSegments;
 		std::vector<scgms::SModel_Parameter_Vector> mParameter_Hints;
 
+		//asynchronous solving - the worker solves a snapshot of the segments, while the levels keep flowing with the present parameters
+		struct TSolver_Job {
+			struct TSegment_Group {
+				uint64_t segment_id;	//the one to apply the solved parameters to, may be All_Segments_Id
+				std::vector<std::unique_ptr<CTime_Segment>> segments;
+				scgms::SModel_Parameter_Vector working_parameters;
+			};
+
+			uint64_t generation = 0;
+			double triggered_time = 0.0;
+			std::vector<TSegment_Group> groups;
+			std::vector<scgms::SModel_Parameter_Vector> hints;
+		};
+
+		//the worker only queues its results, which the chain's thread applies and emits with the next event
+		//the worker must not send anything itself, as the chain may wait for it while holding its communication guard
+		struct TSolver_Result {
+			uint64_t segment_id;
+			scgms::TSolver_Status status;
+			scgms::SModel_Parameter_Vector solved_parameters;
+			double triggered_time;
+		};
+
+		std::mutex mSolver_Guard;				//guards the fields below and mSolver_Progress
+		std::condition_variable mSolver_Changed;
+		std::thread mSolver_Thread;
+		std::unique_ptr<TSolver_Job> mPending_Job;
+		std::vector<TSolver_Result> mSolver_Results;
+		uint64_t mSolver_Generation = 0;		//a newer solve supersedes, i.e. cancels, all the older ones
+		bool mStop_Solver = false;				//with a pending job, the worker solves it first
+		solver::TSolver_Progress *mWorker_Progress = nullptr;	//the worker's own one, while it solves; it publishes it to mSolver_Progress once done
+
 	protected:
 		std::unique_ptr<CTime_Segment>& Get_Segment(const uint64_t segment_id);
 		void Add_Level(const uint64_t segment_id, const GUID &signal_id, const double level, const double time_stamp);
 		void Add_Parameters_Hint(scgms::SModel_Parameter_Vector parameters);
 		void Schedule_Solving(const GUID& level_signal_id);
 		void Run_Solver(const uint64_t segment_id);
+		scgms::TSolver_Status Solve_Segments(scgms::ITime_Segment** segments, const size_t segment_count, scgms::SMetric& metric, const std::vector<scgms::SModel_Parameter_Vector>& hints,
+											 scgms::SModel_Parameter_Vector working_parameters, scgms::SModel_Parameter_Vector solved_parameters, solver::TSolver_Progress &progress);
+		void Apply_Solution(const uint64_t segment_id, const scgms::TSolver_Status status, scgms::SModel_Parameter_Vector solved_parameters, const double triggered_time);
+		void Schedule_Async_Solver(const uint64_t segment_id);
+		void Async_Solver();
+		void Apply_Async_Solutions();
+		void Finish_Async_Solver();		//lets the worker complete its job
+		void Stop_Async_Solver();		//cancels the worker's job and discards its results
 		double Calculate_Fitness(scgms::ITime_Segment** segments, const size_t segment_count, scgms::SMetric metric, scgms::IModel_Parameter_Vector* parameters);
 
 		virtual HRESULT Do_Execute(scgms::UDevice_Event event) override final;
@@ -102,6 +150,11 @@ class CCalculate_Filter : public scgms::CBase_Filter, public scgms::ICalculate_F
 		virtual HRESULT IfaceCalling Get_Solver_Progress(solver::TSolver_Progress* const progress) override;
 		virtual HRESULT IfaceCalling Get_Solver_Information(GUID* const calculated_signal_id, scgms::TSolver_Status* const status) const override;
 		virtual HRESULT IfaceCalling Cancel_Solver() override;
+
+		virtual HRESULT IfaceCalling Save_Checkpoint(refcnt::str_container* checkpoint) override final;
+		virtual HRESULT IfaceCalling Restore_Checkpoint(refcnt::str_container* checkpoint) override final;
+
+		virtual HRESULT IfaceCalling Reset(const wchar_t* parameters_name, scgms::IModel_Parameter_Vector* parameters) override final;
 };
 
 #pragma warning( pop )
@@ -0,0 +1,178 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "chunked_series.h"
+
+#include <algorithm>
+#include <cstring>
+
+size_t CChunked_Series::Find_Chunk(const double time) {
+	//try the last updated chunk and its successor first
+	if (mLast_Update_Chunk < mChunks.size()) {
+		const bool starts_before = mChunks[mLast_Update_Chunk]->times[0] <= time;
+		const bool next_starts_after = (mLast_Update_Chunk + 1 >= mChunks.size()) || (time < mChunks[mLast_Update_Chunk + 1]->times[0]);
+		if (starts_before && next_starts_after) {
+			return mLast_Update_Chunk;
+		}
+	}
+
+	auto iter = std::upper_bound(mChunks.begin(), mChunks.end(), time, [](const double time, const std::unique_ptr<TChunk>& chunk) {
+		return time < chunk->times[0];
+	});
+
+	return iter == mChunks.begin() ? 0 : static_cast<size_t>(std::distance(mChunks.begin(), iter) - 1);
+}
+
+void CChunked_Series::Insert_Into_Chunk(const size_t chunk_index, const double time, const double level) {
+	TChunk* chunk = mChunks[chunk_index].get();
+
+	if (chunk->count == Chunk_Capacity) {
+		//split the full chunk in halves, so that the following inserts nearby are cheap again
+		auto upper = std::make_unique<TChunk>();
+		const size_t half = Chunk_Capacity / 2;
+		upper->count = Chunk_Capacity - half;
+		std::memcpy(upper->times, chunk->times + half, upper->count * sizeof(double));
+		std::memcpy(upper->levels, chunk->levels + half, upper->count * sizeof(double));
+		chunk->count = half;
+
+		const bool into_upper = upper->times[0] <= time;
+		mChunks.insert(mChunks.begin() + chunk_index + 1, std::move(upper));
+		if (into_upper) {
+			Insert_Into_Chunk(chunk_index + 1, time, level);
+			return;
+		}
+	}
+
+	const size_t position = static_cast<size_t>(std::lower_bound(chunk->times, chunk->times + chunk->count, time) - chunk->times);
+	const size_t tail = chunk->count - position;
+	std::memmove(chunk->times + position + 1, chunk->times + position, tail * sizeof(double));
+	std::memmove(chunk->levels + position + 1, chunk->levels + position, tail * sizeof(double));
+	chunk->times[position] = time;
+	chunk->levels[position] = level;
+	chunk->count++;
+	mCount++;
+	mLast_Update_Chunk = chunk_index;
+}
+
+void CChunked_Series::Apply_Retention() {
+	//discard whole chunks only, so that the retention costs nothing most of the time
+	const double horizon = Back_Time() - mRetention;
+	size_t discarded = 0;
+	while ((mChunks.size() > 1) && (mChunks.front()->times[mChunks.front()->count - 1] < horizon)) {
+		mCount -= mChunks.front()->count;
+		mChunks.pop_front();
+		mLast_Update_Chunk = mLast_Update_Chunk > 0 ? mLast_Update_Chunk - 1 : 0;
+		discarded++;
+	}
+
+	if (discarded > 0) {
+		mSpans.erase(mSpans.begin(), mSpans.begin() + discarded);
+		mRevision++;
+	}
+}
+
+void CChunked_Series::Rebuild_Spans() {
+	mSpans.clear();
+	for (const auto& chunk : mChunks) {
+		mSpans.push_back(scgms::TLevels_Span{ chunk->times, chunk->levels, chunk->count });
+	}
+}
+
+void CChunked_Series::Update(const double time, const double level) {
+	if (mChunks.empty() || (Back_Time() < time)) {
+		//we expect this to happen almost all the time, however, not always
+		const bool new_chunk = mChunks.empty() || (mChunks.back()->count == Chunk_Capacity);
+		if (new_chunk) {
+			mChunks.push_back(std::make_unique<TChunk>());
+			mSpans.push_back(scgms::TLevels_Span{ mChunks.back()->times, mChunks.back()->levels, 0 });
+		}
+
+		TChunk* chunk = mChunks.back().get();
+		chunk->times[chunk->count] = time;
+		chunk->levels[chunk->count] = level;
+		chunk->count++;
+		mCount++;
+		mSpans.back().count = chunk->count;
+
+		if (new_chunk) {
+			Apply_Retention();	//only a completed chunk can become old enough
+		}
+		return;
+	}
+
+	//update or insert?
+	const size_t chunk_index = Find_Chunk(time);
+	TChunk* chunk = mChunks[chunk_index].get();
+	const double* found = std::lower_bound(chunk->times, chunk->times + chunk->count, time);
+	if ((found != chunk->times + chunk->count) && !(time < *found)) {
+		//we have found the time, we just update the value
+		chunk->levels[found - chunk->times] = level;
+		mLast_Update_Chunk = chunk_index;
+	}
+	else {
+		//not found, we have to insert; we expect inserts to be a rare phenomenon
+		Insert_Into_Chunk(chunk_index, time, level);
+		Rebuild_Spans();	//the chunk may have split
+	}
+
+	mRevision++;
+}
+
+size_t CChunked_Series::Copy(double* const times, double* const levels, const size_t count) const {
+	size_t copied = 0;
+	for (const auto& chunk : mChunks) {
+		const size_t to_copy = std::min(chunk->count, count - copied);
+		std::memcpy(times + copied, chunk->times, to_copy * sizeof(double));
+		std::memcpy(levels + copied, chunk->levels, to_copy * sizeof(double));
+		copied += to_copy;
+		if (copied == count) {
+			break;
+		}
+	}
+
+	return copied;
+}
+
+void CChunked_Series::Level_Bounds(double& min, double& max) const {
+	min = std::numeric_limits<double>::max();
+	max = -std::numeric_limits<double>::max();
+	for (const auto& chunk : mChunks) {
+		const auto res = std::minmax_element(chunk->levels, chunk->levels + chunk->count);
+		min = std::min(min, *res.first);
+		max = std::max(max, *res.second);
+	}
+}
@@ -0,0 +1,96 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#pragma once
+
+#include <scgms/iface/ApproxExtIface.h>
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/*
+ * Time-ordered series of levels stored in fixed-size chunks
+ *  - appending is amortized O(1) and never moves the stored levels
+ *  - an out-of-order level shifts at most one chunk, which splits once it is full
+ *  - whole chunks older than the retention horizon are discarded on append
+ */
+class CChunked_Series {
+	public:
+		static constexpr size_t Chunk_Capacity = 1024;
+
+	protected:
+		struct TChunk {
+			size_t count = 0;
+			double times[Chunk_Capacity];
+			double levels[Chunk_Capacity];
+		};
+
+		std::deque<std::unique_ptr<TChunk>> mChunks;
+		size_t mCount = 0;
+		size_t mLast_Update_Chunk = 0;	//updates usually occur for a certain recent period only, so we start searching there
+		double mRetention = std::numeric_limits<double>::infinity();
+		uint64_t mRevision = 0;			//incremented by any change, but appending after the latest level
+
+		//one span for each chunk, kept up to date by the updates, so that reading them never writes anything
+		std::vector<scgms::TLevels_Span> mSpans;
+
+		size_t Find_Chunk(const double time);	//index of the last chunk starting at or before the time, or zero
+		void Insert_Into_Chunk(const size_t chunk_index, const double time, const double level);
+		void Apply_Retention();
+		void Rebuild_Spans();
+
+	public:
+		void Set_Retention(const double retention) { mRetention = retention; }
+
+		size_t Size() const { return mCount; }
+		uint64_t Revision() const { return mRevision; }
+		bool Empty() const { return mCount == 0; }
+		double Front_Time() const { return mChunks.front()->times[0]; }
+		double Back_Time() const { return mChunks.back()->times[mChunks.back()->count - 1]; }
+
+		//appends, updates an already present time, or inserts the level
+		void Update(const double time, const double level);
+		//copies up to count oldest levels and returns the number of them
+		size_t Copy(double* const times, double* const levels, const size_t count) const;
+		void Level_Bounds(double& min, double& max) const;
+
+		//the spans remain valid until the next update
+		const std::vector<scgms::TLevels_Span>& Spans() const { return mSpans; }
+};
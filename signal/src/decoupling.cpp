@@ -35,16 +35,20 @@
  */
 
 #include "decoupling.h"
+#include "descriptor.h"
 
 #include "expression/expression.h"
 
 #include <scgms/rtl/UILib.h>
 #include <scgms/rtl/FilterLib.h>
+#include <scgms/rtl/FilterExtLib.h>
+#include <scgms/rtl/rattime.h>
 #include <scgms/utils/string_utils.h>
 #include <scgms/utils/math_utils.h>
 #include <scgms/lang/dstrings.h>
 
 #include <cmath>
+#include <ctime>
 #include <fstream>
 
 CDecoupling_Filter::CDecoupling_Filter(scgms::IFilter* output) : CBase_Filter(output) {
@@ -62,7 +66,12 @@ HRESULT IfaceCalling CDecoupling_Filter::Do_Configure(scgms::SFilter_Configurati
 	mDestination_Null = mDestination_Id == scgms::signal_Null;    
 	mRemove_From_Source = configuration.Read_Bool(rsRemove_From_Source, mRemove_From_Source);
 
-	mCondition = Parse_AST_Tree(configuration.Read_String(rsCondition), error_description);
+	const std::wstring condition_text = configuration.Read_String(rsCondition);
+	const CExpression condition = Parse_AST_Tree(condition_text, error_description);
+	mCondition = condition ? expression::CProgram{ *condition } : expression::CProgram{};
+	if (condition && !mCondition) {
+		error_description.push(std::wstring{ decoupling::dsCondition_Segment_Id } + condition_text);
+	}
 
 	mCollect_Statistics = configuration.Read_Bool(rsCollect_Statistics, mCollect_Statistics);
 	mCSV_Path = configuration.Read_File_Path(rsOutput_CSV_File);
@@ -75,7 +84,12 @@ HRESULT IfaceCalling CDecoupling_Filter::Do_Configure(scgms::SFilter_Configurati
 	return mCondition ? S_OK : E_FAIL;
 }
 
-HRESULT IfaceCalling CDecoupling_Filter::Do_Execute(scgms::UDevice_Event event) {
+bool CDecoupling_Filter::Is_Source(scgms::UDevice_Event& event) const {
+	return (event.signal_id() == mSource_Id) || mAny_Source_Signal;
+}
+
+template <typename TSend>
+HRESULT CDecoupling_Filter::Decouple(scgms::UDevice_Event& event, const bool decouple, TSend send) {
 	if (mCollect_Statistics) {
 		switch (event.event_code()) {
 			case scgms::NDevice_Event_Code::Warm_Reset:
@@ -83,7 +97,7 @@ HRESULT IfaceCalling CDecoupling_Filter::Do_Execute(scgms::UDevice_Event event)
 				break;
 
 			case scgms::NDevice_Event_Code::Shut_Down:
-				Flush_Stats();
+				Flush_Stats(send);
 				break;
 
 			default:
@@ -91,8 +105,7 @@ HRESULT IfaceCalling CDecoupling_Filter::Do_Execute(scgms::UDevice_Event event)
 		}
 	}
 
-	if ((event.signal_id() == mSource_Id) || mAny_Source_Signal) {
-		const bool decouple = mCondition->evaluate(event).bval;
+	if (Is_Source(event)) {
 		//cannot test mDestination_Null here, because we would be unable to collect statistics about the expression and release the event if needed
 
 		//clone and signal_Null means gather statistics only
@@ -117,7 +130,7 @@ HRESULT IfaceCalling CDecoupling_Filter::Do_Execute(scgms::UDevice_Event event)
 				//we have to clone it
 				auto clone = event.Clone();
 				clone.signal_id() = mDestination_Id;
-				HRESULT rc = mOutput.Send(clone);
+				HRESULT rc = send(clone);
 				if (!Succeeded(rc)) {
 					return rc;
 				}
@@ -125,7 +138,59 @@ HRESULT IfaceCalling CDecoupling_Filter::Do_Execute(scgms::UDevice_Event event)
 		}
 	}
 
-	return mOutput.Send(event);
+	return send(event);
+}
+
+HRESULT IfaceCalling CDecoupling_Filter::QueryInterface(const GUID*  riid, void ** ppvObj) {
+	if (Internal_Query_Interface<scgms::IFilter_Batch>(scgms::IID_Filter_Batch, *riid, ppvObj)) {
+		return S_OK;
+	}
+	return E_NOINTERFACE;
+}
+
+HRESULT IfaceCalling CDecoupling_Filter::Do_Execute(scgms::UDevice_Event event) {
+	const bool decouple = Is_Source(event) && mCondition.Evaluate(event);
+	return Decouple(event, decouple, [this](scgms::UDevice_Event& event_to_send) {
+		return mOutput.Send(event_to_send);
+	});
+}
+
+HRESULT IfaceCalling CDecoupling_Filter::Execute_Batch(scgms::IDevice_Event** begin, scgms::IDevice_Event** end) {
+	//clones are inserted in front of their originals, hence we cannot process the batch in place
+	std::vector<scgms::IDevice_Event*> batch_output;
+	std::vector<scgms::UDevice_Event> batch_input;
+	std::vector<uint8_t> conditions;
+	batch_output.swap(mBatch_Output);	//a possibly re-entrant call gets empty vectors
+	batch_input.swap(mBatch_Input);
+	conditions.swap(mBatch_Conditions);
+	batch_output.reserve(std::distance(begin, end));
+
+	auto collect = [&batch_output](scgms::UDevice_Event& event_to_send) {
+		batch_output.push_back(event_to_send.release());
+		return S_OK;
+	};
+
+	for (auto iter = begin; iter != end; iter++) {
+		batch_input.emplace_back(*iter);
+	}
+
+	//evaluate the condition for the whole batch at once, the events of other signals just ignore the result
+	conditions.resize(batch_input.size());
+	mCondition.Evaluate(batch_input.data(), batch_input.size(), conditions.data());
+
+	for (size_t i = 0; i < batch_input.size(); i++) {
+		Decouple(batch_input[i], conditions[i] != 0, collect);	//the collection cannot fail
+	}
+	batch_input.clear();
+
+	const HRESULT rc = scgms::Send_Batch(mOutput.get(), batch_output.data(), batch_output.data() + batch_output.size());
+
+	batch_output.clear();
+	mBatch_Output.swap(batch_output);	//keep the capacities for the next batch
+	mBatch_Input.swap(batch_input);
+	mBatch_Conditions.swap(conditions);
+
+	return rc;
 }
 
 void CDecoupling_Filter::Update_Stats(scgms::UDevice_Event& event, bool condition_true) {
@@ -183,10 +248,16 @@ void CDecoupling_Filter::Update_Stats(scgms::UDevice_Event& event, bool conditio
 	stats.recent_device_time = event.device_time();
 }
 
-void CDecoupling_Filter::Flush_Stats() {
+template <typename TSend>
+void CDecoupling_Filter::Flush_Stats(TSend send) {
 	std::wofstream stats_file{ mCSV_Path.c_str() };
 	if (!stats_file.is_open()) {
-		Emit_Info(scgms::NDevice_Event_Code::Error, std::wstring{ dsCannot_Open_File }+mCSV_Path.wstring());
+		//a batch holds the preceding events until it is sent, so the error must not overtake them
+		const std::wstring error_str = std::wstring{ dsCannot_Open_File } + mCSV_Path.wstring();
+		scgms::UDevice_Event error_event{ scgms::NDevice_Event_Code::Error };
+		error_event.device_time() = Unix_Time_To_Rat_Time(time(nullptr));
+		error_event.info.set(error_str.c_str());
+		send(error_event);
 		return;
 	}
 
@@ -39,6 +39,7 @@
 #include <scgms/rtl/FilterLib.h>
 #include <scgms/rtl/referencedImpl.h>
 #include <scgms/rtl/FilesystemLib.h>
+#include <scgms/iface/FilterExtIface.h>
 
 #include "expression/expression.h"
 
@@ -50,7 +51,7 @@
 /*
  * Filter class for mapping input signal GUID to another
  */
-class CDecoupling_Filter : public virtual scgms::CBase_Filter {
+class CDecoupling_Filter : public virtual scgms::CBase_Filter, public virtual scgms::IFilter_Batch {
 	protected:
 		// source signal ID (what signal will be mapped)
 		GUID mSource_Id = Invalid_GUID;
@@ -62,7 +63,7 @@ class CDecoupling_Filter : public virtual scgms::CBase_Filter {
 		bool mCollect_Statistics = false;
 		filesystem::path mCSV_Path;
 
-		CExpression mCondition;
+		expression::CProgram mCondition;
 
 		//stats
 		struct TSegment_Stats {
@@ -77,9 +78,19 @@ class CDecoupling_Filter : public virtual scgms::CBase_Filter {
 
 		std::map<uint64_t, TSegment_Stats> mStats;
 
+		std::vector<scgms::IDevice_Event*> mBatch_Output;	//reused to avoid reallocations
+		std::vector<scgms::UDevice_Event> mBatch_Input;
+		std::vector<uint8_t> mBatch_Conditions;
+
 	protected:
 		void Update_Stats(scgms::UDevice_Event& event, bool condition_true);
-		void Flush_Stats();
+		template <typename TSend>
+		void Flush_Stats(TSend send);	//sends the possible error through the same path as the events being decoupled
+
+		bool Is_Source(scgms::UDevice_Event& event) const;
+
+		template <typename TSend>
+		HRESULT Decouple(scgms::UDevice_Event& event, const bool decouple, TSend send);
 
 		virtual HRESULT Do_Execute(scgms::UDevice_Event event) override final;
 		virtual HRESULT Do_Configure(scgms::SFilter_Configuration configuration, refcnt::Swstr_list& error_description) override final;
@@ -87,6 +98,9 @@ class CDecoupling_Filter : public virtual scgms::CBase_Filter {
 	public:
 		CDecoupling_Filter(scgms::IFilter *output);
 		virtual ~CDecoupling_Filter() = default;
+
+		virtual HRESULT IfaceCalling QueryInterface(const GUID*  riid, void ** ppvObj) override;
+		virtual HRESULT IfaceCalling Execute_Batch(scgms::IDevice_Event** begin, scgms::IDevice_Event** end) override final;
 };
 
 #pragma warning( pop )
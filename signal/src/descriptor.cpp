@@ -54,13 +54,25 @@
 
 namespace calculate {
 
-	constexpr size_t param_count = 20;
+	const wchar_t* rsSolve_Asynchronously = L"Solve_Asynchronously";
+	const wchar_t* dsSolve_Asynchronously = L"Solve asynchronously";
+	const wchar_t* dsSolve_Asynchronously_Tooltip = L"Solves a snapshot of the segments on a background worker, while the levels keep being calculated with the present parameters";
+	const wchar_t* rsEmitted_Times_Retention = L"Emitted_Times_Retention";
+	const wchar_t* dsEmitted_Times_Retention = L"Emitted times retention";
+	const wchar_t* dsEmitted_Times_Retention_Tooltip = L"How far back from the latest calculated level the segment remembers the emitted times to avoid duplicities, and keeps the times it could not calculate yet";
+	const wchar_t* rsSignal_Retention = L"Signal_Retention";
+	const wchar_t* dsSignal_Retention = L"Input levels retention";
+	const wchar_t* dsSignal_Retention_Tooltip = L"How far back from the latest level the segment keeps the input levels, zero keeps them all; the solver then fits the retained levels only";
+
+	constexpr size_t param_count = 23;
 
 	constexpr scgms::NParameter_Type param_type[param_count] = {
 		scgms::NParameter_Type::ptNull,
 		scgms::NParameter_Type::ptSignal_Model_Id,
 		scgms::NParameter_Type::ptModel_Produced_Signal_Id,
 		scgms::NParameter_Type::ptRatTime,
+		scgms::NParameter_Type::ptRatTime,
+		scgms::NParameter_Type::ptRatTime,
 		scgms::NParameter_Type::ptNull,
 		scgms::NParameter_Type::ptBool,
 		scgms::NParameter_Type::ptSolver_Id,
@@ -69,6 +81,7 @@ namespace calculate {
 		scgms::NParameter_Type::ptBool,
 		scgms::NParameter_Type::ptBool,
 		scgms::NParameter_Type::ptBool,
+		scgms::NParameter_Type::ptBool,
 		scgms::NParameter_Type::ptNull,
 		scgms::NParameter_Type::ptMetric_Id,
 		scgms::NParameter_Type::ptInt64,
@@ -84,6 +97,8 @@ namespace calculate {
 		dsSelected_Model,
 		dsSelected_Signal,
 		dsPrediction_Window,
+		dsEmitted_Times_Retention,
+		dsSignal_Retention,
 		dsSolving_Parameters_Separator,
 		dsSolve_Parameters,
 		dsSelected_Solver,
@@ -92,6 +107,7 @@ namespace calculate {
 		dsSolve_On_Calibration,
 		dsSolve_On_Time_Segment_End,
 		dsSolve_Using_All_Segments,
+		dsSolve_Asynchronously,
 		dsMetric_Separator,
 		dsSelected_Metric,
 		dsMetric_Levels_Required,
@@ -107,6 +123,8 @@ namespace calculate {
 		rsSelected_Model,
 		rsSelected_Signal,
 		rsPrediction_Window,
+		rsEmitted_Times_Retention,
+		rsSignal_Retention,
 		nullptr,
 		rsSolve_Parameters,
 		rsSelected_Solver,
@@ -115,6 +133,7 @@ namespace calculate {
 		rsSolve_On_Calibration,
 		rsSolve_On_Time_Segment_End,
 		rsSolve_Using_All_Segments,
+		rsSolve_Asynchronously,
 		nullptr,
 		rsSelected_Metric,
 		rsMetric_Levels_Required,
@@ -130,6 +149,8 @@ namespace calculate {
 		dsSelected_Model_Tooltip,
 		dsSelected_Signal_Tooltip,
 		dsPrediction_Window_Tooltip,
+		dsEmitted_Times_Retention_Tooltip,
+		dsSignal_Retention_Tooltip,
 		nullptr,
 		nullptr,
 		nullptr,
@@ -138,6 +159,7 @@ namespace calculate {
 		nullptr,
 		nullptr,
 		nullptr,
+		dsSolve_Asynchronously_Tooltip,
 		nullptr,
 		nullptr,
 		dsMetric_Levels_Required_Hint,
@@ -199,6 +221,9 @@ namespace mapping
 
 namespace decoupling
 {
+	const wchar_t* dsCondition_Tooltip = L"Variables: level, device_time, time_of_day (hours since the midnight UTC), segment_id (compared with whole numbers only), is_level_event, is_info_event, is_control_event";
+	const wchar_t* dsCondition_Segment_Id = L"The condition can only compare segment_id with whole numbers or segment_id: ";
+
 	constexpr size_t param_count = 6;
 
 	constexpr scgms::NParameter_Type param_type[param_count] = {
@@ -232,7 +257,7 @@ namespace decoupling
 		dsMapping_Source_Signal_Tooltip,
 		dsMapping_Destination_Signal_Tooltip,
 		nullptr,
-		nullptr,
+		dsCondition_Tooltip,
 		nullptr,
 		nullptr
 	};
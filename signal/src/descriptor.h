@@ -41,6 +41,14 @@
 
 namespace calculate {
 	constexpr GUID Calculate_Filter_GUID = { 0x14a25f4c, 0xe1b1, 0x85c4,{ 0x12, 0x74, 0x9a, 0x0d, 0x11, 0xe0, 0x98, 0x13 } }; // {14A25F4C-E1B1-85C4-1274-9A0D11E09813}
+
+	extern const wchar_t* rsSolve_Asynchronously;
+	extern const wchar_t* rsEmitted_Times_Retention;
+	extern const wchar_t* rsSignal_Retention;
+}
+
+namespace decoupling {
+	extern const wchar_t* dsCondition_Segment_Id;
 }
 
 namespace signal_generator {
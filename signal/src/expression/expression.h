@@ -34,13 +34,20 @@
  *    Volume 177, pp. 354-362, 2020
  */
 
+
 #pragma once
 
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include <scgms/rtl/DeviceLib.h>
+#include <scgms/rtl/rattime.h>
 #include <scgms/utils/string_utils.h>
 
 namespace expression {
@@ -48,12 +55,59 @@ namespace expression {
 	union TIntermediate {
 		double dval;
 		bool bval;
+		uint64_t ival;	//segment_id and the whole-number literals compared with it
+	};
+
+	//the parsed tree is compiled to a flat sequence of instructions, which read and write registers
+	enum class NOpcode : uint8_t {
+		Load_level, Load_is_level_event, Load_is_info_event, Load_is_control_event, Load_device_time, Load_segment_id, Load_time_of_day,
+		Plus, Minus, Mul, Div,
+		LT, LTEQ, EQ, NEQ, GT, GTEQ,
+		ILT, ILTEQ, IEQ, INEQ, IGT, IGTEQ,		//the integer comparisons, which are not in the tree
+		AND, OR, XOR, Not,
+		count
+	};
+
+	constexpr size_t Load_Opcode_Count = static_cast<size_t>(NOpcode::Plus);
+
+	struct TInstruction {
+		NOpcode opcode;
+		uint32_t result, left, right;	//register indices
+	};
+
+	//either a value known while compiling, or a register that will hold it
+	struct TOperand {
+		bool constant;
+		TIntermediate value;
+		uint32_t reg;
+		bool integer = false;	//the value or the register holds ival
+	};
+
+	class CProgram_Builder {
+		protected:
+			std::vector<TInstruction> mCode;
+			std::vector<std::pair<uint32_t, TIntermediate>> mConstants;
+			std::array<uint32_t, Load_Opcode_Count> mLoaded_Variables;	//every variable is loaded once per event
+			uint32_t mRegister_Count = 0;
+			bool mRejected = false;		//segment_id was used otherwise than compared with a whole number
+
+			uint32_t Materialize(const TOperand &operand);
+		public:
+			CProgram_Builder();
+
+			TOperand Constant(const TIntermediate value);
+			TOperand Integer_Constant(const uint64_t value);
+			TOperand Load(const NOpcode opcode);
+			TOperand Emit(NOpcode opcode, TOperand left, TOperand right);	//folds the constants
+
+			friend class CProgram;
 	};
 
 	class CAST_Node {
 		public:
 			virtual ~CAST_Node() = default;
 			virtual TIntermediate evaluate(const scgms::UDevice_Event &event) = 0;
+			virtual TOperand compile(CProgram_Builder &builder) const = 0;
 	};
 	
 	template <typename T>
@@ -62,7 +116,7 @@ namespace expression {
 			T mValue;
 		public:
 			CConstant(T value) : mValue(value) {};
-			virtual TIntermediate evaluate(const scgms::UDevice_Event& event) override final {
+			TIntermediate Value() const {
 				TIntermediate result;
 
 				if constexpr (std::is_floating_point<T>::value) {
@@ -77,11 +131,30 @@ namespace expression {
 
 				return result; 
 			};
+
+			virtual TIntermediate evaluate(const scgms::UDevice_Event& event) override final {
+				return Value();
+			};
+
+			virtual TOperand compile(CProgram_Builder &builder) const override {
+				return builder.Constant(Value());
+			}
 	};
 
 	class CDouble : public virtual CConstant<double> {
+		protected:
+			bool mWhole_Number = false;
+			uint64_t mInteger = 0;	//exact value of a whole-number literal, so that segment_id can be compared with it
 		public:
-			CDouble(const char* str) : CConstant<double>(str_2_dbl(str)) { };
+			CDouble(const char* str) : CConstant<double>(str_2_dbl(str)) {
+				const char* end = str + std::char_traits<char>::length(str);
+				const auto parsed = std::from_chars(str, end, mInteger);
+				mWhole_Number = (parsed.ec == std::errc{}) && (parsed.ptr == end);
+			};
+
+			virtual TOperand compile(CProgram_Builder &builder) const override final {
+				return mWhole_Number ? builder.Integer_Constant(mInteger) : builder.Constant(Value());
+			}
 	};
 
 	class CNot : public virtual CAST_Node {
@@ -95,9 +168,14 @@ namespace expression {
 			  result.bval = !(mExpr->evaluate(event).bval);
 			  return result; 
 			}
+
+			virtual TOperand compile(CProgram_Builder &builder) const override final {
+				const TOperand operand = mExpr->compile(builder);
+				return builder.Emit(NOpcode::Not, operand, operand);
+			}
 	};
 
-	#define DSpecialized_Operator(name, result_arg, operand_arg, oper) \
+	#define DSpecialized_Operator(name, result_arg, operand_arg, oper, opcode) \
 		class name : public virtual CAST_Node { \
 			protected: \
 				std::unique_ptr<CAST_Node> mLeft, mRight; \
@@ -108,38 +186,122 @@ namespace expression {
 					result.result_arg = mLeft->evaluate(event).operand_arg oper mRight->evaluate(event).operand_arg; \
 					return result; \
 				} \
+				virtual TOperand compile(CProgram_Builder &builder) const override final { \
+					const TOperand left = mLeft->compile(builder); \
+					return builder.Emit(NOpcode::opcode, left, mRight->compile(builder)); \
+				} \
 		};
 
-	DSpecialized_Operator(CPlus, dval, dval, +)
-	DSpecialized_Operator(CMinus, dval, dval, -)
-	DSpecialized_Operator(CMul, dval, dval, *)
-	DSpecialized_Operator(CDiv, dval, dval, /)
+	DSpecialized_Operator(CPlus, dval, dval, +, Plus)
+	DSpecialized_Operator(CMinus, dval, dval, -, Minus)
+	DSpecialized_Operator(CMul, dval, dval, *, Mul)
+	DSpecialized_Operator(CDiv, dval, dval, /, Div)
+
+	DSpecialized_Operator(CLT, bval, dval, <, LT)
+	DSpecialized_Operator(CLTEQ, bval, dval, <=, LTEQ)
+	DSpecialized_Operator(CEQ, bval, dval, ==, EQ)
+	DSpecialized_Operator(CNEQ, bval, dval, !=, NEQ)
+	DSpecialized_Operator(CGT, bval, dval, >, GT)
+	DSpecialized_Operator(CGTEQ, bval, dval, >=, GTEQ)
+
+	DSpecialized_Operator(CAND, bval, bval, &&, AND)
+	DSpecialized_Operator(COR, bval, bval, ||, OR)
+	DSpecialized_Operator(CXOR, bval, bval, ^, XOR)
 
-	DSpecialized_Operator(CLT, bval, dval, <)
-	DSpecialized_Operator(CLTEQ, bval, dval, <= )
-	DSpecialized_Operator(CEQ, bval, dval, == )
-	DSpecialized_Operator(CNEQ, bval, dval, !=)
-	DSpecialized_Operator(CGT, bval, dval, > )
-	DSpecialized_Operator(CGTEQ, bval, dval, >= )
+	//hours since the midnight UTC, e.g., 6.5 is half past six; the rat time carries no time zone,
+	//so that its fraction of a day is the UTC time of day rather than the local one
+	inline double Time_Of_Day(const double device_time) {
+		return (device_time - std::floor(device_time)) / scgms::One_Hour;
+	}
 
-	DSpecialized_Operator(CAND, bval, bval, && )
-	DSpecialized_Operator(COR, bval, bval, ||)
-	DSpecialized_Operator(CXOR, bval, bval, ^)
+	//reads a variable of the event, for both the tree and the compiled code
+	template <NOpcode opcode>
+	TIntermediate Load_Variable(const scgms::UDevice_Event& event) {
+		TIntermediate result;
 
-	#define DSpecialized_Variable(operand_arg, result_arg) \
+		if constexpr (opcode == NOpcode::Load_level) {
+			result.dval = event.level();
+		}
+		else if constexpr (opcode == NOpcode::Load_is_level_event) {
+			result.bval = event.is_level_event();
+		}
+		else if constexpr (opcode == NOpcode::Load_is_info_event) {
+			result.bval = event.is_info_event();
+		}
+		else if constexpr (opcode == NOpcode::Load_is_control_event) {
+			result.bval = event.is_control_event();
+		}
+		else if constexpr (opcode == NOpcode::Load_device_time) {
+			result.dval = event.device_time();
+		}
+		else if constexpr (opcode == NOpcode::Load_segment_id) {
+			result.ival = static_cast<uint64_t>(event.segment_id());
+		}
+		else if constexpr (opcode == NOpcode::Load_time_of_day) {
+			result.dval = Time_Of_Day(event.device_time());
+		}
+		else {
+			static_assert(opcode != opcode, "Not a variable!");
+		}
+
+		return result;
+	}
+
+	#define DSpecialized_Variable(operand_arg) \
 		class CVariable_##operand_arg : public virtual CAST_Node { \
 			public: \
 				virtual TIntermediate evaluate(const scgms::UDevice_Event& event) override final { \
-					TIntermediate result; result.result_arg = event.operand_arg(); return result; \
+					return Load_Variable<NOpcode::Load_##operand_arg>(event); \
 				}; \
+				virtual TOperand compile(CProgram_Builder &builder) const override final { \
+					return builder.Load(NOpcode::Load_##operand_arg); \
+				} \
 		};
 
-	DSpecialized_Variable(level, dval)
-	DSpecialized_Variable(is_level_event, bval)
-	DSpecialized_Variable(is_info_event, bval)
-	DSpecialized_Variable(is_control_event, bval)
+	DSpecialized_Variable(level)
+	DSpecialized_Variable(is_level_event)
+	DSpecialized_Variable(is_info_event)
+	DSpecialized_Variable(is_control_event)
+	DSpecialized_Variable(device_time)
+	DSpecialized_Variable(time_of_day)
+
+	//the compiled program compares the id as an integer, so that even All_Segments_Id is exact;
+	//the untyped tree evaluates it as a double, which is exact up to 2^53
+	class CVariable_segment_id : public virtual CAST_Node {
+		public:
+			virtual TIntermediate evaluate(const scgms::UDevice_Event& event) override final {
+				TIntermediate result;
+				result.dval = static_cast<double>(event.segment_id());
+				return result;
+			};
+			virtual TOperand compile(CProgram_Builder &builder) const override final {
+				return builder.Load(NOpcode::Load_segment_id);
+			}
+	};
+
+	/*
+	 * Compiled expression, which evaluates the events without walking the tree
+	 */
+	class CProgram {
+		protected:
+			static constexpr size_t Lane_Count = 64;	//events evaluated by a single pass over the code
+
+			std::vector<TInstruction> mCode;
+			std::vector<TIntermediate> mLanes;			//Lane_Count values per register, the constants are filled once
+			uint32_t mResult = 0;
+		public:
+			CProgram() = default;
+			CProgram(const CAST_Node &root);	//empty, if the expression uses segment_id otherwise than compared with a whole number
+
+			bool Empty() const { return mLanes.empty(); }
+			explicit operator bool() const { return !Empty(); }
+
+			bool Evaluate(const scgms::UDevice_Event &event);
+			//evaluates the events in batches of lanes, results[i] is nonzero if the expression holds for events[i]
+			void Evaluate(const scgms::UDevice_Event *events, const size_t count, uint8_t *results);
+	};
 }
 
 using CExpression = std::unique_ptr<expression::CAST_Node>;
 
-CExpression Parse_AST_Tree(const std::wstring& wstr, refcnt::Swstr_list& error_description);
\ No newline at end of file
+CExpression Parse_AST_Tree(const std::wstring& wstr, refcnt::Swstr_list& error_description);
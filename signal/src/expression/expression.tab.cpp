@@ -1772,7 +1772,12 @@ yyreturn:
 #line 134 "expression.y"
 
 
-#include "lex.yy.c"
+//the scanner generated at build time, if flex is available; otherwise, the committed one generated from the same expression.l
+#ifdef EXPRESSION_GENERATED_SCANNER
+	#include EXPRESSION_GENERATED_SCANNER
+#else
+	#include "lex.yy.c"
+#endif
 
 CExpression Parse_AST_Tree(const std::wstring& wstr, refcnt::Swstr_list& error_description) {
    
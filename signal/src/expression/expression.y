@@ -131,7 +131,12 @@ error_state: T_ERROR { auto global_data = yyget_extra(scanner); global_data->fai
 
 %%
 
-#include "lex.yy.c"
+//the scanner generated at build time, if flex is available; otherwise, the committed one generated from the same expression.l
+#ifdef EXPRESSION_GENERATED_SCANNER
+	#include EXPRESSION_GENERATED_SCANNER
+#else
+	#include "lex.yy.c"
+#endif
 
 CExpression Parse_AST_Tree(const std::wstring& wstr, refcnt::Swstr_list& error_description) {
    
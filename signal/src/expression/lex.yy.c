@@ -350,8 +350,8 @@ static void yynoreturn yy_fatal_error ( const char* msg , yyscan_t yyscanner );
 	yyg->yy_hold_char = *yy_cp; \
 	*yy_cp = '\0'; \
 	yyg->yy_c_buf_p = yy_cp;
-#define YY_NUM_RULES 28
-#define YY_END_OF_BUFFER 29
+#define YY_NUM_RULES 31
+#define YY_END_OF_BUFFER 32
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -359,17 +359,21 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static const flex_int16_t yy_accept[82] =
+static const flex_int16_t yy_accept[113] =
     {   0,
-        0,    0,   29,   27,    1,   26,   16,   27,   14,   15,
-       12,   10,   11,   13,    3,   18,   27,   22,   25,   27,
-       27,   27,   27,   27,   20,   23,    0,    3,   17,   19,
-       21,    0,    0,    0,    0,   24,    2,    0,    0,    0,
-        0,    0,    0,    0,    0,    0,    8,    9,    0,    0,
-        0,    4,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,   32,   30,    1,   29,   19,   30,   17,   18,
+       15,   13,   14,   16,    3,   21,   30,   25,   28,   30,
+       30,   30,   30,   30,   30,   30,   23,   26,    0,    3,
+       20,   22,   24,    0,    0,    0,    0,    0,    0,    0,
+       27,    2,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,    0,    0,    0,    0,   11,    0,   12,
+        0,    0,    0,    4,    0,    0,    0,    0,    0,    0,
         0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
-        0,    0,    0,    0,    6,    0,    0,    5,    0,    7,
-        0
+        0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+        0,    0,    0,    0,    9,    0,    8,    0,    0,    0,
+
+       10,    0,    0,    0,    0,    6,    0,    0,    5,    0,
+        7,    0
     } ;
 
 static const YY_CHAR yy_ec[256] =
@@ -383,11 +387,11 @@ static const YY_CHAR yy_ec[256] =
        15,   16,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,   17,   18,    1,   19,    1,   20,    1,
+        1,    1,    1,   17,   18,    1,   19,    1,   20,   21,
 
-       21,   22,    1,    1,   23,    1,    1,   24,    1,   25,
-       26,    1,    1,   27,   28,   29,   30,   31,    1,    1,
-        1,    1,    1,   32,    1,    1,    1,    1,    1,    1,
+       22,   23,   24,    1,   25,    1,    1,   26,   27,   28,
+       29,    1,    1,   30,   31,   32,   33,   34,    1,    1,
+       35,    1,    1,   36,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
@@ -404,74 +408,96 @@ static const YY_CHAR yy_ec[256] =
         1,    1,    1,    1,    1
     } ;
 
-static const YY_CHAR yy_meta[33] =
+static const YY_CHAR yy_meta[37] =
     {   0,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1
+        1,    1,    1,    1,    1,    1
     } ;
 
-static const flex_int16_t yy_base[82] =
+static const flex_int16_t yy_base[113] =
     {   0,
-        0,    0,   92,   93,   93,   93,   76,   85,   93,   93,
-       93,   93,   93,   93,   22,   74,   73,   72,   93,   67,
-       57,   63,   56,   50,   93,   93,   68,   23,   93,   93,
-       93,   56,   61,   47,   47,   93,   63,   47,   17,   53,
-       52,   51,   45,   45,   48,   44,   93,   93,   42,   44,
-       34,   93,   35,   37,   41,   34,   42,   35,   32,   36,
-       38,   31,   23,   32,   34,   30,   19,   28,   23,   26,
-       15,   16,   19,   22,   93,   13,   14,   93,    9,   93,
-       93
+        0,   36,    0,  161,  161,  161,   58,   69,  161,  161,
+      161,  161,  161,  161,   64,   61,   63,   64,  161,   58,
+       62,   51,   61,   62,   60,   50,  161,  161,   74,   78,
+      161,  161,  161,   54,   66,   75,   60,   71,   69,   64,
+      161,   85,   74,   69,   81,   80,   76,   82,   83,   88,
+       87,   81,   83,   90,   87,   92,   97,  161,   94,  161,
+       89,   95,   85,  161,   92,   92,  104,   91,   95,  103,
+       94,  104,   96,   99,  112,  105,  114,  115,  109,  106,
+      114,  119,  113,  118,  113,  115,  108,  121,  123,  126,
+      124,  129,  126,  115,  161,  115,  161,  129,  124,  131,
+
+      161,  120,  123,  128,  135,  161,  126,  131,  161,  128,
+      161,  161
     } ;
 
-static const flex_int16_t yy_def[82] =
+static const flex_int16_t yy_def[113] =
     {   0,
-       81,    1,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-        0
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,    0
     } ;
 
-static const flex_int16_t yy_nxt[126] =
-    {   0,
+static const flex_int16_t yy_nxt[198] =
+    { 112,
         4,    5,    6,    7,    8,    9,   10,   11,   12,   13,
         4,   14,   15,   16,   17,   18,   19,    4,    4,    4,
-        4,   20,   21,   22,    4,    4,    4,    4,   23,    4,
-        4,   24,   27,   27,   28,   28,   43,   80,   79,   44,
-       45,   78,   77,   76,   75,   74,   73,   72,   71,   70,
-       69,   68,   67,   66,   65,   64,   63,   62,   61,   60,
-       59,   58,   57,   56,   55,   54,   53,   52,   51,   50,
-       49,   48,   47,   46,   42,   37,   41,   40,   39,   38,
-       37,   36,   35,   34,   33,   32,   31,   30,   29,   26,
-       25,   81,    3,   81,   81,   81,   81,   81,   81,   81,
-
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81
+       20,    4,   21,    4,   22,   23,    4,    4,    4,    4,
+       24,   25,    4,    4,    4,   26,    4,    5,    6,    7,
+        8,    9,   10,   11,   12,   13,    4,   14,   15,   16,
+       17,   18,   19,    4,    4,    4,   20,    4,   21,    4,
+       22,   23,    4,    4,    4,    4,   24,   25,    4,    4,
+        4,   26,   27,   28,   29,   31,   30,   32,   33,   34,
+       35,   36,   37,   38,   39,   41,   42,   43,   29,   40,
+       30,   44,   45,   46,   47,   48,   49,   42,   50,   51,
+
+       52,   55,   56,   57,   58,   53,   54,   59,   60,   61,
+       62,   63,   64,   65,   66,   67,   68,   69,   70,   71,
+       72,   73,   74,   75,   76,   77,   78,   79,   80,   81,
+       82,   83,   84,   85,   86,   87,   88,   89,   90,   91,
+       92,   93,   94,   95,   96,   97,   98,   99,  100,  101,
+      102,  103,  104,  105,  106,  107,  108,  109,  110,  111,
+        3,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112
     } ;
 
-static const flex_int16_t yy_chk[126] =
-    {   0,
+static const flex_int16_t yy_chk[198] =
+    {   3,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,   15,   28,   15,   28,   39,   79,   77,   39,
-       39,   76,   74,   73,   72,   71,   70,   69,   68,   67,
-       66,   65,   64,   63,   62,   61,   60,   59,   58,   57,
-       56,   55,   54,   53,   51,   50,   49,   46,   45,   44,
-       43,   42,   41,   40,   38,   37,   35,   34,   33,   32,
-       27,   24,   23,   22,   21,   20,   18,   17,   16,    8,
-        7,    3,   81,   81,   81,   81,   81,   81,   81,   81,
-
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81,   81,   81,   81,   81,   81,
-       81,   81,   81,   81,   81
+        1,    1,    1,    1,    1,    1,    2,    2,    2,    2,
+        2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+        2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+        2,    2,    2,    2,    2,    2,    2,    2,    2,    2,
+        2,    2,    7,    8,   15,   16,   15,   17,   18,   20,
+       21,   22,   23,   24,   25,   26,   29,   34,   30,   25,
+       30,   35,   36,   37,   38,   39,   40,   42,   43,   44,
+
+       45,   46,   47,   48,   49,   45,   45,   50,   51,   52,
+       53,   54,   55,   56,   57,   59,   61,   62,   63,   65,
+       66,   67,   68,   69,   70,   71,   72,   73,   74,   75,
+       76,   77,   78,   79,   80,   81,   82,   83,   84,   85,
+       86,   87,   88,   89,   90,   91,   92,   93,   94,   96,
+       98,   99,  100,  102,  103,  104,  105,  107,  108,  110,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112,  112,  112,  112,
+      112,  112,  112,  112,  112,  112,  112
     } ;
 
 /* The intent behind this definition is that it'll catch
@@ -536,8 +562,8 @@ static const flex_int16_t yy_chk[126] =
 
 #include "expression.tab.hpp"
   #include "expression.h"
-#line 539 "lex.yy.c"
-#line 540 "lex.yy.c"
+#line 565 "lex.yy.c"
+#line 566 "lex.yy.c"
 
 #define INITIAL 0
 
@@ -812,7 +838,7 @@ YY_DECL
 #line 64 "expression.l"
 
 
-#line 815 "lex.yy.c"
+#line 841 "lex.yy.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -839,13 +865,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 82 )
+				if ( yy_current_state >= 113 )
 					yy_c = yy_meta[yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 93 );
+		while ( yy_base[yy_current_state] != 161 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -907,110 +933,125 @@ YY_RULE_SETUP
 case 8:
 YY_RULE_SETUP
 #line 73 "expression.l"
-{yylval->ast_node = new expression::CConstant<bool>(true); return T_BOOL;}
+{yylval->ast_node = new expression::CVariable_device_time(); return T_DOUBLE;}
 	YY_BREAK
 case 9:
 YY_RULE_SETUP
 #line 74 "expression.l"
-{yylval->ast_node = new expression::CConstant<bool>(false); return T_BOOL;}
+{yylval->ast_node = new expression::CVariable_segment_id(); return T_DOUBLE;}
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
 #line 75 "expression.l"
-{return T_PLUS;}
+{yylval->ast_node = new expression::CVariable_time_of_day(); return T_DOUBLE;}
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
 #line 76 "expression.l"
-{return T_MINUS;}
+{yylval->ast_node = new expression::CConstant<bool>(true); return T_BOOL;}
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
 #line 77 "expression.l"
-{return T_MULTIPLY;}
+{yylval->ast_node = new expression::CConstant<bool>(false); return T_BOOL;}
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
 #line 78 "expression.l"
-{return T_DIVIDE;}
+{return T_PLUS;}
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
 #line 79 "expression.l"
-{return T_LEFT;}
+{return T_MINUS;}
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
 #line 80 "expression.l"
-{return T_RIGHT;}
+{return T_MULTIPLY;}
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
 #line 81 "expression.l"
-{return T_NOT;}
+{return T_DIVIDE;}
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
 #line 82 "expression.l"
-{return T_LTEQ;}
+{return T_LEFT;}
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
 #line 83 "expression.l"
-{return T_LT;}
+{return T_RIGHT;}
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
 #line 84 "expression.l"
-{return T_EQ;}
+{return T_NOT;}
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
 #line 85 "expression.l"
-{return T_NEQ;}
+{return T_LTEQ;}
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
 #line 86 "expression.l"
-{return T_GTEQ;}
+{return T_LT;}
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
 #line 87 "expression.l"
-{return T_GT;}
+{return T_EQ;}
 	YY_BREAK
 case 23:
 YY_RULE_SETUP
 #line 88 "expression.l"
-{return T_AND;}
+{return T_NEQ;}
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
 #line 89 "expression.l"
-{return T_OR;}
+{return T_GTEQ;}
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
 #line 90 "expression.l"
-{return T_XOR;}
+{return T_GT;}
 	YY_BREAK
 case 26:
-/* rule 26 can match eol */
 YY_RULE_SETUP
 #line 91 "expression.l"
-{return T_ERROR;}
+{return T_AND;}
 	YY_BREAK
 case 27:
 YY_RULE_SETUP
 #line 92 "expression.l"
-{std::string err_msg {dsInvalid_expression_character}; err_msg += yytext; yyerror(yyscanner, err_msg.c_str()); return T_ERROR;}
+{return T_OR;}
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
+#line 93 "expression.l"
+{return T_XOR;}
+	YY_BREAK
+case 29:
+/* rule 29 can match eol */
+YY_RULE_SETUP
 #line 94 "expression.l"
+{return T_ERROR;}
+	YY_BREAK
+case 30:
+YY_RULE_SETUP
+#line 95 "expression.l"
+{std::string err_msg {dsInvalid_expression_character}; err_msg += yytext; yyerror(yyscanner, err_msg.c_str()); return T_ERROR;}
+	YY_BREAK
+case 31:
+YY_RULE_SETUP
+#line 97 "expression.l"
 YY_FATAL_ERROR( "flex scanner jammed" );
 	YY_BREAK
-#line 1013 "lex.yy.c"
+#line 1054 "lex.yy.c"
 case YY_STATE_EOF(INITIAL):
 	yyterminate();
 
@@ -1309,7 +1350,7 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 82 )
+			if ( yy_current_state >= 113 )
 				yy_c = yy_meta[yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
@@ -1338,11 +1379,11 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 82 )
+		if ( yy_current_state >= 113 )
 			yy_c = yy_meta[yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + yy_c];
-	yy_is_jam = (yy_current_state == 81);
+	yy_is_jam = (yy_current_state == 112);
 
 	(void)yyg;
 	return yy_is_jam ? 0 : yy_current_state;
@@ -2191,5 +2232,5 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 #define YYTABLES_NAME "yytables"
 
-#line 94 "expression.l"
+#line 97 "expression.l"
 
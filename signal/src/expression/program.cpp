@@ -0,0 +1,253 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "expression.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace expression {
+
+	namespace {
+		constexpr uint32_t Not_Loaded = std::numeric_limits<uint32_t>::max();
+
+		//applies the operator to all the lanes; a single lane folds the constants while compiling
+		void Apply_Operator(const NOpcode opcode, const TIntermediate *left, const TIntermediate *right, TIntermediate *result, const size_t lanes) {
+			#define DLane_Operator(name, result_arg, operand_arg, oper) \
+				case NOpcode::name: \
+					for (size_t i = 0; i < lanes; i++) { \
+						result[i].result_arg = left[i].operand_arg oper right[i].operand_arg; \
+					} \
+					break;
+
+			switch (opcode) {
+				DLane_Operator(Plus, dval, dval, +)
+				DLane_Operator(Minus, dval, dval, -)
+				DLane_Operator(Mul, dval, dval, *)
+				DLane_Operator(Div, dval, dval, /)
+
+				DLane_Operator(LT, bval, dval, <)
+				DLane_Operator(LTEQ, bval, dval, <=)
+				DLane_Operator(EQ, bval, dval, ==)
+				DLane_Operator(NEQ, bval, dval, !=)
+				DLane_Operator(GT, bval, dval, >)
+				DLane_Operator(GTEQ, bval, dval, >=)
+
+				DLane_Operator(ILT, bval, ival, <)
+				DLane_Operator(ILTEQ, bval, ival, <=)
+				DLane_Operator(IEQ, bval, ival, ==)
+				DLane_Operator(INEQ, bval, ival, !=)
+				DLane_Operator(IGT, bval, ival, >)
+				DLane_Operator(IGTEQ, bval, ival, >=)
+
+				DLane_Operator(AND, bval, bval, &&)
+				DLane_Operator(OR, bval, bval, ||)
+				DLane_Operator(XOR, bval, bval, ^)
+
+				case NOpcode::Not:
+					for (size_t i = 0; i < lanes; i++) {
+						result[i].bval = !left[i].bval;
+					}
+					break;
+
+				default:
+					break;
+			}
+
+			#undef DLane_Operator
+		}
+
+		//the integer counterpart of a comparison, or NOpcode::count, if the opcode does not compare
+		NOpcode Integer_Comparison(const NOpcode opcode) {
+			switch (opcode) {
+				case NOpcode::LT:	return NOpcode::ILT;
+				case NOpcode::LTEQ:	return NOpcode::ILTEQ;
+				case NOpcode::EQ:	return NOpcode::IEQ;
+				case NOpcode::NEQ:	return NOpcode::INEQ;
+				case NOpcode::GT:	return NOpcode::IGT;
+				case NOpcode::GTEQ:	return NOpcode::IGTEQ;
+				default:			return NOpcode::count;
+			}
+		}
+
+		//a whole-number literal becomes a double again, unless compared with segment_id; segment_id itself cannot
+		bool Promote_To_Double(TOperand &operand) {
+			if (!operand.integer) {
+				return true;
+			}
+
+			if (!operand.constant) {
+				return false;
+			}
+
+			operand.value.dval = static_cast<double>(operand.value.ival);
+			operand.integer = false;
+			return true;
+		}
+
+		template <NOpcode opcode>
+		void Load_Lanes(const scgms::UDevice_Event *events, TIntermediate *result, const size_t lanes) {
+			for (size_t i = 0; i < lanes; i++) {
+				result[i] = Load_Variable<opcode>(events[i]);
+			}
+		}
+	}
+
+	CProgram_Builder::CProgram_Builder() {
+		mLoaded_Variables.fill(Not_Loaded);
+	}
+
+	TOperand CProgram_Builder::Constant(const TIntermediate value) {
+		return TOperand{ true, value, 0 };
+	}
+
+	TOperand CProgram_Builder::Integer_Constant(const uint64_t value) {
+		TIntermediate integer;
+		integer.ival = value;
+		return TOperand{ true, integer, 0, true };
+	}
+
+	TOperand CProgram_Builder::Load(const NOpcode opcode) {
+		uint32_t &reg = mLoaded_Variables[static_cast<size_t>(opcode)];
+		if (reg == Not_Loaded) {
+			reg = mRegister_Count++;
+			mCode.push_back(TInstruction{ opcode, reg, reg, reg });
+		}
+
+		return TOperand{ false, {}, reg, opcode == NOpcode::Load_segment_id };
+	}
+
+	uint32_t CProgram_Builder::Materialize(const TOperand &operand) {
+		if (!operand.constant) {
+			return operand.reg;
+		}
+
+		const uint32_t reg = mRegister_Count++;
+		mConstants.push_back({ reg, operand.value });
+		return reg;
+	}
+
+	TOperand CProgram_Builder::Emit(NOpcode opcode, TOperand left, TOperand right) {
+		//two integers compare exactly, otherwise the operands have to be doubles
+		if (left.integer && right.integer && (Integer_Comparison(opcode) != NOpcode::count)) {
+			opcode = Integer_Comparison(opcode);
+		}
+		else if (!Promote_To_Double(left) || !Promote_To_Double(right)) {
+			mRejected = true;
+			return Constant({});
+		}
+
+		if (left.constant && right.constant) {
+			TOperand folded{ true, {}, 0 };
+			Apply_Operator(opcode, &left.value, &right.value, &folded.value, 1);
+			return folded;
+		}
+
+		//a single constant operand decides the logical operators, or leaves the other operand as their result
+		if ((opcode == NOpcode::AND) || (opcode == NOpcode::OR)) {
+			const TOperand &known = left.constant ? left : right;
+			const TOperand &other = left.constant ? right : left;
+			if (known.constant) {
+				return known.value.bval == (opcode == NOpcode::OR) ? known : other;
+			}
+		}
+
+		const uint32_t left_reg = Materialize(left);
+		const uint32_t right_reg = Materialize(right);
+		const uint32_t result_reg = mRegister_Count++;
+		mCode.push_back(TInstruction{ opcode, result_reg, left_reg, right_reg });
+
+		return TOperand{ false, {}, result_reg };
+	}
+
+	CProgram::CProgram(const CAST_Node &root) {
+		CProgram_Builder builder;
+		const TOperand result = root.compile(builder);
+		if (builder.mRejected || result.integer) {
+			return;	//stays empty
+		}
+
+		mResult = builder.Materialize(result);
+
+		mCode = std::move(builder.mCode);
+		mLanes.resize(static_cast<size_t>(builder.mRegister_Count) * Lane_Count);
+		for (const auto &constant : builder.mConstants) {
+			std::fill_n(mLanes.begin() + static_cast<size_t>(constant.first) * Lane_Count, Lane_Count, constant.second);
+		}
+	}
+
+	bool CProgram::Evaluate(const scgms::UDevice_Event &event) {
+		uint8_t result = 0;
+		Evaluate(&event, 1, &result);
+		return result != 0;
+	}
+
+	void CProgram::Evaluate(const scgms::UDevice_Event *events, const size_t count, uint8_t *results) {
+		TIntermediate *registers = mLanes.data();
+
+		for (size_t block = 0; block < count; block += Lane_Count) {
+			const size_t lanes = std::min(Lane_Count, count - block);
+			const scgms::UDevice_Event *block_events = events + block;
+
+			for (const auto &instruction : mCode) {
+				TIntermediate *result = registers + static_cast<size_t>(instruction.result) * Lane_Count;
+
+				switch (instruction.opcode) {
+					case NOpcode::Load_level:				Load_Lanes<NOpcode::Load_level>(block_events, result, lanes); break;
+					case NOpcode::Load_is_level_event:		Load_Lanes<NOpcode::Load_is_level_event>(block_events, result, lanes); break;
+					case NOpcode::Load_is_info_event:		Load_Lanes<NOpcode::Load_is_info_event>(block_events, result, lanes); break;
+					case NOpcode::Load_is_control_event:	Load_Lanes<NOpcode::Load_is_control_event>(block_events, result, lanes); break;
+					case NOpcode::Load_device_time:			Load_Lanes<NOpcode::Load_device_time>(block_events, result, lanes); break;
+					case NOpcode::Load_segment_id:			Load_Lanes<NOpcode::Load_segment_id>(block_events, result, lanes); break;
+					case NOpcode::Load_time_of_day:			Load_Lanes<NOpcode::Load_time_of_day>(block_events, result, lanes); break;
+
+					default:
+						Apply_Operator(instruction.opcode,
+										registers + static_cast<size_t>(instruction.left) * Lane_Count,
+										registers + static_cast<size_t>(instruction.right) * Lane_Count,
+										result, lanes);
+						break;
+				}
+			}
+
+			const TIntermediate *result = registers + static_cast<size_t>(mResult) * Lane_Count;
+			for (size_t i = 0; i < lanes; i++) {
+				results[block + i] = result[i].bval ? 1 : 0;
+			}
+		}
+	}
+}
@@ -40,12 +40,84 @@
 #include <scgms/rtl/UILib.h>
 #include <scgms/rtl/referencedImpl.h>
 
+#include <scgms/rtl/ApproxExtLib.h>
+
 #include <numeric>
 #include <execution> 
 
 thread_local scgms::SMetric CFitness::mMetric_Per_Thread;
 thread_local aligned_double_vector CFitness::mTemporal_Levels;
 
+bool Update_Reference_Levels(TReference_Levels &reference, scgms::ISignal *reference_signal, const bool use_measured_levels) {
+	auto clear = [&reference]() {
+		reference.measured_count = 0;
+		reference.revision_known = false;
+		reference.times.clear();
+		reference.levels.clear();
+	};
+
+	size_t levels_count = 0;
+	scgms::TBounds time_bounds;
+	if ((reference_signal->Get_Discrete_Bounds(&time_bounds, nullptr, &levels_count) != S_OK) || (levels_count == 0)) {
+		clear();
+		return false;
+	}
+
+	if (reference.approximated == use_measured_levels) {
+		clear();	//configured the other way, start over
+		reference.approximated = !use_measured_levels;
+	}
+
+	//with the same revision, the known levels are still the leading ones; without it, we cannot tell the appended levels apart
+	uint64_t revision = 0;
+	const bool revision_known = scgms::Get_Discrete_Revision(reference_signal, revision);
+	const size_t known = reference.measured_count;
+	const bool same_revision = revision_known && reference.revision_known && (revision == reference.revision);
+
+	if ((known > 0) && (levels_count == known)) {
+		const bool unchanged = revision_known ? same_revision : ((time_bounds.Min == reference.first_time) && (time_bounds.Max == reference.last_time));
+		if (unchanged) {
+			return !reference.times.empty();
+		}
+	}
+
+	const size_t first_copied = same_revision && (known > 0) && (levels_count > known) ? known : 0;
+	reference.times.resize(levels_count);
+	reference.levels.resize(levels_count);
+
+	size_t offset = 0;
+	const HRESULT rc = scgms::For_Each_Discrete_Span(reference_signal, [&](const double* times, const double* levels, const size_t count) {
+		const size_t end = std::min(offset + count, levels_count);
+		for (size_t i = std::max(offset, first_copied); i < end; i++) {
+			reference.times[i] = times[i - offset];
+			reference.levels[i] = levels[i - offset];
+		}
+		offset += count;
+	});
+
+	if ((rc != S_OK) || (offset < levels_count)) {
+		clear();
+		return false;
+	}
+
+	reference.measured_count = levels_count;
+	reference.revision_known = revision_known;
+	reference.revision = revision;
+	reference.first_time = time_bounds.Min;
+	reference.last_time = time_bounds.Max;
+
+	//if desired, replace them continous signal approdximation
+	if (!use_measured_levels) {
+		//the approximation may change around the appended levels, so we approximate a few former ones again - if the approximator tells how many
+		size_t preceding_affected = 0;
+		const size_t first_approximated = (first_copied > 0) && scgms::Get_Preceding_Affected_Levels(reference_signal, preceding_affected) && (first_copied > preceding_affected) ? first_copied - preceding_affected : 0;
+		reference_signal->Get_Continuous_Levels(nullptr, reference.times.data() + first_approximated, reference.levels.data() + first_approximated, levels_count - first_approximated, scgms::apxNo_Derivation);
+		//we are not interested in checking the possibly error, because we will be left with meeasured levels at least
+	}
+
+	return true;
+}
+
 CFitness::CFitness(const TSegment_Solver_Setup &setup, const size_t solution_size)
 	: mLevels_Required(setup.levels_required), mSolution_Size(solution_size) {
 
@@ -57,7 +129,7 @@ CFitness::CFitness(const TSegment_Solver_Setup &setup, const size_t solution_siz
 
 		std::shared_ptr<scgms::ITime_Segment> setup_segment= refcnt::make_shared_reference<scgms::ITime_Segment>(setup.segments[segment_iter], true);
 
-		TSegment_Info info{ nullptr, nullptr, nullptr, {}, {} };
+		TSegment_Info info{ nullptr, nullptr, nullptr, nullptr };
 		info.segment = setup_segment;
 
 		scgms::ISignal *signal;
@@ -71,28 +143,18 @@ CFitness::CFitness(const TSegment_Solver_Setup &setup, const size_t solution_siz
 
 		if (info.calculated_signal && info.reference_signal) {
 
-			size_t levels_count;
-			if (info.reference_signal->Get_Discrete_Bounds(nullptr, nullptr, &levels_count) == S_OK && levels_count > 0) {
-				info.reference_time.resize(levels_count);
-				info.reference_level.resize(levels_count);
-					
-				//prepare arrays with reference levels and their times
-				if (info.reference_signal->Get_Discrete_Levels(info.reference_time.data(), info.reference_level.data(), info.reference_time.size(), &levels_count) == S_OK) {
-					info.reference_time.resize(levels_count);
-					info.reference_level.resize(levels_count);
-				}
-
-				//if desired, replace them continous signal approdximation
-				if (setup.use_measured_levels == 0) {
-					info.reference_signal->Get_Continuous_Levels(nullptr, info.reference_time.data(), info.reference_level.data(), info.reference_time.size(), scgms::apxNo_Derivation);
-					//we are not interested in checking the possibly error, because we will be left with meeasured levels at least
-				}
+			if (setup.reference_levels && setup.reference_levels[segment_iter]) {
+				info.reference = std::shared_ptr<TReference_Levels>{ setup.reference_levels[segment_iter], [](TReference_Levels*) {} };	//not owned
+			}
+			else {
+				info.reference = std::make_shared<TReference_Levels>();
+			}
 
+			//prepare arrays with reference levels and their times, possibly replaced with the continuous approximation
+			if (Update_Reference_Levels(*info.reference, info.reference_signal.get(), setup.use_measured_levels != 0)) {
 				//do we have everyting we need to test this segment?
-				if (!info.reference_time.empty()) {
-					mMax_Levels_Per_Segment = std::max(mMax_Levels_Per_Segment, info.reference_time.size());
-					mSegment_Info.push_back(info);
-				}
+				mMax_Levels_Per_Segment = std::max(mMax_Levels_Per_Segment, info.reference->times.size());
+				mSegment_Info.push_back(info);
 			}
 
 		} //if we managed to get both segment and signal
@@ -129,9 +191,10 @@ double CFitness::Calculate_Fitness(const double *solution) {
 	refcnt::internal::CVector_View<double> solution_view{ solution, solution + mSolution_Size };
 
 	for (auto &info : mSegment_Info) {
-		if (info.calculated_signal->Get_Continuous_Levels(&solution_view, info.reference_time.data(), tmp_levels, info.reference_time.size(), scgms::apxNo_Derivation) == S_OK) {
+		const auto& reference = *info.reference;
+		if (info.calculated_signal->Get_Continuous_Levels(&solution_view, reference.times.data(), tmp_levels, reference.times.size(), scgms::apxNo_Derivation) == S_OK) {
 			//levels got, calculate the metric
-			metric->Accumulate(info.reference_time.data(), info.reference_level.data(), tmp_levels, info.reference_time.size());
+			metric->Accumulate(reference.times.data(), reference.levels.data(), tmp_levels, reference.times.size());
 		}
 		else {
 			//quit immediatelly as the paramters must be valid for all segments
@@ -39,12 +39,28 @@
 #include <scgms/rtl/SolverLib.h>
 #include <scgms/rtl/AlignmentAllocator.h>
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #undef max
 
 using aligned_double_vector = std::vector<double, AlignmentAllocator<double>>;	//Needed for Eigen and SIMD optimizations
 
+//reference levels of a segment, kept across the solver runs, so that just the appended levels are copied and approximated
+struct TReference_Levels {
+	size_t measured_count = 0;		//count of the reference signal's levels, which the arrays reflect
+	bool revision_known = false;	//whether the signal has told its revision, so that the appended levels can be told apart
+	uint64_t revision = 0;			//of the reference signal's levels, which the arrays reflect
+	double first_time = 0.0, last_time = 0.0;	//of the reference signal's levels, for the signals, which do not tell their revision
+	bool approximated = false;		//whether the levels were replaced with the continuous approximation
+	aligned_double_vector times;
+	aligned_double_vector levels;
+};
+
+//brings the reference levels up to date with the reference signal; false if there are no levels
+bool Update_Reference_Levels(TReference_Levels &reference, scgms::ISignal *reference_signal, const bool use_measured_levels);
+
 struct TSegment_Solver_Setup {
 	const GUID solver_id; const GUID calculated_signal_id; const GUID reference_signal_id;
 	scgms::ITime_Segment** segments; const size_t segment_count;
@@ -53,14 +69,14 @@ struct TSegment_Solver_Setup {
 	scgms::IModel_Parameter_Vector** solution_hints; const size_t hint_count;
 	scgms::IModel_Parameter_Vector* solved_parameters;		//obtained result
 	solver::TSolver_Progress* progress;
+	TReference_Levels** reference_levels = nullptr;		//optional, one per segment, to keep the reference levels across the solver runs
 };
 
 struct TSegment_Info {
 	std::shared_ptr<scgms::ITime_Segment> segment;
 	std::shared_ptr<scgms::ISignal> calculated_signal;
 	std::shared_ptr<scgms::ISignal> reference_signal;
-	aligned_double_vector reference_time;
-	aligned_double_vector reference_level;
+	std::shared_ptr<TReference_Levels> reference;		//either the one given by the setup, or a private one
 };
 
 class CFitness {
@@ -37,6 +37,7 @@
 #include "mapping.h"
 
 #include <scgms/rtl/FilterLib.h>
+#include <scgms/rtl/FilterExtLib.h>
 #include <scgms/lang/dstrings.h>
 
 CMapping_Filter::CMapping_Filter(scgms::IFilter *output) : CBase_Filter(output) {
@@ -56,16 +57,35 @@ HRESULT IfaceCalling CMapping_Filter::Do_Configure(scgms::SFilter_Configuration
 	return S_OK;
 }
 
-HRESULT IfaceCalling CMapping_Filter::Do_Execute(scgms::UDevice_Event event) {
+HRESULT IfaceCalling CMapping_Filter::QueryInterface(const GUID*  riid, void ** ppvObj) {
+	if (Internal_Query_Interface<scgms::IFilter_Batch>(scgms::IID_Filter_Batch, *riid, ppvObj)) {
+		return S_OK;
+	}
+	return E_NOINTERFACE;
+}
+
+bool CMapping_Filter::Map(scgms::UDevice_Event& event) {
 	if (event.signal_id() == mSource_Id) {
 		if (mDestination_Null && (event.event_code() != scgms::NDevice_Event_Code::Shut_Down)) { // && !event.is_control_event() && !event.is_info_event()) {
-			event.reset(nullptr);
-			return S_OK;
+			return false;
 		}
 		else {
 			event.signal_id() = mDestination_Id;    //just changes the signal id
 		}
 	}
 
+	return true;
+}
+
+HRESULT IfaceCalling CMapping_Filter::Do_Execute(scgms::UDevice_Event event) {
+	if (!Map(event)) {
+		event.reset(nullptr);
+		return S_OK;
+	}
+
 	return mOutput.Send(event);
 }
+
+HRESULT IfaceCalling CMapping_Filter::Execute_Batch(scgms::IDevice_Event** begin, scgms::IDevice_Event** end) {
+	return scgms::Transform_And_Send_Batch(mOutput.get(), begin, end, [this](scgms::UDevice_Event& event) { return Map(event); });
+}
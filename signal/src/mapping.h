@@ -38,6 +38,7 @@
 
 #include <scgms/rtl/FilterLib.h>
 #include <scgms/rtl/referencedImpl.h>
+#include <scgms/iface/FilterExtIface.h>
 
 #pragma warning( push )
 #pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
@@ -45,7 +46,7 @@
 /*
  * Filter class for mapping input signal GUID to another
  */
-class CMapping_Filter : public virtual scgms::CBase_Filter {
+class CMapping_Filter : public virtual scgms::CBase_Filter, public virtual scgms::IFilter_Batch {
 	protected:
 		// source signal ID (what signal will be mapped)
 		GUID mSource_Id = Invalid_GUID;
@@ -54,11 +55,16 @@ class CMapping_Filter : public virtual scgms::CBase_Filter {
 		bool mDestination_Null = false;
 
 	protected:
+		bool Map(scgms::UDevice_Event& event);	//returns false, if the event has to be dropped
+
 		virtual HRESULT Do_Execute(scgms::UDevice_Event event) override final;
 		virtual HRESULT Do_Configure(scgms::SFilter_Configuration configuration, refcnt::Swstr_list& error_description) override final;
 	public:
 		CMapping_Filter(scgms::IFilter *output);
 		virtual ~CMapping_Filter() = default;
+
+		virtual HRESULT IfaceCalling QueryInterface(const GUID*  riid, void ** ppvObj) override;
+		virtual HRESULT IfaceCalling Execute_Batch(scgms::IDevice_Event** begin, scgms::IDevice_Event** end) override final;
 };
 
 #pragma warning( pop )
@@ -37,6 +37,7 @@
 #include "masking.h"
 
 #include <scgms/rtl/FilterLib.h>
+#include <scgms/rtl/FilterExtLib.h>
 #include <scgms/lang/dstrings.h>
 #include <scgms/utils/string_utils.h>
 
@@ -108,7 +109,14 @@ HRESULT IfaceCalling CMasking_Filter::Do_Configure(scgms::SFilter_Configuration
 	return S_OK;
 }
 
-HRESULT IfaceCalling CMasking_Filter::Do_Execute(scgms::UDevice_Event event) {
+HRESULT IfaceCalling CMasking_Filter::QueryInterface(const GUID*  riid, void ** ppvObj) {
+	if (Internal_Query_Interface<scgms::IFilter_Batch>(scgms::IID_Filter_Batch, *riid, ppvObj)) {
+		return S_OK;
+	}
+	return E_NOINTERFACE;
+}
+
+void CMasking_Filter::Mask(scgms::UDevice_Event& event) {
 
 	// mask only configured signal and event of type "Level"
 	if (event.event_code() == scgms::NDevice_Event_Code::Level && event.signal_id() == mSignal_Id) {
@@ -129,6 +137,16 @@ HRESULT IfaceCalling CMasking_Filter::Do_Execute(scgms::UDevice_Event event) {
 
 		mSegmentMaskState[event.segment_id()] = (mSegmentMaskState[event.segment_id()] + static_cast<uint64_t>(1)) % mBitCount;
 	}
+}
 
+HRESULT IfaceCalling CMasking_Filter::Do_Execute(scgms::UDevice_Event event) {
+	Mask(event);
 	return mOutput.Send(event);
 }
+
+HRESULT IfaceCalling CMasking_Filter::Execute_Batch(scgms::IDevice_Event** begin, scgms::IDevice_Event** end) {
+	return scgms::Transform_And_Send_Batch(mOutput.get(), begin, end, [this](scgms::UDevice_Event& event) {
+		Mask(event);
+		return true;
+	});
+}
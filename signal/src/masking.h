@@ -38,6 +38,7 @@
 
 #include <scgms/rtl/FilterLib.h>
 #include <scgms/rtl/referencedImpl.h>
+#include <scgms/iface/FilterExtIface.h>
 
 #include <bitset>
 
@@ -52,7 +53,7 @@ constexpr size_t BitmaskMaxBitCount = 64;
 /*
  * Filter class for masking input levels using configured bitmask
  */
-class CMasking_Filter : public virtual scgms::CBase_Filter {
+class CMasking_Filter : public virtual scgms::CBase_Filter, public virtual scgms::IFilter_Batch {
 	protected:
 		// masking is performed separatelly for each segment
 		std::map<uint64_t, uint8_t> mSegmentMaskState;
@@ -72,6 +73,9 @@ class CMasking_Filter : public virtual scgms::CBase_Filter {
 	public:
 		CMasking_Filter(scgms::IFilter *output);
 		virtual ~CMasking_Filter() = default;
+
+		virtual HRESULT IfaceCalling QueryInterface(const GUID*  riid, void ** ppvObj) override;
+		virtual HRESULT IfaceCalling Execute_Batch(scgms::IDevice_Event** begin, scgms::IDevice_Event** end) override final;
 };
 
 #pragma warning( pop )
@@ -463,9 +463,29 @@ HRESULT IfaceCalling CSignal_Generator::QueryInterface(const GUID* riid, void**
 	if (Internal_Query_Interface<scgms::IFilter_Feedback_Receiver>(scgms::IID_Filter_Feedback_Receiver, *riid, ppvObj)) {
 		return S_OK;
 	}
+	if (Internal_Query_Interface<scgms::IFilter_Checkpointable>(scgms::IID_Filter_Checkpointable, *riid, ppvObj)) {
+		return S_OK;
+	}
 	return E_NOINTERFACE;
 }
 
+HRESULT IfaceCalling CSignal_Generator::Save_Checkpoint(refcnt::str_container* checkpoint) {
+	//the asynchronous model runs on its own since the configuration, while the synchronized ones get the parameters once they are created
+	if (!mSync_To_Signal || !mSync_Models.empty() || (mCurrent_Segment_Idx > 0)) {
+		return S_FALSE;
+	}
+
+	return checkpoint ? scgms::CCheckpoint_Writer{}.Store(checkpoint) : S_OK;
+}
+
+HRESULT IfaceCalling CSignal_Generator::Restore_Checkpoint(refcnt::str_container* checkpoint) {
+	if (!mSync_To_Signal || !mSync_Models.empty()) {
+		return E_ILLEGAL_STATE_CHANGE;
+	}
+
+	return scgms::CCheckpoint_Reader{ checkpoint }.Finished() ? S_OK : E_INVALIDARG;
+}
+
 HRESULT IfaceCalling CSignal_Generator::Name(wchar_t** const name) {
 	if (mFeedback_Name.empty()) {
 		return E_INVALIDARG;
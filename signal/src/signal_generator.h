@@ -38,6 +38,7 @@
 
 #include <scgms/rtl/FilterLib.h>
 #include <scgms/rtl/referencedImpl.h>
+#include <scgms/rtl/FilterExtLib.h>
 
 #include <memory>
 #include <thread>
@@ -76,7 +77,7 @@ namespace signal_generator_internal {
 /*
  * Filter class for generating signals using a specific model 
  */
-class CSignal_Generator : public scgms::CBase_Filter, public scgms::IFilter_Feedback_Receiver {
+class CSignal_Generator : public scgms::CBase_Filter, public scgms::IFilter_Feedback_Receiver, public scgms::IFilter_Checkpointable {
 	protected:
 		bool mSync_To_Signal = false;	
 		double mFixed_Stepping = 5.0*scgms::One_Minute;
@@ -113,6 +114,10 @@ class CSignal_Generator : public scgms::CBase_Filter, public scgms::IFilter_Feed
 
 		virtual HRESULT IfaceCalling Name(wchar_t** const name) override final;
 		virtual HRESULT IfaceCalling QueryInterface(const GUID* riid, void** ppvObj) override;
+
+		//the generator's state depends on the parameters since it instantiates the first model
+		virtual HRESULT IfaceCalling Save_Checkpoint(refcnt::str_container* checkpoint) override final;
+		virtual HRESULT IfaceCalling Restore_Checkpoint(refcnt::str_container* checkpoint) override final;
 };
 
 #pragma warning( pop )
@@ -38,11 +38,18 @@
 
 #include "time_segment.h"
 #include "descriptor.h"
+#include "fitness.h"
 
+#include <scgms/rtl/ApproxExtLib.h>
+
+#include <algorithm>
 #include <cmath>
 
-CTime_Segment::CTime_Segment(const int64_t segment_id, const GUID &calculated_signal_id, scgms::SModel_Parameter_Vector &working_parameters, const double prediction_window, scgms::SFilter output)
-	: mOutput(output), mCalculated_Signal_Id(calculated_signal_id), mSegment_id(segment_id), mPrediction_Window(prediction_window) {
+CTime_Segment::CTime_Segment(const int64_t segment_id, const GUID &calculated_signal_id, scgms::SModel_Parameter_Vector &working_parameters, const double prediction_window, const double emitted_retention, const double signal_retention, scgms::SFilter output)
+	: mOutput(output), mCalculated_Signal_Id(calculated_signal_id), mSegment_id(segment_id), mPrediction_Window(prediction_window),
+	  mEmitted_Retention(std::max(emitted_retention, std::fabs(prediction_window))),	//the reference levels request the times one prediction window before the latest one
+	  mSignal_Retention(signal_retention),
+	  mReference_Levels(std::make_shared<TReference_Levels>()) {
 
 	Clear_Data();
 
@@ -77,6 +84,11 @@ scgms::SSignal CTime_Segment::Get_Signal_Internal(const GUID &signal_id) {
 			return scgms::SSignal{};
 		}
 
+		//the calculated signal keeps no levels, so it ignores the retention anyway
+		if ((mSignal_Retention > 0.0) && (signal_id != mCalculated_Signal_Id)) {
+			scgms::Set_Signal_Retention(new_signal.get(), mSignal_Retention);
+		}
+
 		mSignals[signal_id] = new_signal;
 		return new_signal;
 	}
@@ -100,8 +112,8 @@ bool CTime_Segment::Update_Level(const GUID &signal_id, const double level, cons
 		if (signal->Update_Levels(&time_stamp, &level, 1) == S_OK) {
 
 			auto insert_the_time = [this](const double time_to_insert) {
-				if (mEmitted_Times.find(time_to_insert) == mEmitted_Times.end()) {
-					mPending_Times.insert(time_to_insert);
+				if (!Is_Emitted(time_to_insert)) {
+					Insert_Pending_Time(time_to_insert);
 				}
 			};
 
@@ -123,6 +135,61 @@ bool CTime_Segment::Update_Level(const GUID &signal_id, const double level, cons
 	}
 }
 
+void CTime_Segment::Insert_Pending_Time(const double time) {
+	//the levels come mostly in order, so the right place is usually the end
+	if (mPending_Times.empty() || (mPending_Times.back() < time)) {
+		mPending_Times.push_back(time);
+		Forget_Stale_Pending_Times();
+		return;
+	}
+
+	const auto iter = std::lower_bound(mPending_Times.begin(), mPending_Times.end(), time);
+	if ((iter == mPending_Times.end()) || (*iter != time)) {
+		mPending_Times.insert(iter, time);
+	}
+}
+
+void CTime_Segment::Forget_Stale_Pending_Times() {
+	//e.g.; the levels before the first one the model can calculate would stay pending forever
+	//and the times behind the emitted watermark would be considered emitted already anyway
+	if (!mPending_Times.empty()) {
+		const double watermark = std::max(mEmitted_Watermark, mPending_Times.back() - mEmitted_Retention);
+		while (!mPending_Times.empty() && (mPending_Times.front() < watermark)) {
+			mPending_Times.pop_front();
+		}
+	}
+}
+
+void CTime_Segment::Insert_Emitted_Time(const double time) {
+	if (mEmitted_Times.empty() || (mEmitted_Times.back() < time)) {
+		mEmitted_Times.push_back(time);
+
+		//move the watermark and forget everything before it
+		mEmitted_Watermark = std::max(mEmitted_Watermark, time - mEmitted_Retention);
+		while (!mEmitted_Times.empty() && (mEmitted_Times.front() < mEmitted_Watermark)) {
+			mEmitted_Times.pop_front();
+		}
+		return;
+	}
+
+	const auto iter = std::lower_bound(mEmitted_Times.begin(), mEmitted_Times.end(), time);
+	if ((iter == mEmitted_Times.end()) || (*iter != time)) {
+		mEmitted_Times.insert(iter, time);
+	}
+}
+
+bool CTime_Segment::Is_Emitted(const double time) const {
+	if (time < mEmitted_Watermark) {
+		return true;
+	}
+
+	if (mEmitted_Times.empty() || (mEmitted_Times.back() < time)) {
+		return false;	//the most frequent case, a new time ahead of everything emitted
+	}
+
+	return std::binary_search(mEmitted_Times.begin(), mEmitted_Times.end(), time);
+}
+
 bool CTime_Segment::Set_Parameters(scgms::SModel_Parameter_Vector parameters) {
 	return mWorking_Parameters.set(parameters);	//make a deep copy to ensure that the shared object will not be gone unexpectedly
 }
@@ -133,6 +200,7 @@ scgms::SModel_Parameter_Vector CTime_Segment::Get_Parameters() {
 
 bool CTime_Segment::Calculate(const std::vector<double> &times, std::vector<double> &levels) {
 	if (mCalculated_Signal) {
+		mParameters_Used = true;
 		levels.resize(times.size());
 		return mCalculated_Signal->Get_Continuous_Levels(mWorking_Parameters.get(), times.data(), levels.data(), levels.size(), scgms::apxNo_Derivation) == S_OK;
 	} 
@@ -145,11 +213,13 @@ void CTime_Segment::Emit_Levels_At_Pending_Times() {
 		return;
 	}
 
-	std::vector<double> levels(mPending_Times.size()), times{ mPending_Times.begin(), mPending_Times.end() };
+	std::vector<double> levels(mPending_Times.size()), times{ mPending_Times.begin(), mPending_Times.end() };	//already sorted
 	if (levels.size() != times.size()) {
 		return;	//allocation error!
 	}
 
+	mParameters_Used = true;	//even NaNs may depend on the parameters, e.g.; on a time lag
+
 	//auto params_ptr = mWorking_Parameters.operator bool() ? mWorking_Parameters.get() : nullptr;	- mWorking params are always initialized => the same effect as nullptr
 	if (mCalculated_Signal->Get_Continuous_Levels(mWorking_Parameters.get(), times.data(), levels.data(), levels.size(), scgms::apxNo_Derivation) == S_OK) {
 		mPending_Times.clear();
@@ -166,13 +236,15 @@ void CTime_Segment::Emit_Levels_At_Pending_Times() {
 				scgms::IDevice_Event *raw_calcEvt = calcEvt.get();
 				calcEvt.release();
 				if (mOutput->Execute(raw_calcEvt) == S_OK) {
-					mEmitted_Times.insert(times[i]);
+					Insert_Emitted_Time(times[i]);
 				}
 			}
 			else {
-				mPending_Times.insert(times[i]);
+				mPending_Times.push_back(times[i]);	//the times are sorted, so they stay sorted
 			}
 		}
+
+		Forget_Stale_Pending_Times();
 	}
 }
 
@@ -180,6 +252,83 @@ void CTime_Segment::Clear_Data() {
 	mSignals.clear();
 	mPending_Times.clear();
 	mEmitted_Times.clear();
+	mEmitted_Watermark = -std::numeric_limits<double>::infinity();
 	mLast_Pending_time = std::numeric_limits<double>::quiet_NaN();
+	mReference_Levels = std::make_shared<TReference_Levels>();	//a fresh one, as a snapshot being solved may still share the former one
 	mCalculated_Signal = Get_Signal_Internal(mCalculated_Signal_Id);	//creates the calculated signal
 }
+
+std::unique_ptr<CTime_Segment> CTime_Segment::Snapshot() {
+	auto snapshot = std::make_unique<CTime_Segment>(mSegment_id, mCalculated_Signal_Id, mWorking_Parameters, mPrediction_Window, mEmitted_Retention, mSignal_Retention, scgms::SFilter{});
+	snapshot->mReference_Levels = mReference_Levels;	//the snapshot has the same levels, and we do not solve while it is being solved
+
+	for (auto &signal : mSignals) {
+		if (signal.first == mCalculated_Signal_Id) {
+			continue;	//it is not a measured one, so it holds no levels; the snapshot has its own one
+		}
+
+		auto snapshot_signal = snapshot->Get_Signal_Internal(signal.first);
+		bool copied = static_cast<bool>(snapshot_signal);
+		if (copied) {
+			scgms::For_Each_Discrete_Span(signal.second.get(), [&snapshot_signal, &copied](const double* times, const double* levels, const size_t count) {
+				copied &= snapshot_signal->Update_Levels(times, levels, count) == S_OK;
+			});
+		}
+
+		if (!copied) {
+			return nullptr;
+		}
+	}
+
+	return snapshot;
+}
+
+bool CTime_Segment::Save_Checkpoint(scgms::CCheckpoint_Writer &writer) {
+	if (mParameters_Used) {
+		return false;
+	}
+
+	writer.Write(static_cast<uint64_t>(mSignals.size() - (mSignals.count(mCalculated_Signal_Id) > 0 ? 1 : 0)));
+	for (auto &signal : mSignals) {
+		if (signal.first != mCalculated_Signal_Id) {	//it is not a measured one, so it holds no levels
+			writer.Write(signal.first);
+			if (!writer.Write(signal.second.get())) {
+				return false;
+			}
+		}
+	}
+
+	writer.Write(std::vector<double>{ mPending_Times.begin(), mPending_Times.end() });
+	writer.Write(mLast_Pending_time);
+
+	return true;	//no emitted times as we have not calculated anything yet
+}
+
+bool CTime_Segment::Restore_Checkpoint(scgms::CCheckpoint_Reader &reader) {
+	uint64_t signal_count = 0;
+	if (!reader.Read(signal_count)) {
+		return false;
+	}
+
+	for (uint64_t i = 0; i < signal_count; i++) {
+		GUID signal_id = Invalid_GUID;
+		if (!reader.Read(signal_id)) {
+			return false;
+		}
+
+		auto signal = Get_Signal_Internal(signal_id);
+		if (!signal || !reader.Read(signal.get())) {
+			return false;
+		}
+	}
+
+	std::vector<double> pending_times;
+	if (!reader.Read(pending_times) || !reader.Read(mLast_Pending_time)) {
+		return false;
+	}
+	for (const double time : pending_times) {
+		Insert_Pending_Time(time);
+	}
+
+	return true;
+}
@@ -38,9 +38,13 @@
 
 #include <scgms/rtl/FilterLib.h>
 #include <scgms/rtl/DeviceLib.h>
+#include <scgms/rtl/FilterExtLib.h>
 
+#include <deque>
 #include <map>
-#include <set>
+#include <memory>
+
+struct TReference_Levels;
 
 #pragma warning( push )
 #pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
@@ -58,12 +62,22 @@ class CTime_Segment : public scgms::ITime_Segment, public virtual refcnt::CNotRe
 
 		double mPrediction_Window;
 		double mLast_Pending_time = std::numeric_limits<double>::quiet_NaN();	//it is faster to query it rather than to query the vector correctly
-		std::set<double> mPending_Times;
-		std::set<double> mEmitted_Times;	//to avoid duplicities in the output
+		//both are kept sorted; the times mostly arrive in order, so that inserting from the back is amortized O(1)
+		std::deque<double> mPending_Times;
+		std::deque<double> mEmitted_Times;	//to avoid duplicities in the output
+		const double mEmitted_Retention;	//how far back from the latest emitted, or pending, time we keep the emitted, or pending, times
+		const double mSignal_Retention;		//how far back the input signals keep their levels, zero keeps them all
+		double mEmitted_Watermark = -std::numeric_limits<double>::infinity();	//anything before is considered emitted already
+		void Insert_Pending_Time(const double time);
+		void Forget_Stale_Pending_Times();	//those, which the signal could not calculate for longer than the retention
+		void Insert_Emitted_Time(const double time);
+		bool Is_Emitted(const double time) const;
 		scgms::SModel_Parameter_Vector mWorking_Parameters;
+		bool mParameters_Used = false;	//whether anything has been calculated with the working parameters yet
+		std::shared_ptr<TReference_Levels> mReference_Levels;	//kept for the solver, shared with the snapshots
 
 	public:
-		CTime_Segment(const int64_t segment_id, const GUID &calculated_signal_id, scgms::SModel_Parameter_Vector &working_parameters, const double prediction_window, scgms::SFilter output);
+		CTime_Segment(const int64_t segment_id, const GUID &calculated_signal_id, scgms::SModel_Parameter_Vector &working_parameters, const double prediction_window, const double emitted_retention, const double signal_retention, scgms::SFilter output);
 		virtual ~CTime_Segment() = default;
 
 		virtual HRESULT IfaceCalling Get_Signal(const GUID *signal_id, scgms::ISignal **signal) override;
@@ -74,6 +88,12 @@ class CTime_Segment : public scgms::ITime_Segment, public virtual refcnt::CNotRe
 		bool Calculate(const std::vector<double> &times, std::vector<double> &levels);		//calculates using the working parameters
 		void Emit_Levels_At_Pending_Times();
 		void Clear_Data();
+		std::unique_ptr<CTime_Segment> Snapshot();	//copies the measured levels and the working parameters, but emits nothing
+
+		bool Parameters_Used() const { return mParameters_Used; };
+		TReference_Levels* Reference_Levels() { return mReference_Levels.get(); }
+		bool Save_Checkpoint(scgms::CCheckpoint_Writer &writer);
+		bool Restore_Checkpoint(scgms::CCheckpoint_Reader &reader);
 };
 
 #pragma warning( pop )
@@ -0,0 +1,136 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "tests.h"
+
+#include "chunked_series.h"
+
+#include <vector>
+
+namespace {
+	//all the levels through the spans, checking that they cover the series in the time order
+	std::vector<double> Span_Times(const CChunked_Series &series) {
+		std::vector<double> times;
+		for (const auto &span : series.Spans()) {
+			times.insert(times.end(), span.times, span.times + span.count);
+		}
+
+		for (size_t i = 1; i < times.size(); i++) {
+			if (!(times[i - 1] < times[i])) {
+				throw CTest_Failure{ "the spans are not ordered by the time" };
+			}
+		}
+
+		return times;
+	}
+}
+
+DTest_Case(chunked_series, appends_across_the_chunks) {
+	CChunked_Series series;
+	const size_t count = 3 * CChunked_Series::Chunk_Capacity + 7;
+	for (size_t i = 0; i < count; i++) {
+		series.Update(static_cast<double>(i), 2.0 * i);
+	}
+
+	DCheck(series.Size() == count);
+	DCheck(series.Front_Time() == 0.0);
+	DCheck(series.Back_Time() == static_cast<double>(count - 1));
+	DCheck(series.Revision() == 0);	//appending keeps the levels already read
+	DCheck(series.Spans().size() == 4);
+	DCheck(Span_Times(series).size() == count);
+
+	std::vector<double> times(count), levels(count);
+	DCheck(series.Copy(times.data(), levels.data(), count) == count);
+	DCheck(levels[count - 1] == 2.0 * (count - 1));
+
+	double min = 0.0, max = 0.0;
+	series.Level_Bounds(min, max);
+	DCheck(min == 0.0);
+	DCheck(max == 2.0 * (count - 1));
+}
+
+DTest_Case(chunked_series, updates_and_inserts_change_the_revision) {
+	CChunked_Series series;
+	for (size_t i = 0; i < CChunked_Series::Chunk_Capacity; i++) {
+		series.Update(static_cast<double>(2 * i), 1.0);	//the even times fill a whole chunk
+	}
+
+	series.Update(10.0, 5.0);	//an already present time
+	DCheck(series.Revision() == 1);
+	DCheck(series.Size() == CChunked_Series::Chunk_Capacity);
+
+	series.Update(11.0, 6.0);	//inserted into the full chunk, which splits
+	DCheck(series.Revision() == 2);
+	DCheck(series.Size() == CChunked_Series::Chunk_Capacity + 1);
+	DCheck(series.Spans().size() == 2);
+
+	const std::vector<double> times = Span_Times(series);
+	DCheck(times.size() == series.Size());
+
+	std::vector<double> copied_times(series.Size()), levels(series.Size());
+	series.Copy(copied_times.data(), levels.data(), series.Size());
+	DCheck(copied_times == times);
+	DCheck(levels[5] == 5.0);
+	DCheck(levels[6] == 6.0);
+}
+
+DTest_Case(chunked_series, retention_bounds_the_memory) {
+	CChunked_Series series;
+	const double retention = 100.0;
+	series.Set_Retention(retention);
+
+	const size_t count = 20 * CChunked_Series::Chunk_Capacity;
+	uint64_t last_revision = series.Revision();
+	bool dropped = false;
+	for (size_t i = 0; i < count; i++) {
+		series.Update(static_cast<double>(i), 1.0);
+
+		//the retained levels cover the retention, yet the older chunks are gone
+		DCheck(series.Front_Time() <= series.Back_Time() - retention || series.Front_Time() == 0.0);
+		DCheck(series.Size() <= 2 * CChunked_Series::Chunk_Capacity + static_cast<size_t>(retention));
+		DCheck(Span_Times(series).size() == series.Size());
+
+		//dropping the levels changes the revision, so that the readers know their copies are not just extended
+		if (series.Revision() != last_revision) {
+			dropped = true;
+			last_revision = series.Revision();
+		}
+	}
+
+	DCheck(dropped);
+	DCheck(series.Size() < count);
+}
@@ -0,0 +1,143 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "tests.h"
+
+#include "expression/expression.h"
+
+#include <scgms/rtl/DeviceLib.h>
+#include <scgms/rtl/rattime.h>
+
+#include <vector>
+
+using namespace expression;
+
+namespace {
+	scgms::UDevice_Event Level_Event(const double level, const uint64_t segment_id, const double device_time) {
+		scgms::UDevice_Event event{ scgms::NDevice_Event_Code::Level };
+		event.level() = level;
+		event.segment_id() = segment_id;
+		event.device_time() = device_time;
+		return event;
+	}
+
+	//the program's results for the events, evaluated as a single batch
+	std::vector<uint8_t> Evaluate_Batch(CProgram &program, const std::vector<scgms::UDevice_Event> &events) {
+		std::vector<uint8_t> results(events.size(), 2);
+		program.Evaluate(events.data(), events.size(), results.data());
+		return results;
+	}
+}
+
+DTest_Case(expression, batch_matches_single_events) {
+	//level > 5 && !(level == 7)
+	CAND condition{ new CGT{ new CVariable_level{}, new CDouble{ "5" } }, new CNot{ new CEQ{ new CVariable_level{}, new CDouble{ "7.0" } } } };
+	CProgram program{ condition };
+	DCheck(program);
+
+	//more events than a single block of lanes, so that the last block is a partial one
+	std::vector<scgms::UDevice_Event> events;
+	for (size_t i = 0; i < 150; i++) {
+		events.push_back(Level_Event(static_cast<double>(i % 10), 1, 0.0));
+	}
+
+	const std::vector<uint8_t> results = Evaluate_Batch(program, events);
+	for (size_t i = 0; i < events.size(); i++) {
+		const double level = static_cast<double>(i % 10);
+		const bool expected = (level > 5.0) && (level != 7.0);
+		DCheck(results[i] == (expected ? 1 : 0));
+		DCheck(program.Evaluate(events[i]) == expected);
+	}
+}
+
+DTest_Case(expression, folds_the_constants) {
+	//(1 + 2 == 3.0) || level < 0, which is always true
+	COR condition{ new CEQ{ new CPlus{ new CDouble{ "1" }, new CDouble{ "2" } }, new CDouble{ "3.0" } }, new CLT{ new CVariable_level{}, new CDouble{ "0" } } };
+	CProgram program{ condition };
+	DCheck(program);
+
+	std::vector<scgms::UDevice_Event> events;
+	events.push_back(Level_Event(10.0, 1, 0.0));
+	events.push_back(Level_Event(-10.0, 1, 0.0));
+	DCheck((Evaluate_Batch(program, events) == std::vector<uint8_t>{ 1, 1 }));
+}
+
+DTest_Case(expression, compares_segment_id_exactly) {
+	//All_Segments_Id is not exact as a double, yet it has to be told from its predecessor
+	CEQ condition{ new CVariable_segment_id{}, new CDouble{ "18446744073709551615" } };
+	CProgram program{ condition };
+	DCheck(program);
+
+	std::vector<scgms::UDevice_Event> events;
+	events.push_back(Level_Event(1.0, scgms::All_Segments_Id, 0.0));
+	events.push_back(Level_Event(1.0, scgms::All_Segments_Id - 1, 0.0));
+	DCheck((Evaluate_Batch(program, events) == std::vector<uint8_t>{ 1, 0 }));
+
+	CGTEQ range{ new CVariable_segment_id{}, new CDouble{ "3" } };
+	CProgram range_program{ range };
+	DCheck(range_program);
+	DCheck(!range_program.Evaluate(Level_Event(1.0, 2, 0.0)));
+	DCheck(range_program.Evaluate(Level_Event(1.0, 3, 0.0)));
+}
+
+DTest_Case(expression, rejects_segment_id_as_a_number) {
+	CLT fraction{ new CVariable_segment_id{}, new CDouble{ "2.5" } };
+	DCheck(!CProgram{ fraction });
+
+	CEQ arithmetic{ new CPlus{ new CVariable_segment_id{}, new CDouble{ "1" } }, new CDouble{ "3" } };
+	DCheck(!CProgram{ arithmetic });
+
+	CGT variable{ new CVariable_segment_id{}, new CVariable_level{} };
+	DCheck(!CProgram{ variable });
+}
+
+DTest_Case(expression, time_of_day_is_utc_hours) {
+	//time_of_day < 12 && device_time > 1
+	CAND condition{ new CLT{ new CVariable_time_of_day{}, new CDouble{ "12" } }, new CGT{ new CVariable_device_time{}, new CDouble{ "1" } } };
+	CProgram program{ condition };
+	DCheck(program);
+
+	const double day = 45000.0;	//a whole number of days is the midnight UTC
+	std::vector<scgms::UDevice_Event> events;
+	events.push_back(Level_Event(1.0, 1, day + 6.0 * scgms::One_Hour));
+	events.push_back(Level_Event(1.0, 1, day + 18.0 * scgms::One_Hour));
+	events.push_back(Level_Event(1.0, 1, 0.25));
+	DCheck((Evaluate_Batch(program, events) == std::vector<uint8_t>{ 1, 0, 0 }));
+
+	DCheck(Time_Of_Day(day + 6.5 * scgms::One_Hour) > 6.49);
+	DCheck(Time_Of_Day(day + 6.5 * scgms::One_Hour) < 6.51);
+}
@@ -0,0 +1,125 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#pragma once
+
+#include "tests.h"
+#include "device_event.h"
+
+#include <scgms/rtl/FilterLib.h>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#pragma warning( push )
+#pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
+
+//what a test filter has seen of an event, which it has released already
+struct TSeen_Event {
+	scgms::NDevice_Event_Code code;
+	double device_time;
+	uint64_t segment_id;
+	int64_t logical_time;
+	std::thread::id thread;
+};
+
+inline TSeen_Event See_Event(scgms::IDevice_Event *event) {
+	scgms::TDevice_Event *raw;
+	if (event->Raw(&raw) != S_OK) {
+		throw CTest_Failure{ "event without its raw data" };
+	}
+
+	return TSeen_Event{ raw->event_code, raw->device_time, raw->segment_id, raw->logical_time, std::this_thread::get_id() };
+}
+
+//a level event from the pool of the tested library units, numbered by its device time
+inline scgms::IDevice_Event* Make_Level_Event(const double device_time, const uint64_t segment_id = 1) {
+	scgms::IDevice_Event *event = allocate_device_event(scgms::NDevice_Event_Code::Level);
+	scgms::TDevice_Event *raw;
+	if (!event || (event->Raw(&raw) != S_OK)) {
+		throw CTest_Failure{ "cannot allocate an event" };
+	}
+
+	raw->device_time = device_time;
+	raw->segment_id = segment_id;
+	raw->level = device_time;
+	return event;
+}
+
+//the last filter of a tested chain, which records and releases the events it receives, possibly from more threads
+class CRecording_Filter : public virtual scgms::IFilter, public virtual refcnt::CNotReferenced {
+	protected:
+		mutable std::mutex mGuard;
+		std::vector<TSeen_Event> mSeen;
+
+	public:
+		virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) override final {
+			return S_OK;
+		}
+
+		virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final {
+			if (!event) {
+				return E_INVALIDARG;
+			}
+
+			const TSeen_Event seen = See_Event(event);
+			event->Release();
+
+			std::lock_guard<std::mutex> guard{ mGuard };
+			mSeen.push_back(seen);
+			return S_OK;
+		}
+
+		std::vector<TSeen_Event> Seen() const {
+			std::lock_guard<std::mutex> guard{ mGuard };
+			return mSeen;
+		}
+
+		size_t Count(const scgms::NDevice_Event_Code code) const {
+			std::lock_guard<std::mutex> guard{ mGuard };
+			size_t count = 0;
+			for (const auto &seen : mSeen) {
+				if (seen.code == code) {
+					count++;
+				}
+			}
+			return count;
+		}
+};
+
+#pragma warning( pop )
@@ -0,0 +1,161 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "tests.h"
+
+#include "fitness_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+	constexpr size_t Problem_Size = 2;
+
+	//sums the solution, while recording what it has evaluated; fails for solutions starting with a negative number
+	struct TCounting_Objective {
+		std::vector<std::vector<double>> evaluated;
+
+		static BOOL IfaceCalling Evaluate(const void* data, const size_t solution_count, const double* solutions, double* const fitnesses) {
+			TCounting_Objective *objective = reinterpret_cast<TCounting_Objective*>(const_cast<void*>(data));
+
+			BOOL result = TRUE;
+			for (size_t i = 0; i < solution_count; i++) {
+				const double* solution = solutions + i * Problem_Size;
+				objective->evaluated.push_back(std::vector<double>(solution, solution + Problem_Size));
+				fitnesses[i * solver::Maximum_Objectives_Count] = solution[0] + solution[1];
+				if (solution[0] < 0.0) {
+					result = FALSE;
+				}
+			}
+
+			return result;
+		}
+	};
+
+	//the solver's setup for the objective, which the cache wraps
+	struct TCounting_Problem {
+		TCounting_Objective objective;
+		std::vector<double> lower_bound, upper_bound, solution;
+		solver::TSolver_Setup setup;
+
+		TCounting_Problem() : lower_bound(Problem_Size, -10.0), upper_bound(Problem_Size, 10.0), solution(Problem_Size),
+			setup{
+				Problem_Size, 1,
+				lower_bound.data(), upper_bound.data(),
+				nullptr, 0,
+				solution.data(),
+
+				&objective, TCounting_Objective::Evaluate, nullptr,
+				solver::Default_Solver_Setup.max_generations,
+				solver::Default_Solver_Setup.population_size,
+				solver::Default_Solver_Setup.tolerance,
+			} {
+		}
+	};
+
+	TFitness_Cache_Statistics Statistics() {
+		TFitness_Cache_Statistics statistics{};
+		if (get_fitness_cache_statistics(&statistics) != S_OK) {
+			throw CTest_Failure{ "no fitness cache statistics" };
+		}
+		return statistics;
+	}
+
+	double Fitness_Of(const std::vector<double> &fitnesses, const size_t solution) {
+		return fitnesses[solution * solver::Maximum_Objectives_Count];
+	}
+}
+
+DTest_Case(fitness_cache, evaluates_each_solution_once) {
+	TCounting_Problem problem;
+	TCounting_Objective &objective = problem.objective;
+
+	CFitness_Cache cache{ problem.setup };
+	const solver::TSolver_Setup cached_setup = cache.Cached_Setup();
+	const TFitness_Cache_Statistics before = Statistics();
+
+	//the first and the third solutions are the same
+	const std::vector<double> first_batch{ 1.0, 2.0,  3.0, 4.0,  1.0, 2.0 };
+	std::vector<double> fitnesses(3 * solver::Maximum_Objectives_Count);
+	DCheck(cached_setup.objective(cached_setup.data, 3, first_batch.data(), fitnesses.data()) == TRUE);
+	DCheck(objective.evaluated.size() == 3);	//nothing is cached before the batch is evaluated
+	DCheck(Fitness_Of(fitnesses, 0) == 3.0);
+	DCheck(Fitness_Of(fitnesses, 1) == 7.0);
+	DCheck(Fitness_Of(fitnesses, 2) == 3.0);
+
+	//just the new solution goes to the objective
+	const std::vector<double> second_batch{ 3.0, 4.0,  5.0, 6.0 };
+	std::fill(fitnesses.begin(), fitnesses.end(), 0.0);
+	DCheck(cached_setup.objective(cached_setup.data, 2, second_batch.data(), fitnesses.data()) == TRUE);
+	DCheck(objective.evaluated.size() == 4);
+	DCheck((objective.evaluated.back() == std::vector<double>{ 5.0, 6.0 }));
+	DCheck(Fitness_Of(fitnesses, 0) == 7.0);
+	DCheck(Fitness_Of(fitnesses, 1) == 11.0);
+
+	const TFitness_Cache_Statistics after = Statistics();
+	DCheck(after.hits - before.hits == 1);
+	DCheck(after.misses - before.misses == 4);
+}
+
+DTest_Case(fitness_cache, compares_the_solutions_bitwise) {
+	TCounting_Problem problem;
+	TCounting_Objective &objective = problem.objective;
+
+	CFitness_Cache cache{ problem.setup };
+	const solver::TSolver_Setup cached_setup = cache.Cached_Setup();
+
+	//0.0 and -0.0 are equal numbers, but different solutions to the cache
+	const std::vector<double> positive_zero{ 0.0, 1.0 }, negative_zero{ -0.0, 1.0 };
+	std::vector<double> fitnesses(solver::Maximum_Objectives_Count);
+	DCheck(cached_setup.objective(cached_setup.data, 1, positive_zero.data(), fitnesses.data()) == TRUE);
+	DCheck(cached_setup.objective(cached_setup.data, 1, negative_zero.data(), fitnesses.data()) == TRUE);
+	DCheck(objective.evaluated.size() == 2);
+}
+
+DTest_Case(fitness_cache, failed_evaluations_are_not_cached) {
+	TCounting_Problem problem;
+	TCounting_Objective &objective = problem.objective;
+
+	CFitness_Cache cache{ problem.setup };
+	const solver::TSolver_Setup cached_setup = cache.Cached_Setup();
+
+	const std::vector<double> failing{ -1.0, 1.0 };
+	std::vector<double> fitnesses(solver::Maximum_Objectives_Count);
+	DCheck(cached_setup.objective(cached_setup.data, 1, failing.data(), fitnesses.data()) == FALSE);
+	DCheck(cached_setup.objective(cached_setup.data, 1, failing.data(), fitnesses.data()) == FALSE);
+	DCheck(objective.evaluated.size() == 2);	//evaluated again, as the first evaluation has failed
+}
@@ -0,0 +1,135 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "tests.h"
+#include "test_filters.h"
+
+#include "pipeline.h"
+
+#include <thread>
+
+namespace {
+	constexpr size_t Event_Count = 10000;
+}
+
+DTest_Case(pipeline, ring_keeps_the_order_when_full) {
+	CSPSC_Event_Ring ring{ 4 };	//much smaller than the event count, so that the producer waits for the consumer
+
+	std::thread producer{ [&ring]() {
+		for (size_t i = 0; i < Event_Count; i++) {
+			ring.Push(Make_Level_Event(static_cast<double>(i)));
+		}
+		ring.Push(nullptr);
+	} };
+
+	size_t popped = 0;
+	bool ordered = true;
+	while (scgms::IDevice_Event *event = ring.Pop()) {
+		ordered &= See_Event(event).device_time == static_cast<double>(popped);
+		event->Release();
+		popped++;
+	}
+	producer.join();
+
+	DCheck(ordered);
+	DCheck(popped == Event_Count);
+}
+
+DTest_Case(pipeline, stage_passes_through_until_started) {
+	CRecording_Filter recorder;
+	CPipeline_Stage stage{ &recorder, 16 };
+
+	DCheck(stage.Execute(Make_Level_Event(1.0)) == S_OK);
+
+	const auto seen = recorder.Seen();
+	DCheck(seen.size() == 1);	//delivered before Execute has returned
+	DCheck(seen[0].thread == std::this_thread::get_id());
+}
+
+DTest_Case(pipeline, started_stage_delivers_all_in_order_on_its_worker) {
+	CRecording_Filter recorder;
+	CPipeline_Stage stage{ &recorder, 8 };
+
+	stage.Start();
+	for (size_t i = 0; i < Event_Count; i++) {
+		DCheck(stage.Execute(Make_Level_Event(static_cast<double>(i))) == S_OK);
+	}
+	stage.Stop();	//delivers all the queued events
+
+	const auto seen = recorder.Seen();
+	DCheck(seen.size() == Event_Count);
+	for (size_t i = 0; i < seen.size(); i++) {
+		DCheck(seen[i].device_time == static_cast<double>(i));
+		DCheck(seen[i].thread != std::this_thread::get_id());
+	}
+
+	//stopped, it passes the events through again
+	DCheck(stage.Execute(Make_Level_Event(-1.0)) == S_OK);
+	DCheck(recorder.Seen().size() == Event_Count + 1);
+	DCheck(recorder.Seen().back().thread == std::this_thread::get_id());
+}
+
+DTest_Case(pipeline, stage_serializes_concurrent_producers) {
+	CRecording_Filter recorder;
+	CPipeline_Stage stage{ &recorder, 8 };
+	stage.Start();
+
+	constexpr size_t Producer_Count = 4;
+	std::vector<std::thread> producers;
+	for (size_t p = 0; p < Producer_Count; p++) {
+		producers.emplace_back([&stage, p]() {
+			for (size_t i = 0; i < Event_Count; i++) {
+				stage.Execute(Make_Level_Event(static_cast<double>(i), p));
+			}
+		});
+	}
+	for (auto &producer : producers) {
+		producer.join();
+	}
+	stage.Stop();
+
+	//each producer's events keep their order, and none is lost
+	std::vector<size_t> next(Producer_Count, 0);
+	for (const auto &seen : recorder.Seen()) {
+		DCheck(seen.segment_id < Producer_Count);
+		DCheck(seen.device_time == static_cast<double>(next[seen.segment_id]));
+		next[seen.segment_id]++;
+	}
+	for (const size_t count : next) {
+		DCheck(count == Event_Count);
+	}
+}
@@ -0,0 +1,155 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "tests.h"
+#include "test_filters.h"
+
+#include "replay_buffer.h"
+
+namespace {
+	constexpr GUID Test_Device_Id = { 0x5c0f7a12, 0x3e4d, 0x4b9a, { 0x8f, 0x21, 0x6a, 0x90, 0x1d, 0x3b, 0x7e, 0x44 } };
+	constexpr GUID Test_Signal_Id = { 0x2d8b6e03, 0x91a7, 0x4c52, { 0xb3, 0x0e, 0x45, 0x7f, 0xc2, 0x19, 0x88, 0x6d } };
+
+	scgms::TDevice_Event Level_Raw(const double device_time, const double level) {
+		scgms::TDevice_Event raw{};
+		raw.event_code = scgms::NDevice_Event_Code::Level;
+		raw.device_id = Test_Device_Id;
+		raw.signal_id = Test_Signal_Id;
+		raw.device_time = device_time;
+		raw.logical_time = 1;
+		raw.segment_id = 7;
+		raw.level = level;
+		return raw;
+	}
+
+	std::vector<double> Parameters_Of(scgms::IDevice_Event *event) {
+		scgms::TDevice_Event *raw;
+		double *begin = nullptr, *end = nullptr;
+		if ((event->Raw(&raw) != S_OK) || !raw->parameters || (raw->parameters->get(&begin, &end) != S_OK)) {
+			return {};
+		}
+
+		return std::vector<double>(begin, end);
+	}
+}
+
+DTest_Case(replay, materializes_the_stored_events) {
+	CReplay_Buffer buffer;
+	for (size_t i = 0; i < 100; i++) {
+		DCheck(buffer.Append(Level_Raw(static_cast<double>(i), 10.0 + i)));
+	}
+
+	scgms::TDevice_Event info{};
+	info.event_code = scgms::NDevice_Event_Code::Information;
+	DCheck(!buffer.Append(info));	//the optimizer does not replay them
+	buffer.Seal();
+
+	DCheck(buffer.size() == 100);
+	for (size_t i = 0; i < buffer.size(); i++) {
+		scgms::IDevice_Event *event = nullptr;
+		DCheck(buffer.Materialize(i, &event) == S_OK);
+
+		scgms::TDevice_Event *raw;
+		DCheck(event->Raw(&raw) == S_OK);
+		DCheck(raw->event_code == scgms::NDevice_Event_Code::Level);
+		DCheck(raw->device_id == Test_Device_Id);
+		DCheck(raw->signal_id == Test_Signal_Id);
+		DCheck(raw->device_time == static_cast<double>(i));
+		DCheck(raw->segment_id == 7);
+		DCheck(raw->level == 10.0 + i);
+		event->Release();
+	}
+
+	scgms::IDevice_Event *event = nullptr;
+	DCheck(buffer.Materialize(buffer.size(), &event) == E_INVALIDARG);
+}
+
+DTest_Case(replay, each_replay_is_a_new_event) {
+	CReplay_Buffer buffer;
+	DCheck(buffer.Append(Level_Raw(1.0, 5.0)));
+	buffer.Seal();
+
+	//replaying the same event twice must not make two events with the same logical time, which the merge would take for copies
+	int64_t previous_logical_time = 1;
+	for (size_t replay = 0; replay < 3; replay++) {
+		scgms::IDevice_Event *event = nullptr;
+		DCheck(buffer.Materialize(0, &event) == S_OK);
+
+		const TSeen_Event seen = See_Event(event);
+		DCheck(seen.logical_time != previous_logical_time);
+		DCheck(CLogical_Clock::Counter_Of(seen.logical_time) > CLogical_Clock::Counter_Of(previous_logical_time));
+		previous_logical_time = seen.logical_time;
+		event->Release();
+	}
+}
+
+DTest_Case(replay, replayed_parameters_are_own_copies) {
+	const std::vector<double> parameters{ 1.0, 2.0, 3.0 };
+
+	scgms::TDevice_Event raw{};
+	raw.event_code = scgms::NDevice_Event_Code::Parameters;
+	raw.device_id = Test_Device_Id;
+	raw.signal_id = Test_Signal_Id;
+	scgms::IDevice_Event *original = allocate_device_event(raw, parameters.data(), parameters.data() + parameters.size());
+	DCheck(original != nullptr);
+
+	scgms::TDevice_Event *original_raw;
+	DCheck(original->Raw(&original_raw) == S_OK);
+
+	CReplay_Buffer buffer;
+	DCheck(buffer.Append(*original_raw));
+	DCheck(buffer.Append(*original_raw));	//interned, yet replayed twice
+	original->Release();
+	buffer.Seal();
+
+	scgms::IDevice_Event *first = nullptr, *second = nullptr;
+	DCheck(buffer.Materialize(0, &first) == S_OK);
+	DCheck(Parameters_Of(first) == parameters);
+
+	//a filter may modify the parameters of its event, which must not affect the other replays
+	scgms::TDevice_Event *first_raw;
+	DCheck(first->Raw(&first_raw) == S_OK);
+	double *begin = nullptr, *end = nullptr;
+	DCheck(first_raw->parameters->get(&begin, &end) == S_OK);
+	begin[0] = -1.0;
+
+	DCheck(buffer.Materialize(1, &second) == S_OK);
+	DCheck(Parameters_Of(second) == parameters);
+
+	first->Release();
+	second->Release();
+}
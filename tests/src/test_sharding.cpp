@@ -0,0 +1,160 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "tests.h"
+#include "test_filters.h"
+
+#include "sharding.h"
+
+#include <memory>
+#include <set>
+
+#pragma warning( push )
+#pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
+
+namespace {
+	//body of a shard, which counts what it has processed and passes it to the merge; it may consume the broadcasts instead
+	class CShard_Body : public virtual scgms::IFilter, public virtual refcnt::CNotReferenced {
+		protected:
+			scgms::IFilter *mMerge;
+			const bool mConsume_Broadcasts;
+
+		public:
+			std::set<uint64_t> segments;
+			size_t broadcasts = 0;
+
+			CShard_Body(scgms::IFilter *merge, const bool consume_broadcasts) : mMerge(merge), mConsume_Broadcasts(consume_broadcasts) {};
+
+			virtual HRESULT IfaceCalling Configure(scgms::IFilter_Configuration* configuration, refcnt::wstr_list* error_description) override final {
+				return S_OK;
+			}
+
+			virtual HRESULT IfaceCalling Execute(scgms::IDevice_Event *event) override final {
+				const TSeen_Event seen = See_Event(event);
+				if (seen.code == scgms::NDevice_Event_Code::Level) {
+					segments.insert(seen.segment_id);
+				}
+				else {
+					broadcasts++;
+					if (mConsume_Broadcasts) {
+						event->Release();
+						return S_OK;
+					}
+				}
+
+				return mMerge->Execute(event);
+			}
+	};
+
+	//router, shards and merge wired as the composite filter does it, just with the shards executed synchronously
+	class CSharded_Chain {
+		public:
+			static constexpr size_t Shard_Count = 4;
+
+			std::recursive_mutex communication_guard;
+			CRecording_Filter recorder;
+			CShard_Merge merge{ &recorder };
+			CShard_Router router{ communication_guard, merge };
+			std::vector<std::unique_ptr<CShard_Body>> bodies;
+			std::vector<std::unique_ptr<CShard_Entry>> entries;
+
+			CSharded_Chain(const size_t consuming_shard = Shard_Count) {
+				for (size_t i = 0; i < Shard_Count; i++) {
+					bodies.push_back(std::make_unique<CShard_Body>(&merge, i == consuming_shard));
+					entries.push_back(std::make_unique<CShard_Entry>(bodies.back().get(), merge));
+					router.Add_Shard(entries.back().get());
+					merge.Add_Shard();
+				}
+			}
+	};
+}
+
+#pragma warning( pop )
+
+DTest_Case(sharding, segment_stays_on_its_shard) {
+	CSharded_Chain chain;
+
+	constexpr uint64_t Segment_Count = 64;
+	for (size_t repeat = 0; repeat < 2; repeat++) {
+		for (uint64_t segment = 1; segment <= Segment_Count; segment++) {
+			DCheck(chain.router.Execute(Make_Level_Event(static_cast<double>(segment), segment)) == S_OK);
+		}
+	}
+
+	//each segment goes to a single shard, and the segments spread over all of them
+	size_t routed_segments = 0;
+	for (const auto &body : chain.bodies) {
+		DCheck(!body->segments.empty());
+		routed_segments += body->segments.size();
+	}
+	DCheck(routed_segments == Segment_Count);
+
+	DCheck(chain.recorder.Count(scgms::NDevice_Event_Code::Level) == 2 * Segment_Count);
+}
+
+DTest_Case(sharding, broadcast_is_merged_once) {
+	CSharded_Chain chain;
+
+	DCheck(chain.router.Execute(Make_Level_Event(1.0, 1)) == S_OK);
+	DCheck(chain.router.Execute(allocate_device_event(scgms::NDevice_Event_Code::Warm_Reset)) == S_OK);
+	DCheck(chain.router.Execute(Make_Level_Event(2.0, 2)) == S_OK);
+	DCheck(chain.router.Execute(allocate_device_event(scgms::NDevice_Event_Code::Shut_Down)) == S_OK);
+
+	for (const auto &body : chain.bodies) {
+		DCheck(body->broadcasts == 2);	//every shard has processed its copy
+	}
+
+	DCheck(chain.recorder.Count(scgms::NDevice_Event_Code::Warm_Reset) == 1);
+	DCheck(chain.recorder.Count(scgms::NDevice_Event_Code::Shut_Down) == 1);
+	DCheck(chain.recorder.Count(scgms::NDevice_Event_Code::Level) == 2);
+
+	//the broadcast goes on after the events sent before it, and before those sent after it
+	const auto seen = chain.recorder.Seen();
+	DCheck(seen.size() == 4);
+	DCheck(seen[1].code == scgms::NDevice_Event_Code::Warm_Reset);
+	DCheck(seen[3].code == scgms::NDevice_Event_Code::Shut_Down);
+}
+
+DTest_Case(sharding, broadcast_consumed_by_a_shard_is_still_merged) {
+	CSharded_Chain chain{ 0 };	//the shard, which receives the original event, consumes it
+
+	DCheck(chain.router.Execute(allocate_device_event(scgms::NDevice_Event_Code::Warm_Reset)) == S_OK);
+	DCheck(chain.recorder.Count(scgms::NDevice_Event_Code::Warm_Reset) == 1);
+
+	DCheck(chain.router.Execute(allocate_device_event(scgms::NDevice_Event_Code::Shut_Down)) == S_OK);
+	DCheck(chain.recorder.Count(scgms::NDevice_Event_Code::Shut_Down) == 1);
+}
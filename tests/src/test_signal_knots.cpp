@@ -0,0 +1,228 @@
+/**
+ * SmartCGMS - continuous glucose monitoring and controlling framework
+ * https://diabetes.zcu.cz/
+ *
+ * Copyright (c) since 2018 University of West Bohemia.
+ *
+ * Contact:
+ * diabetes@mail.kiv.zcu.cz
+ * Medical Informatics, Department of Computer Science and Engineering
+ * Faculty of Applied Sciences, University of West Bohemia
+ * Univerzitni 8, 301 00 Pilsen
+ * Czech Republic
+ * 
+ * 
+ * Purpose of this software:
+ * This software is intended to demonstrate work of the diabetes.zcu.cz research
+ * group to other scientists, to complement our published papers. It is strictly
+ * prohibited to use this software for diagnosis or treatment of any medical condition,
+ * without obtaining all required approvals from respective regulatory bodies.
+ *
+ * Especially, a diabetic patient is warned that unauthorized use of this software
+ * may result into severe injure, including death.
+ *
+ *
+ * Licensing terms:
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under these license terms is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *
+ * a) This file is available under the Apache License, Version 2.0.
+ * b) When publishing any derivative work or results obtained using this software, you agree to cite the following paper:
+ *    Tomas Koutny and Martin Ubl, "SmartCGMS as a Testbed for a Blood-Glucose Level Prediction and/or 
+ *    Control Challenge with (an FDA-Accepted) Diabetic Patient Simulation", Procedia Computer Science,  
+ *    Volume 177, pp. 354-362, 2020
+ */
+
+
+#include "tests.h"
+
+#include "signal_knots.h"
+#include "chunked_series.h"
+
+#include <scgms/rtl/referencedImpl.h>
+
+#include <vector>
+
+#pragma warning( push )
+#pragma warning( disable : 4250 ) // C4250 - 'class1' : inherits 'class2::member' via dominance
+
+namespace {
+	//discrete signal, which may or may not tell its spans and revision, just like the measured signal and the other signals do
+	class CTest_Signal : public virtual scgms::ISignal, public virtual scgms::ISignal_Discrete_Spans, public virtual refcnt::CReferenced {
+		protected:
+			const bool mAnswers_Spans;
+		public:
+			CChunked_Series series;
+
+			CTest_Signal(const bool answers_spans) : mAnswers_Spans(answers_spans) {};
+			virtual ~CTest_Signal() = default;
+
+			virtual HRESULT IfaceCalling QueryInterface(const GUID*  riid, void ** ppvObj) override {
+				if (mAnswers_Spans && Internal_Query_Interface<scgms::ISignal_Discrete_Spans>(scgms::IID_Signal_Discrete_Spans, *riid, ppvObj)) {
+					return S_OK;
+				}
+
+				return E_NOINTERFACE;
+			}
+
+			virtual HRESULT IfaceCalling Get_Discrete_Levels(double* const times, double* const levels, const size_t count, size_t* filled) const override {
+				*filled = series.Copy(times, levels, count);
+				return S_OK;
+			}
+
+			virtual HRESULT IfaceCalling Get_Discrete_Bounds(scgms::TBounds* const time_bounds, scgms::TBounds* const level_bounds, size_t* level_count) const override {
+				if (level_count) {
+					*level_count = series.Size();
+				}
+				return series.Empty() ? S_FALSE : S_OK;
+			}
+
+			virtual HRESULT IfaceCalling Update_Levels(const double* times, const double* levels, const size_t count) override {
+				for (size_t i = 0; i < count; i++) {
+					series.Update(times[i], levels[i]);
+				}
+				return S_OK;
+			}
+
+			virtual HRESULT IfaceCalling Get_Continuous_Levels(scgms::IModel_Parameter_Vector* params, const double* times, double* const levels, const size_t count, const size_t derivation_order) const override {
+				return E_NOTIMPL;
+			}
+
+			virtual HRESULT IfaceCalling Get_Default_Parameters(scgms::IModel_Parameter_Vector* parameters) const override {
+				return E_NOTIMPL;
+			}
+
+			virtual HRESULT IfaceCalling Get_Discrete_Spans(const scgms::TLevels_Span** begin, const scgms::TLevels_Span** end) const override {
+				*begin = series.Spans().data();
+				*end = series.Spans().data() + series.Spans().size();
+				return series.Empty() ? S_FALSE : S_OK;
+			}
+
+			virtual HRESULT IfaceCalling Get_Discrete_Revision(uint64_t* revision) const override {
+				*revision = series.Revision();
+				return S_OK;
+			}
+	};
+
+	//holds a reference to the signal, as the knots query it for its interfaces
+	class CSignal_Reference {
+		protected:
+			CTest_Signal *mSignal;
+		public:
+			CSignal_Reference(const bool answers_spans) : mSignal(new CTest_Signal{ answers_spans }) {
+				mSignal->AddRef();
+			}
+
+			~CSignal_Reference() {
+				mSignal->Release();
+			}
+
+			CSignal_Reference(const CSignal_Reference&) = delete;
+			CSignal_Reference& operator=(const CSignal_Reference&) = delete;
+
+			CTest_Signal* operator->() const {
+				return mSignal;
+			}
+
+			CTest_Signal& operator*() const {
+				return *mSignal;
+			}
+
+			scgms::ISignal* Signal() const {
+				return static_cast<scgms::ISignal*>(mSignal);
+			}
+	};
+
+	void Append(CTest_Signal &signal, const size_t first, const size_t count) {
+		for (size_t i = first; i < first + count; i++) {
+			signal.series.Update(static_cast<double>(i), static_cast<double>(i));
+		}
+	}
+}
+
+#pragma warning( pop )
+
+DTest_Case(signal_knots, spans_read_just_the_appended_levels) {
+	CSignal_Reference signal{ true };
+	CSignal_Knots knots{ signal.Signal() };
+	size_t first_changed = 0;
+
+	Append(*signal, 0, 10);
+	DCheck(knots.Update(first_changed));
+	DCheck(first_changed == 0);
+	DCheck(knots.Size() == 10);
+
+	Append(*signal, 10, 1);
+	DCheck(knots.Update(first_changed));
+	DCheck(first_changed == 10);
+	DCheck(knots.Size() == 11);
+
+	DCheck(knots.Update(first_changed));
+	DCheck(first_changed == 11);	//nothing has changed
+}
+
+DTest_Case(signal_knots, spans_see_the_overwritten_levels) {
+	CSignal_Reference signal{ true };
+	CSignal_Knots knots{ signal.Signal() };
+	size_t first_changed = 0;
+
+	Append(*signal, 0, 10);
+	DCheck(knots.Update(first_changed));
+
+	//the count does not change, yet the revision does
+	signal->series.Update(5.0, 50.0);
+	DCheck(knots.Update(first_changed));
+	DCheck(first_changed == 0);
+	DCheck(knots.Levels()[5] == 50.0);
+
+	signal->series.Update(4.5, 1.0);
+	DCheck(knots.Update(first_changed));
+	DCheck(first_changed == 0);
+	DCheck(knots.Size() == 11);
+	DCheck(knots.Times()[5] == 4.5);
+}
+
+DTest_Case(signal_knots, copies_find_the_first_changed_level) {
+	CSignal_Reference signal{ false };	//the knots have to copy the levels and compare them
+	CSignal_Knots knots{ signal.Signal() };
+	size_t first_changed = 0;
+
+	Append(*signal, 0, 10);
+	DCheck(knots.Update(first_changed));
+	DCheck(first_changed == 0);
+
+	//overwritten, and then appended; the copy reveals the overwritten level
+	signal->series.Update(5.0, 50.0);
+	Append(*signal, 10, 1);
+	DCheck(knots.Update(first_changed));
+	DCheck(first_changed == 5);
+	DCheck(knots.Levels()[5] == 50.0);
+	DCheck(knots.Size() == 11);
+
+	signal->series.Update(7.5, 1.0);
+	DCheck(knots.Update(first_changed));
+	DCheck(first_changed == 8);
+	DCheck(knots.Size() == 12);
+}
+
+DTest_Case(signal_knots, locates_the_times) {
+	CSignal_Reference signal{ true };
+	CSignal_Knots knots{ signal.Signal() };
+	size_t first_changed = 0;
+
+	Append(*signal, 0, 100);
+	DCheck(knots.Update(first_changed));
+
+	//sorted times walk the cursor, a backward and a far jump search the knots
+	const std::vector<double> times{ -1.0, 0.0, 0.5, 1.25, 2.0, 50.5, 3.5, 99.0, 100.5 };
+	const std::vector<size_t> expected_knots{ CSignal_Knots::Invalid_Knot, 0, 0, 1, 2, 50, 3, 99, CSignal_Knots::Invalid_Knot };
+	const std::vector<double> expected_offsets{ 0.0, 0.0, 0.5, 0.25, 0.0, 0.5, 0.5, 0.0, 0.0 };
+
+	std::vector<size_t> knot_indices(times.size());
+	std::vector<double> offsets(times.size());
+	knots.Locate(times.data(), times.size(), knot_indices.data(), offsets.data());
+
+	DCheck(knot_indices == expected_knots);
+	DCheck(offsets == expected_offsets);
+}